@@ -18,11 +18,86 @@ message("Found protobuf include directory: " ${PROTOBUF_INCLUDE_DIRS} )
 
 
 
+#! pbop_get_service_source_files : Get the source files generated for the services of a proto file with the `split_services` or `methods_per_file` generator options.
+#  The services and their methods are read from the proto file at configure time.
+#  The proto file is added to the configure dependencies of the current directory: cmake runs again when the proto file changes.
+#
+# \arg:proto_file The proto file.
+# \arg:options Comma separated list of generator options. ie: `split_services`
+# \arg:source_files Name of the destination variable that will contains the list of the filenames (without directory).
+#
+function(pbop_get_service_source_files proto_file options source_files)
+  unset(LOCAL_SOURCE_FILES)
+
+  # Find the splitting options
+  set(SPLIT_SERVICES FALSE)
+  set(METHODS_PER_FILE 0)
+  set(SERVER_ONLY FALSE)
+  string(REPLACE "," ";" OPTIONS_LIST "${options}")
+  foreach(OPTION ${OPTIONS_LIST})
+    if ("${OPTION}" STREQUAL "split_services")
+      set(SPLIT_SERVICES TRUE)
+    elseif ("${OPTION}" MATCHES "^methods_per_file=([0-9]+)$")
+      set(SPLIT_SERVICES TRUE)
+      set(METHODS_PER_FILE ${CMAKE_MATCH_1})
+    elseif ("${OPTION}" STREQUAL "server_only")
+      set(SERVER_ONLY TRUE)
+    endif()
+  endforeach()
+  if (SERVER_ONLY)
+    # Client methods are not generated, each service has a single source file
+    set(METHODS_PER_FILE 0)
+  endif()
+
+  if (SPLIT_SERVICES)
+    get_filename_component(PROTO_FILENAME_WE ${proto_file} NAME_WE)
+
+    # The list of files depends on the content of the proto file. Run cmake again when the proto file changes.
+    set_property(DIRECTORY APPEND PROPERTY CMAKE_CONFIGURE_DEPENDS ${proto_file})
+
+    # Read the services and their rpc declarations. Line and block comments are ignored.
+    # A method is declared as `rpc Name (` which does not match a field named `rpc`.
+    file(READ ${proto_file} PROTO_CONTENT)
+    string(REGEX REPLACE "//[^\n]*|/\\*([^*]|\\*+[^*/])*\\*+/" " " PROTO_CONTENT "${PROTO_CONTENT}")
+    string(REGEX MATCHALL "(^|[^A-Za-z0-9_.])(service[ \t\r\n]+[A-Za-z_][A-Za-z0-9_]*|rpc[ \t\r\n]+[A-Za-z_][A-Za-z0-9_]*[ \t\r\n]*\\()" PROTO_TOKENS "${PROTO_CONTENT}")
+
+    # Count the methods of each service. An empty service name marks the end of the tokens.
+    unset(SERVICE_NAME)
+    set(NUM_METHODS 0)
+    list(APPEND PROTO_TOKENS "service ")
+    foreach(TOKEN ${PROTO_TOKENS})
+      if ("${TOKEN}" MATCHES "\\($")
+        math(EXPR NUM_METHODS "${NUM_METHODS} + 1")
+      elseif ("${TOKEN}" MATCHES "service[ \t\r\n]*([A-Za-z0-9_]*)$")
+        set(NEXT_SERVICE_NAME "${CMAKE_MATCH_1}")
+        if (DEFINED SERVICE_NAME)
+          # Output the source files of the previous service. ie: `addressbook.pbop.AddressBookService.pb.cc`, `addressbook.pbop.AddressBookService.1.pb.cc`
+          list(APPEND LOCAL_SOURCE_FILES ${PROTO_FILENAME_WE}.pbop.${SERVICE_NAME}.pb.cc)
+          if (METHODS_PER_FILE GREATER 0 AND NUM_METHODS GREATER METHODS_PER_FILE)
+            math(EXPR LAST_PART "(${NUM_METHODS} - 1) / ${METHODS_PER_FILE}")
+            foreach(PART RANGE 1 ${LAST_PART})
+              list(APPEND LOCAL_SOURCE_FILES ${PROTO_FILENAME_WE}.pbop.${SERVICE_NAME}.${PART}.pb.cc)
+            endforeach()
+          endif()
+        endif()
+        set(SERVICE_NAME "${NEXT_SERVICE_NAME}")
+        set(NUM_METHODS 0)
+      endif()
+    endforeach()
+  endif()
+
+  # Copy the source files to the calling scope
+  set(${source_files} ${LOCAL_SOURCE_FILES} PARENT_SCOPE)
+endfunction()
+
+
+
 #! pbop_generate_output_files : Generates the output files from a list of proto files.
 #
 # \arg:proto_files A list of all proto files.
 # \arg:output_dir Output directory where the generated files must be generated.
 # \arg:generated_files Name of the destination variable that will contains the list of the generated files.
+# \arg:options Optional. Comma separated list of generator options. Required for the `split_services` and `methods_per_file` options.
 #
 function(pbop_generate_output_files proto_files output_dir generated_files)
   unset(LOCAL_GENERATED_FILES)
@@ -36,6 +111,14 @@ function(pbop_generate_output_files proto_files output_dir generated_files)
     list(APPEND LOCAL_GENERATED_FILES ${output_dir}/${PROTO_FILENAME_WE}.pb.cc)
     list(APPEND LOCAL_GENERATED_FILES ${output_dir}/${PROTO_FILENAME_WE}.pbop.pb.h)
     list(APPEND LOCAL_GENERATED_FILES ${output_dir}/${PROTO_FILENAME_WE}.pbop.pb.cc)
+
+    # Source files of each service
+    if (ARGC GREATER 3)
+      pbop_get_service_source_files(${PROTO_FILE} "${ARGV3}" SERVICE_SOURCE_FILES)
+      foreach(SERVICE_SOURCE_FILE ${SERVICE_SOURCE_FILES})
+        list(APPEND LOCAL_GENERATED_FILES ${output_dir}/${SERVICE_SOURCE_FILE})
+      endforeach()
+    endif()
   endforeach()
   
   # Copy generated output files to the calling scope
@@ -50,8 +133,22 @@ endfunction()
 # \arg:prebuid_target_name The name of the prebuild target that generates files for target `source_target_name`.
 # \arg:proto_files The list of proto files.
 # \arg:output_dir Output directory where the generated files must be generated.
+# \arg:options Optional. Comma separated list of generator options. ie: `crtp`
 #
 function(pbop_add_prebuild_target source_target_name prebuid_target_name proto_files output_dir)  
+  # Files are generated in a staging directory and only copied to ${output_dir} when their content changed.
+  # Unchanged generated files keep their timestamp and their dependents are not recompiled.
+  set(STAGING_DIR ${CMAKE_CURRENT_BINARY_DIR}/${prebuid_target_name}.staging)
+
+  # Generator options are given to the plugin as a prefix of the output directory. ie: `--pbop_out=crtp:<output_dir>`
+  set(PBOP_STAGING_OUT ${STAGING_DIR})
+  set(PBOP_OPTIONS "")
+  if (ARGC GREATER 4 AND NOT "${ARGV4}" STREQUAL "")
+    set(PBOP_OPTIONS "${ARGV4}")
+    set(PBOP_STAGING_OUT "${ARGV4}:${STAGING_DIR}")
+  endif()
+
+  unset(ALL_STAMP_FILES)
   foreach(PROTO_FILE ${proto_files})
     # Get the filename of the proto file. ie: addressbook.proto
     get_filename_component(PROTO_FILENAME ${PROTO_FILE} NAME)
@@ -71,15 +168,35 @@ function(pbop_add_prebuild_target source_target_name prebuid_target_name proto_f
     list(APPEND LOCAL_GENERATED_FILES ${output_dir}/${PROTO_FILENAME_WE}.pb.cc)
     list(APPEND LOCAL_GENERATED_FILES ${output_dir}/${PROTO_FILENAME_WE}.pbop.pb.h)
     list(APPEND LOCAL_GENERATED_FILES ${output_dir}/${PROTO_FILENAME_WE}.pbop.pb.cc)
+
+    # Source files of each service with the `split_services` or `methods_per_file` options
+    pbop_get_service_source_files(${PROTO_FILE} "${PBOP_OPTIONS}" SERVICE_SOURCE_FILES)
+    unset(SERVICE_COPY_COMMANDS)
+    foreach(SERVICE_SOURCE_FILE ${SERVICE_SOURCE_FILES})
+      list(APPEND LOCAL_GENERATED_FILES ${output_dir}/${SERVICE_SOURCE_FILE})
+      list(APPEND SERVICE_COPY_COMMANDS COMMAND ${CMAKE_COMMAND} -E copy_if_different ${STAGING_DIR}/${SERVICE_SOURCE_FILE} ${output_dir}/${SERVICE_SOURCE_FILE})
+    endforeach()
+
+    # The stamp file is updated each time the plugin is executed
+    set(STAMP_FILE ${STAGING_DIR}/${PROTO_FILENAME_WE}.stamp)
+    list(APPEND ALL_STAMP_FILES ${STAMP_FILE})
     
-    # Execute 'addressbook.proto' and output to ${output_dir}
+    # Execute 'addressbook.proto' and output to ${STAGING_DIR}. Then copy the modified files to ${output_dir}
     add_custom_command(
-      OUTPUT ${LOCAL_GENERATED_FILES}
-      DEPENDS ${proto_file}
+      OUTPUT ${STAMP_FILE}
+      BYPRODUCTS ${LOCAL_GENERATED_FILES}
+      DEPENDS ${PROTO_FILE} protobuf-pbop-plugin
       # Warning: CMake treats ; character differently. They must be escaped to prevent issues
       COMMENT "Executing pbop plugin for ${PROTO_FILENAME}..."
-      COMMAND echo $<TARGET_FILE:protobuf::protoc> --cpp_out=${output_dir} --plugin=protoc-gen-pbop=$<TARGET_FILE:protobuf-pbop-plugin> --pbop_out=${output_dir} --proto_path=.\;${PROTOBUF_INCLUDE_DIRS}\;${PROTO_DIRECTORY}\;${output_dir} ${PROTO_FILENAME}
-      COMMAND      $<TARGET_FILE:protobuf::protoc> --cpp_out=${output_dir} --plugin=protoc-gen-pbop=$<TARGET_FILE:protobuf-pbop-plugin> --pbop_out=${output_dir} --proto_path=.\;${PROTOBUF_INCLUDE_DIRS}\;${PROTO_DIRECTORY}\;${output_dir} ${PROTO_FILENAME}
+      COMMAND ${CMAKE_COMMAND} -E make_directory ${STAGING_DIR}
+      COMMAND echo $<TARGET_FILE:protobuf::protoc> --cpp_out=${STAGING_DIR} --plugin=protoc-gen-pbop=$<TARGET_FILE:protobuf-pbop-plugin> --pbop_out=${PBOP_STAGING_OUT} --proto_path=.\;${PROTOBUF_INCLUDE_DIRS}\;${PROTO_DIRECTORY}\;${output_dir} ${PROTO_FILENAME}
+      COMMAND      $<TARGET_FILE:protobuf::protoc> --cpp_out=${STAGING_DIR} --plugin=protoc-gen-pbop=$<TARGET_FILE:protobuf-pbop-plugin> --pbop_out=${PBOP_STAGING_OUT} --proto_path=.\;${PROTOBUF_INCLUDE_DIRS}\;${PROTO_DIRECTORY}\;${output_dir} ${PROTO_FILENAME}
+      COMMAND ${CMAKE_COMMAND} -E copy_if_different ${STAGING_DIR}/${PROTO_FILENAME_WE}.pb.h       ${output_dir}/${PROTO_FILENAME_WE}.pb.h
+      COMMAND ${CMAKE_COMMAND} -E copy_if_different ${STAGING_DIR}/${PROTO_FILENAME_WE}.pb.cc      ${output_dir}/${PROTO_FILENAME_WE}.pb.cc
+      COMMAND ${CMAKE_COMMAND} -E copy_if_different ${STAGING_DIR}/${PROTO_FILENAME_WE}.pbop.pb.h  ${output_dir}/${PROTO_FILENAME_WE}.pbop.pb.h
+      COMMAND ${CMAKE_COMMAND} -E copy_if_different ${STAGING_DIR}/${PROTO_FILENAME_WE}.pbop.pb.cc ${output_dir}/${PROTO_FILENAME_WE}.pbop.pb.cc
+      ${SERVICE_COPY_COMMANDS}
+      COMMAND ${CMAKE_COMMAND} -E touch ${STAMP_FILE}
       COMMAND echo done.
     )
         
@@ -103,7 +220,34 @@ function(pbop_add_prebuild_target source_target_name prebuid_target_name proto_f
     
   endforeach()
     
-  add_custom_target(${prebuid_target_name} DEPENDS ${LOCAL_GENERATED_FILES})
+  add_custom_target(${prebuid_target_name} DEPENDS ${ALL_STAMP_FILES})
   add_dependencies(${source_target_name} ${prebuid_target_name})
   
-endfunction()
\ No newline at end of file
+endfunction()
+
+
+#! pbop_target_precompile_headers : Precompiles the library and protobuf headers included by the generated files of a target.
+#  The headers are compiled once per target instead of once per generated source file.
+#  Precompiled headers require CMake 3.16. The function does nothing with older versions of CMake.
+#
+# \arg:target_name The name of the target that contains the generated files.
+#
+function(pbop_target_precompile_headers target_name)
+  if (CMAKE_VERSION VERSION_LESS 3.16)
+    message("Precompiled headers require CMake 3.16 or newer. Target '${target_name}' is built without precompiled headers.")
+    return()
+  endif()
+
+  target_precompile_headers(${target_name}
+    PRIVATE
+      <string>
+      <google/protobuf/message.h>
+      <google/protobuf/arena.h>
+      <pbop/Status.h>
+      <pbop/Service.h>
+      <pbop/Connection.h>
+      <pbop/ClientCall.h>
+      <pbop/TraceRecorder.h>
+      <pbop/InProcessConnection.h>
+  )
+endfunction()
@@ -0,0 +1,70 @@
+/**********************************************************************************
+ * MIT License
+ * 
+ * Copyright (c) 2018 Antoine Beauchamp
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#ifndef LIB_PBOP_ARENA_BLOCK
+#define LIB_PBOP_ARENA_BLOCK
+
+#include <stddef.h>
+
+namespace pbop
+{
+
+  /// <summary>
+  /// Lend the initial block of the current thread to a google::protobuf::Arena.
+  /// The block is reused by all the calls of a thread instead of being allocated on the stack of each call.
+  /// An instance of this class must be created on the stack, before the arena that uses the block.
+  /// A nested instance on the same thread gets no block and its arena allocates from the heap.
+  /// </summary>
+  class ArenaBlock
+  {
+  public:
+    ArenaBlock();
+  private:
+    ArenaBlock(const ArenaBlock & copy); //disable copy constructor.
+    ArenaBlock & operator =(const ArenaBlock & other); //disable assignment operator.
+  public:
+    ~ArenaBlock();
+
+    /// <summary>
+    /// Get the block to set as ArenaOptions::initial_block.
+    /// </summary>
+    /// <returns>Returns the block of the current thread. Returns NULL if the block is already lent to another arena.</returns>
+    char * GetBlock() const;
+
+    /// <summary>
+    /// Get the size of the block to set as ArenaOptions::initial_block_size.
+    /// </summary>
+    /// <returns>Returns the size in bytes of the block. Returns 0 if the block is already lent to another arena.</returns>
+    size_t GetSize() const;
+
+  public:
+    static const size_t BLOCK_SIZE = 4096;
+
+  private:
+    char * block_;
+  };
+
+}; //namespace pbop
+
+#endif //LIB_PBOP_ARENA_BLOCK
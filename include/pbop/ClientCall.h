@@ -0,0 +1,61 @@
+/**********************************************************************************
+ * MIT License
+ * 
+ * Copyright (c) 2018 Antoine Beauchamp
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#ifndef LIB_PBOP_CLIENT_CALL
+#define LIB_PBOP_CLIENT_CALL
+
+#include "pbop/Status.h"
+#include "pbop/Connection.h"
+
+#include <string>
+
+namespace pbop
+{
+
+  /// <summary>
+  /// Constant description of a service method called by a client.
+  /// Generated clients define a static CallDescriptor for each method.
+  /// </summary>
+  struct CallDescriptor
+  {
+    const char * name; // The name of the method. Used for tracing.
+    const unsigned char * identifier; // The serialized function_identifier field of the ClientRequest of the method (see pbop.proto).
+    size_t identifier_size; // The size in bytes of identifier.
+  };
+
+  /// <summary>
+  /// Call a method of a service through a connection and wait for its response.
+  /// The request is sent to the connection as a ClientRequest message and the response is read from a ServerResponse message.
+  /// All generated clients call their methods through this function.
+  /// </summary>
+  /// <param name="connection">The connection to the server.</param>
+  /// <param name="descriptor">The description of the called method.</param>
+  /// <param name="request">The request message of the method.</param>
+  /// <param name="response">The output response message of the method.</param>
+  /// <returns>Returns the status of the call on the server. Returns an error status if the request could not be sent or if the response could not be read.</returns>
+  Status ClientCall(Connection * connection, const CallDescriptor & descriptor, const ::google::protobuf::MessageLite & request, ::google::protobuf::MessageLite & response);
+
+}; //namespace pbop
+
+#endif //LIB_PBOP_CLIENT_CALL
@@ -25,6 +25,8 @@
 #ifndef LIB_PBOP_CRITICAL_SECTION
 #define LIB_PBOP_CRITICAL_SECTION
 
+#include "pbop/LockProfiler.h"
+
 namespace pbop
 {
 
@@ -50,10 +52,35 @@ namespace pbop
     /// </summary>
     void Lock();
 
+    /// <summary>
+    /// Try to enter the critical section without blocking.
+    /// </summary>
+    /// <returns>Returns true if the critical section was entered. Returns false if the critical section is owned by another thread.</returns>
+    bool TryLock();
+
     /// <summary>
     /// Leave the critical section.
     /// </summary>
     void Unlock();
+
+    /// <summary>
+    /// Assign a name to the critical section. Named critical sections are profiled when the library is built with PBOP_ENABLE_LOCK_PROFILING.
+    /// The name should be assigned before the critical section is used.
+    /// </summary>
+    /// <param name="name">The name of the critical section.</param>
+    void SetName(const char * name);
+
+    /// <summary>
+    /// Get the name of the critical section.
+    /// </summary>
+    /// <returns>Returns the name of the critical section. Returns an empty string if the critical section is not named.</returns>
+    const char * GetName() const;
+
+    /// <summary>
+    /// Get the contention statistics of the critical section.
+    /// </summary>
+    /// <param name="statistics">The output statistics. All counters are zero if the critical section is not profiled.</param>
+    void GetStatistics(LockStatistics & statistics) const;
   };
 
 }; //namespace pbop
@@ -0,0 +1,57 @@
+/**********************************************************************************
+ * MIT License
+ * 
+ * Copyright (c) 2018 Antoine Beauchamp
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#ifndef LIB_PBOP_ENVELOPE
+#define LIB_PBOP_ENVELOPE
+
+#include "pbop/Status.h"
+
+#include <string>
+
+namespace pbop
+{
+
+  /// <summary>
+  /// Serialize a ClientRequest message (see pbop.proto) ready for sending to a connection.
+  /// The message is the precomputed function_identifier field of the called method followed by the request_buffer field.
+  /// The request is serialized once, directly into the output buffer.
+  /// </summary>
+  /// <param name="identifier">The serialized function_identifier field of the called method.</param>
+  /// <param name="identifier_size">The size in bytes of the identifier.</param>
+  /// <param name="request">The request message of the called method.</param>
+  /// <param name="buffer">The output serialized ClientRequest message.</param>
+  /// <returns>Returns a Status instance which code is set to STATUS_CODE_SUCCESS when the operation is successful.</returns>
+  Status EncodeClientRequest(const unsigned char * identifier, size_t identifier_size, const ::google::protobuf::MessageLite & request, std::string & buffer);
+
+  /// <summary>
+  /// Deserialize a ServerResponse message (see pbop.proto) received from a connection and the response message of the called method.
+  /// </summary>
+  /// <param name="buffer">The serialized ServerResponse message.</param>
+  /// <param name="response">The output response message of the called method.</param>
+  /// <returns>Returns the status of the call on the server. Returns an error status if the buffer is not a valid ServerResponse message.</returns>
+  Status DecodeServerResponse(const std::string & buffer, ::google::protobuf::MessageLite & response);
+
+}; //namespace pbop
+
+#endif //LIB_PBOP_ENVELOPE
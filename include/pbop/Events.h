@@ -160,6 +160,126 @@ namespace pbop
     Status status_;
   };
 
+  /// <summary>
+  /// Base class for all events related to a call of a service method.
+  /// Timestamps are in nanoseconds from a monotonic high resolution clock. The origin of the clock is unspecified.
+  /// </summary>
+  class EventCallBase : public EventConnectionBase
+  {
+  public:
+    EventCallBase() : package_(NULL), service_(NULL), function_(NULL), function_index_(0), request_size_(0), begin_time_(0) {}
+    virtual ~EventCallBase() {}
+
+    /// <summary>
+    /// Set the identification of the called method.
+    /// </summary>
+    /// <param name="package">The package name of the service.</param>
+    /// <param name="service">The name of the service.</param>
+    /// <param name="function">The name of the method.</param>
+    /// <param name="function_index">The index of the method in the service's GetFunctionIdentifiers() array.</param>
+    void SetFunction(const char * package, const char * service, const char * function, size_t function_index);
+
+    /// <summary>Get the package name of the called service.</summary>
+    /// <returns>Returns the package name of the called service.</returns>
+    const char * GetPackageName() const;
+
+    /// <summary>Get the name of the called service.</summary>
+    /// <returns>Returns the name of the called service.</returns>
+    const char * GetServiceName() const;
+
+    /// <summary>Get the name of the called method.</summary>
+    /// <returns>Returns the name of the called method.</returns>
+    const char * GetFunctionName() const;
+
+    /// <summary>Get the index of the called method in the service's GetFunctionIdentifiers() array.</summary>
+    /// <returns>Returns the index of the called method.</returns>
+    size_t GetFunctionIndex() const;
+
+    /// <summary>
+    /// Set the size of the serialized request message.
+    /// </summary>
+    /// <param name="size">The size of the request in bytes.</param>
+    void SetRequestSize(size_t size);
+
+    /// <summary>Get the size of the serialized request message.</summary>
+    /// <returns>Returns the size of the request in bytes.</returns>
+    size_t GetRequestSize() const;
+
+    /// <summary>
+    /// Set the time at which the execution of the method has started.
+    /// </summary>
+    /// <param name="timestamp">The time in nanoseconds.</param>
+    void SetBeginTime(unsigned long long timestamp);
+
+    /// <summary>Get the time at which the execution of the method has started.</summary>
+    /// <returns>Returns the time in nanoseconds.</returns>
+    unsigned long long GetBeginTime() const;
+
+  protected:
+    const char * package_;
+    const char * service_;
+    const char * function_;
+    size_t function_index_;
+    size_t request_size_;
+    unsigned long long begin_time_;
+  };
+
+  /// <summary>
+  /// Identify an event that is published right before a service method is executed.
+  /// </summary>
+  class EventCallBegin : public EventCallBase
+  {
+  public:
+    EventCallBegin() {}
+    virtual ~EventCallBegin() {}
+  };
+
+  /// <summary>
+  /// Identify an event that is published right after a service method is executed.
+  /// The status returned by the method is stored in the event.
+  /// </summary>
+  class EventCallEnd : public EventCallBase
+  {
+  public:
+    EventCallEnd() : response_size_(0), end_time_(0) {}
+    virtual ~EventCallEnd() {}
+
+    /// <summary>
+    /// Set the size of the serialized response message.
+    /// </summary>
+    /// <param name="size">The size of the response in bytes.</param>
+    void SetResponseSize(size_t size);
+
+    /// <summary>Get the size of the serialized response message.</summary>
+    /// <returns>Returns the size of the response in bytes. Returns 0 if the method has failed.</returns>
+    size_t GetResponseSize() const;
+
+    /// <summary>
+    /// Set the time at which the execution of the method has completed.
+    /// </summary>
+    /// <param name="timestamp">The time in nanoseconds.</param>
+    void SetEndTime(unsigned long long timestamp);
+
+    /// <summary>Get the time at which the execution of the method has completed.</summary>
+    /// <returns>Returns the time in nanoseconds.</returns>
+    unsigned long long GetEndTime() const;
+
+    /// <summary>
+    /// Set the status returned by the method.
+    /// </summary>
+    /// <param name="status">The status returned by the method.</param>
+    void SetStatus(const Status & status);
+
+    /// <summary>Get the status returned by the method.</summary>
+    /// <returns>Returns the status returned by the method.</returns>
+    const Status & GetStatus() const;
+
+  protected:
+    size_t response_size_;
+    unsigned long long end_time_;
+    Status status_;
+  };
+
 }; //namespace pbop
 
 #endif //LIB_PBOP_EVENTS
\ No newline at end of file
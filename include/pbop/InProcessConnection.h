@@ -0,0 +1,99 @@
+/**********************************************************************************
+ * MIT License
+ * 
+ * Copyright (c) 2018 Antoine Beauchamp
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#ifndef LIB_PBOP_IN_PROCESS_CONNECTION
+#define LIB_PBOP_IN_PROCESS_CONNECTION
+
+#include "pbop/Status.h"
+#include "pbop/Connection.h"
+#include "pbop/Service.h"
+
+#include <string>
+
+namespace pbop
+{
+
+  class Server;
+
+  /// <summary>
+  /// A connection to a Server that lives in the same process.
+  /// Written requests are processed synchronously by the server's registered services, without any pipe.
+  /// The response is returned by the next call to Read().
+  /// Generated clients detect this connection and call the service implementation directly with the message objects,
+  /// skipping serialization entirely. Direct calls bypass the server's statistics, events and concurrency limits.
+  /// Services must be registered to the server before the client is created.
+  /// A connection instance must not be shared by multiple threads.
+  /// </summary>
+  class InProcessConnection : public Connection
+  {
+  public:
+    InProcessConnection(Server * server);
+    virtual ~InProcessConnection();
+  private:
+    InProcessConnection(const InProcessConnection & copy); //disable copy constructor.
+    InProcessConnection & operator =(const InProcessConnection & other); //disable assignment operator.
+  public:
+
+    /// <summary>
+    /// Get the server that processes the requests of this connection.
+    /// </summary>
+    /// <returns>Returns the server that processes the requests of this connection.</returns>
+    virtual Server * GetServer() const;
+
+    /// <summary>
+    /// Find a service registered to the server.
+    /// </summary>
+    /// <param name="package_name">The package name of the service.</param>
+    /// <param name="service_name">The service name of the service.</param>
+    /// <returns>Returns the matching service instance. Returns NULL if no service is registered with the given names.</returns>
+    virtual Service * FindService(const char * package_name, const char * service_name) const;
+
+    /// <summary>
+    /// Defines if direct calls give a copy of the messages to the service implementation.
+    /// When enabled, the service receives its own request and response instances and the response is swapped into the caller's response on success.
+    /// Disabled by default.
+    /// </summary>
+    /// <param name="enabled">Set to true to copy the messages of direct calls.</param>
+    virtual void SetCopyMessages(bool enabled);
+
+    /// <summary>
+    /// Returns true if direct calls give a copy of the messages to the service implementation.
+    /// </summary>
+    /// <returns>Returns true if direct calls give a copy of the messages to the service implementation. Returns false otherwise.</returns>
+    virtual bool IsCopyMessages() const;
+
+    virtual Status Write(const std::string & buffer);
+    virtual Status Read(std::string & buffer);
+    virtual Status Read(std::string & buffer, unsigned long timeout);
+
+  private:
+    Server * server_;
+    bool copy_messages_;
+    bool has_response_;
+    std::string response_;
+  };
+
+}; //namespace pbop
+
+#endif //LIB_PBOP_IN_PROCESS_CONNECTION
@@ -0,0 +1,147 @@
+/**********************************************************************************
+ * MIT License
+ * 
+ * Copyright (c) 2018 Antoine Beauchamp
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#ifndef LIB_PBOP_LATENCY_HISTOGRAM
+#define LIB_PBOP_LATENCY_HISTOGRAM
+
+#include <string>
+#include <vector>
+
+namespace pbop
+{
+
+  /// <summary>
+  /// A log-linear histogram of latency samples similar to an HDR histogram.
+  /// Each power of two range is split in 32 linear sub-buckets which gives
+  /// a relative precision of about 3% over the full 64 bits range of values.
+  /// Values are usually expressed in nanoseconds.
+  /// The class is not thread safe. Each thread should record in its own instance
+  /// and the instances should be merged with Merge() when reporting.
+  /// </summary>
+  class LatencyHistogram
+  {
+  public:
+    LatencyHistogram();
+    virtual ~LatencyHistogram();
+
+    /// <summary>
+    /// Record a value in the histogram.
+    /// </summary>
+    /// <param name="value">The value to record.</param>
+    void Record(unsigned long long value);
+
+    /// <summary>
+    /// Add all the values recorded in another histogram to this histogram.
+    /// </summary>
+    /// <param name="other">The histogram to merge with.</param>
+    void Merge(const LatencyHistogram & other);
+
+    /// <summary>
+    /// Remove all recorded values.
+    /// </summary>
+    void Reset();
+
+    /// <summary>
+    /// Exchange the recorded values of this histogram with the values of another histogram.
+    /// The buckets are not copied.
+    /// </summary>
+    /// <param name="other">The histogram to swap with.</param>
+    void Swap(LatencyHistogram & other);
+
+    /// <summary>
+    /// Get the number of recorded values.
+    /// </summary>
+    /// <returns>Returns the number of recorded values.</returns>
+    unsigned long long GetCount() const;
+
+    /// <summary>
+    /// Get the smallest recorded value.
+    /// </summary>
+    /// <returns>Returns the smallest recorded value. Returns 0 if the histogram is empty.</returns>
+    unsigned long long GetMin() const;
+
+    /// <summary>
+    /// Get the largest recorded value.
+    /// </summary>
+    /// <returns>Returns the largest recorded value. Returns 0 if the histogram is empty.</returns>
+    unsigned long long GetMax() const;
+
+    /// <summary>
+    /// Get the arithmetic mean of all recorded values.
+    /// </summary>
+    /// <returns>Returns the mean of all recorded values. Returns 0 if the histogram is empty.</returns>
+    double GetMean() const;
+
+    /// <summary>
+    /// Get the value at the given percentile.
+    /// The returned value is the highest value of the bucket that contains the percentile
+    /// and is never larger than GetMax().
+    /// </summary>
+    /// <param name="percentile">The percentile in the range [0, 100]. ie: 99.9</param>
+    /// <returns>Returns the value at the given percentile. Returns 0 if the histogram is empty.</returns>
+    unsigned long long GetPercentile(double percentile) const;
+
+    /// <summary>
+    /// Format the count, min, mean, max, p50, p90, p99 and p999 values as a JSON object.
+    /// </summary>
+    /// <returns>Returns a JSON object as a string.</returns>
+    std::string ToJson() const;
+
+  public:
+    static const unsigned int SUB_BUCKET_BITS = 5;
+    static const unsigned int SUB_BUCKET_COUNT = (1 << SUB_BUCKET_BITS);
+    static const unsigned int BUCKET_COUNT = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT;
+
+    /// <summary>
+    /// Get the bucket index of a value.
+    /// </summary>
+    /// <param name="value">The value.</param>
+    /// <returns>Returns the index of the bucket that contains the given value.</returns>
+    static unsigned int GetBucketIndex(unsigned long long value);
+
+    /// <summary>
+    /// Get the smallest value of a bucket.
+    /// </summary>
+    /// <param name="index">The index of the bucket.</param>
+    /// <returns>Returns the smallest value that is recorded in the given bucket.</returns>
+    static unsigned long long GetBucketLowestValue(unsigned int index);
+
+    /// <summary>
+    /// Get the largest value of a bucket.
+    /// </summary>
+    /// <param name="index">The index of the bucket.</param>
+    /// <returns>Returns the largest value that is recorded in the given bucket.</returns>
+    static unsigned long long GetBucketHighestValue(unsigned int index);
+
+  private:
+    std::vector<unsigned long long> counts_;
+    unsigned long long count_;
+    unsigned long long min_;
+    unsigned long long max_;
+    double sum_;
+  };
+
+}; //namespace pbop
+
+#endif //LIB_PBOP_LATENCY_HISTOGRAM
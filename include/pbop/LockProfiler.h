@@ -0,0 +1,81 @@
+/**********************************************************************************
+ * MIT License
+ * 
+ * Copyright (c) 2018 Antoine Beauchamp
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#ifndef LIB_PBOP_LOCK_PROFILER
+#define LIB_PBOP_LOCK_PROFILER
+
+#include <string>
+#include <vector>
+
+namespace pbop
+{
+
+  /// <summary>
+  /// Contention statistics of a named lock.
+  /// All times are in nanoseconds.
+  /// </summary>
+  struct LockStatistics
+  {
+    std::string name;                 // The name of the lock instance.
+    unsigned long long acquisitions;  // Number of times the lock was acquired.
+    unsigned long long contentions;   // Number of acquisitions that had to wait for another thread to release the lock.
+    unsigned long long wait_time;     // Total time spent waiting to acquire the lock.
+    unsigned long long hold_time;     // Total time the lock was held.
+  };
+
+  /// <summary>
+  /// Provides access to the contention statistics of all named locks.
+  /// Statistics are only recorded when the library is built with PBOP_ENABLE_LOCK_PROFILING.
+  /// A lock is profiled once a name is assigned to it with SetName().
+  /// </summary>
+  class LockProfiler
+  {
+  public:
+    /// <summary>
+    /// Returns true if the library was built with lock profiling support.
+    /// </summary>
+    /// <returns>Returns true if the library was built with lock profiling support. Returns false otherwise.</returns>
+    static bool IsEnabled();
+
+    /// <summary>
+    /// Get the statistics of all named locks that are currently alive.
+    /// </summary>
+    /// <param name="statistics">The output list of statistics. One element per named lock.</param>
+    static void GetStatistics(std::vector<LockStatistics> & statistics);
+
+    /// <summary>
+    /// Reset the statistics of all named locks to zero.
+    /// </summary>
+    static void Reset();
+
+    /// <summary>
+    /// Format the statistics of all named locks into a human readable table.
+    /// </summary>
+    /// <returns>Returns a string with one line per named lock.</returns>
+    static std::string ToString();
+  };
+
+}; //namespace pbop
+
+#endif //LIB_PBOP_LOCK_PROFILER
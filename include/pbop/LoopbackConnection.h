@@ -0,0 +1,108 @@
+/**********************************************************************************
+ * MIT License
+ * 
+ * Copyright (c) 2018 Antoine Beauchamp
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#ifndef LIB_PBOP_LOOPBACK_CONNECTION
+#define LIB_PBOP_LOOPBACK_CONNECTION
+
+#include "pbop/Status.h"
+#include "pbop/Connection.h"
+
+#include <string>
+#include <memory>
+
+namespace pbop
+{
+
+  /// <summary>
+  /// A connection that is connected to a peer connection in the same process.
+  /// Messages written to a connection are read from its peer with the same boundaries.
+  /// Each direction is a bounded ring of messages: writes block while the ring is full and reads block while it is empty.
+  /// Reading a message swaps it into the caller's buffer which allows the ring to reuse the caller's memory.
+  /// Any number of threads can write to or read from the same connection.
+  /// A pair of connections is a fast and deterministic replacement for a pipe. A server side connection can be given to Server::AddConnection().
+  /// </summary>
+  class LoopbackConnection : public Connection
+  {
+  public:
+    /// <summary>The default number of messages that can be pending in each direction.</summary>
+    static const size_t DEFAULT_CAPACITY;
+
+    /// <summary>
+    /// Create a pair of connected connections.
+    /// </summary>
+    /// <param name="first">The output first connection of the pair.</param>
+    /// <param name="second">The output second connection of the pair.</param>
+    /// <param name="capacity">The maximum number of messages that can be pending in each direction.</param>
+    static void CreatePair(LoopbackConnection ** first, LoopbackConnection ** second, size_t capacity = DEFAULT_CAPACITY);
+
+    virtual ~LoopbackConnection();
+  private:
+    class Channel;
+    LoopbackConnection(const std::shared_ptr<Channel> & input, const std::shared_ptr<Channel> & output);
+    LoopbackConnection(const LoopbackConnection & copy); //disable copy constructor.
+    LoopbackConnection & operator =(const LoopbackConnection & other); //disable assignment operator.
+  public:
+
+    /// <summary>
+    /// Close the connection in both directions.
+    /// Blocked reads and writes of both connections are released.
+    /// The peer can still read the messages that were written before the connection was closed.
+    /// Closing is automatic when the connection is destroyed.
+    /// </summary>
+    virtual void Close();
+
+    /// <summary>
+    /// Writes the given buffer to the connection. Blocks while the maximum number of unread messages is reached.
+    /// </summary>
+    /// <param name="buffer">The buffer content to send to the connection.</param>
+    /// <returns>Returns a Status instance which code is set to STATUS_CODE_SUCCESS when the operation is successful. Returns STATUS_CODE_PIPE_ERROR if the connection is closed.</returns>
+    virtual Status Write(const std::string & buffer);
+
+    /// <summary>
+    /// Reads the next message from the connection. Blocks until a message is available.
+    /// </summary>
+    /// <param name="buffer">The buffer that contains the readed message.</param>
+    /// <returns>Returns a Status instance which code is set to STATUS_CODE_SUCCESS when the operation is successful. Returns STATUS_CODE_PIPE_ERROR if the connection is closed and no message is pending.</returns>
+    virtual Status Read(std::string & buffer);
+
+    /// <summary>
+    /// Reads the next message from the connection in the maximum given time.
+    /// </summary>
+    /// <param name="buffer">The buffer that contains the readed message.</param>
+    /// <param name="timeout">The maximum time allowed for the operation in milliseconds.</param>
+    /// <returns>
+    /// Returns a Status instance which code is set to STATUS_CODE_SUCCESS when the operation is successful.
+    /// If no message is received in the allowed time, the returned status code is STATUS_CODE_TIMED_OUT.
+    /// Returns STATUS_CODE_PIPE_ERROR if the connection is closed and no message is pending.
+    /// </returns>
+    virtual Status Read(std::string & buffer, unsigned long timeout);
+
+  private:
+    std::shared_ptr<Channel> input_;  // messages written by the peer
+    std::shared_ptr<Channel> output_; // messages read by the peer
+  };
+
+}; //namespace pbop
+
+#endif //LIB_PBOP_LOOPBACK_CONNECTION
@@ -0,0 +1,71 @@
+/**********************************************************************************
+ * MIT License
+ * 
+ * Copyright (c) 2018 Antoine Beauchamp
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#ifndef LIB_PBOP_METHOD_STATISTICS
+#define LIB_PBOP_METHOD_STATISTICS
+
+#include "pbop/LatencyHistogram.h"
+
+#include <string>
+
+namespace pbop
+{
+
+  /// <summary>Processing phases of a call in the server. Phases are listed in processing order.</summary>
+  enum CallPhase
+  {
+    CALL_PHASE_DECODE,  // Parsing of the client's request.
+    CALL_PHASE_QUEUE,   // Waiting for the scheduler or for a worker thread.
+    CALL_PHASE_EXECUTE, // Execution of the service method.
+    CALL_PHASE_ENCODE,  // Serialization of the server's response.
+    CALL_PHASE_WRITE,   // Writing the response to the client, including waiting for the previous responses of the session.
+    CALL_PHASE_TOTAL,   // From the reception of the request to the response being written.
+    CALL_PHASE_COUNT,
+  };
+
+  /// <summary>
+  /// Get the name of a call phase.
+  /// </summary>
+  /// <param name="phase">The call phase.</param>
+  /// <returns>Returns the name of the phase. ie: "execute". Returns an empty string for an invalid phase.</returns>
+  const char * GetCallPhaseName(CallPhase phase);
+
+  /// <summary>
+  /// Call statistics of a service method. All latencies are in nanoseconds.
+  /// </summary>
+  struct MethodStatistics
+  {
+    std::string package;                        // The package name of the service.
+    std::string service;                        // The name of the service.
+    std::string function;                       // The name of the method.
+    unsigned long long calls;                   // Number of completed calls.
+    unsigned long long errors;                  // Number of calls that returned an error status or that could not be sent to the client.
+    unsigned long long bytes_in;                // Total size of the requests.
+    unsigned long long bytes_out;               // Total size of the responses.
+    LatencyHistogram latency[CALL_PHASE_COUNT]; // Latency histogram of each phase. See CallPhase.
+  };
+
+}; //namespace pbop
+
+#endif //LIB_PBOP_METHOD_STATISTICS
@@ -25,6 +25,8 @@
 #ifndef LIB_PBOP_MUTEX
 #define LIB_PBOP_MUTEX
 
+#include "pbop/LockProfiler.h"
+
 namespace pbop
 {
 
@@ -54,6 +56,25 @@ namespace pbop
     /// Release the mutex.
     /// </summary>
     void Unlock();
+
+    /// <summary>
+    /// Assign a name to the mutex. Named mutexes are profiled when the library is built with PBOP_ENABLE_LOCK_PROFILING.
+    /// The name should be assigned before the mutex is used.
+    /// </summary>
+    /// <param name="name">The name of the mutex.</param>
+    void SetName(const char * name);
+
+    /// <summary>
+    /// Get the name of the mutex.
+    /// </summary>
+    /// <returns>Returns the name of the mutex. Returns an empty string if the mutex is not named.</returns>
+    const char * GetName() const;
+
+    /// <summary>
+    /// Get the contention statistics of the mutex.
+    /// </summary>
+    /// <param name="statistics">The output statistics. All counters are zero if the mutex is not profiled.</param>
+    void GetStatistics(LockStatistics & statistics) const;
   };
 
 }; //namespace pbop
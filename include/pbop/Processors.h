@@ -0,0 +1,69 @@
+/**********************************************************************************
+ * MIT License
+ * 
+ * Copyright (c) 2018 Antoine Beauchamp
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#ifndef LIB_PBOP_PROCESSORS
+#define LIB_PBOP_PROCESSORS
+
+#include <vector>
+
+namespace pbop
+{
+
+  /// <summary>
+  /// Get the number of logical processors of the system.
+  /// </summary>
+  /// <returns>Returns the number of logical processors of the system. Returns at least 1.</returns>
+  unsigned int GetProcessorCount();
+
+  /// <summary>
+  /// Get the logical processors on which the current process is allowed to run.
+  /// On Windows, only the processors of the processor group of the process are returned.
+  /// </summary>
+  /// <param name="processors">The output list of processor numbers.</param>
+  /// <returns>Returns true if the processors of the process were found. Returns false otherwise.</returns>
+  bool GetProcessProcessors(std::vector<unsigned int> & processors);
+
+  /// <summary>
+  /// Get the number of NUMA nodes of the system.
+  /// </summary>
+  /// <returns>Returns the number of NUMA nodes of the system. Returns 1 on systems without NUMA support.</returns>
+  unsigned int GetNumaNodeCount();
+
+  /// <summary>
+  /// Get the logical processors that belongs to a NUMA node.
+  /// </summary>
+  /// <param name="node">The NUMA node number.</param>
+  /// <param name="processors">The output list of processor numbers.</param>
+  /// <returns>Returns true if the processors of the node were found. Returns false otherwise.</returns>
+  bool GetNumaNodeProcessors(unsigned int node, std::vector<unsigned int> & processors);
+
+  /// <summary>
+  /// Get the logical processor on which the calling thread is running.
+  /// </summary>
+  /// <returns>Returns the logical processor number of the calling thread. Returns 0 if unknown.</returns>
+  unsigned int GetCurrentProcessor();
+
+}; //namespace pbop
+
+#endif //LIB_PBOP_PROCESSORS
@@ -25,6 +25,8 @@
 #ifndef LIB_PBOP_READ_WRITE_LOCK
 #define LIB_PBOP_READ_WRITE_LOCK
 
+#include "pbop/LockProfiler.h"
+
 namespace pbop
 {
 
@@ -69,6 +71,25 @@ namespace pbop
     /// Leave the writing critical section.
     /// </summary>
     void UnlockWrite();
+
+    /// <summary>
+    /// Assign a name to the lock. Named locks are profiled when the library is built with PBOP_ENABLE_LOCK_PROFILING.
+    /// The name should be assigned before the lock is used.
+    /// </summary>
+    /// <param name="name">The name of the lock.</param>
+    void SetName(const char * name);
+
+    /// <summary>
+    /// Get the name of the lock.
+    /// </summary>
+    /// <returns>Returns the name of the lock. Returns an empty string if the lock is not named.</returns>
+    const char * GetName() const;
+
+    /// <summary>
+    /// Get the contention statistics of the lock.
+    /// </summary>
+    /// <param name="statistics">The output statistics. All counters are zero if the lock is not profiled.</param>
+    void GetStatistics(LockStatistics & statistics) const;
   };
 
 }; //namespace pbop
@@ -32,6 +32,8 @@
 #include "pbop/Events.h"
 #include "pbop/Thread.h"
 #include "pbop/ReadWriteLock.h"
+#include "pbop/CriticalSection.h"
+#include "pbop/MethodStatistics.h"
 
 #include <string>
 #include <vector>
@@ -39,6 +41,12 @@
 namespace pbop
 {
 
+  class ClientRequest;
+  class WorkStealingExecutor;
+  class CallScheduler;
+  class StatisticsRegistry;
+  struct CallRecord;
+
   /// <summary>
   /// A pipe server that handles communication from clients.
   /// </summary>
@@ -58,6 +66,36 @@ namespace pbop
     /// <summary>The default reading timeout time in milliseconds.</summary>
     static const unsigned long & DEFAULT_TIMEOUT_TIME;
 
+    /// <summary>Placement policy of client session threads.</summary>
+    enum SessionPlacement
+    {
+      PLACEMENT_NONE,         // Session threads are not pinned and may run on any processor.
+      PLACEMENT_ROUND_ROBIN,  // Each new session is assigned to the next processor or NUMA node.
+      PLACEMENT_LEAST_LOADED, // Each new session is assigned to the processor or NUMA node with the fewest active sessions.
+    };
+
+    /// <summary>Unit on which client session threads are pinned.</summary>
+    enum PlacementUnit
+    {
+      PLACEMENT_UNIT_PROCESSOR, // Session threads are pinned to a single logical processor.
+      PLACEMENT_UNIT_NUMA_NODE, // Session threads are pinned to all the processors of a NUMA node.
+    };
+
+    /// <summary>Priority class of the calls to a method. Queued calls of a higher class are executed first.</summary>
+    enum CallPriority
+    {
+      PRIORITY_LOW,
+      PRIORITY_NORMAL,
+      PRIORITY_HIGH,
+    };
+
+    /// <summary>Scheduling options of a method or a service.</summary>
+    struct MethodOptions
+    {
+      unsigned int max_concurrency; // Maximum number of calls executing at the same time. The value 0 means unlimited.
+      CallPriority priority;        // Priority class of the calls.
+    };
+
     /// <summary>
     /// Set the send and receive buffers size of the connection
     /// </summary>
@@ -76,6 +114,71 @@ namespace pbop
     /// <returns>Returns the pipe name use with the Run() command.</returns>
     virtual const char * GetPipeName() const;
 
+    /// <summary>
+    /// Set how client session threads are assigned to processors or NUMA nodes.
+    /// A pinned session allocates its buffers from its own thread so that memory is local to its node.
+    /// Sessions are only pinned to the processors on which the process is allowed to run.
+    /// A session that cannot be pinned runs unpinned and is not counted in the load of its slot.
+    /// Must be called before Run().
+    /// </summary>
+    /// <param name="placement">The placement policy.</param>
+    /// <param name="unit">The unit on which session threads are pinned.</param>
+    virtual void SetSessionPlacement(SessionPlacement placement, PlacementUnit unit);
+
+    /// <summary>
+    /// Get the placement policy of client session threads.
+    /// </summary>
+    /// <returns>Returns the placement policy of client session threads.</returns>
+    virtual SessionPlacement GetSessionPlacement() const;
+
+    /// <summary>
+    /// Get the unit on which client session threads are pinned.
+    /// </summary>
+    /// <returns>Returns the unit on which client session threads are pinned.</returns>
+    virtual PlacementUnit GetPlacementUnit() const;
+
+    /// <summary>
+    /// Set the number of worker threads that execute the calls of scheduled methods (see SetMethodOptions()).
+    /// Workers cap and prioritize the execution of scheduled calls. They do not add parallelism: each client session
+    /// already runs on its own thread and waits for the response of its current call before reading the client's next request.
+    /// The calls of methods without options are always executed on the client sessions threads.
+    /// Events related to a scheduled call may be published from a worker thread.
+    /// The value 0 executes all service methods on the client sessions threads. This is the default.
+    /// Must be called before Run().
+    /// </summary>
+    /// <param name="num_workers">The number of worker threads. See GetProcessorCount() for using one worker per processor.</param>
+    virtual void SetWorkerCount(unsigned int num_workers);
+
+    /// <summary>
+    /// Get the number of worker threads that execute service methods.
+    /// </summary>
+    /// <returns>Returns the number of worker threads that execute service methods. Returns 0 if service methods are executed on the client sessions threads.</returns>
+    virtual unsigned int GetWorkerCount() const;
+
+    /// <summary>
+    /// Set the scheduling options of a method or of all methods of a service.
+    /// Calls that exceed the concurrency limit are queued until a running call completes.
+    /// When workers are enabled, calls also wait for an available worker and queued calls are executed by priority class.
+    /// The options of a service are shared by all its methods that do not have their own options.
+    /// Options must be set before the server is started. Calls that are already executing would not be counted.
+    /// </summary>
+    /// <param name="package">The package name of the service.</param>
+    /// <param name="service">The name of the service.</param>
+    /// <param name="function">The name of the method. Set to NULL to set the options of the service.</param>
+    /// <param name="options">The scheduling options.</param>
+    /// <returns>Returns a Status instance which code is set to STATUS_CODE_SUCCESS when the operation is successful. Returns STATUS_CODE_CANCELLED if the server is running.</returns>
+    virtual Status SetMethodOptions(const char * package, const char * service, const char * function, const MethodOptions & options);
+
+    /// <summary>
+    /// Get the scheduling options of a method or of a service.
+    /// </summary>
+    /// <param name="package">The package name of the service.</param>
+    /// <param name="service">The name of the service.</param>
+    /// <param name="function">The name of the method. Set to NULL to get the options of the service.</param>
+    /// <param name="options">The output scheduling options.</param>
+    /// <returns>Returns true if options are defined for the given method or service. Returns false otherwise.</returns>
+    virtual bool GetMethodOptions(const char * package, const char * service, const char * function, MethodOptions & options) const;
+
     /// <summary>
     /// Run the server and monitors incomming connections.
     /// The function is blocking until Shutdown() function is called.
@@ -84,6 +187,25 @@ namespace pbop
     /// <returns>Returns a Status instance which code is set to STATUS_CODE_SUCCESS when the operation is successful.</returns>
     virtual Status Run(const char * pipe_name);
 
+    /// <summary>
+    /// Start the server without listening on a pipe. The function returns immediately.
+    /// Clients are attached to the server with AddConnection() or use an InProcessConnection.
+    /// The server runs until Shutdown() function is called.
+    /// </summary>
+    /// <returns>Returns a Status instance which code is set to STATUS_CODE_SUCCESS when the operation is successful.</returns>
+    virtual Status Start();
+
+    /// <summary>
+    /// Add a client connection to a running server. The server creates a client session for the connection
+    /// as if the client had connected to the server's pipe. This allows the server to use other kinds of connections.
+    /// ie: a LoopbackConnection.
+    /// The server takes ownership of the connection unless the server is not running.
+    /// The server can be running from Run() or Start().
+    /// </summary>
+    /// <param name="connection">A valid connection to a client.</param>
+    /// <returns>Returns a Status instance which code is set to STATUS_CODE_SUCCESS when the operation is successful.</returns>
+    virtual Status AddConnection(Connection * connection);
+
     /// <summary>
     /// Register a service implementation to the server.
     /// The server takes ownership of the service instance.
@@ -91,27 +213,112 @@ namespace pbop
     /// <param name="service">A valid service instance.</param>
     virtual void RegisterService(Service * service);
 
+    /// <summary>
+    /// Find a registered service.
+    /// </summary>
+    /// <param name="package_name">The package name of the service.</param>
+    /// <param name="service_name">The service name of the service.</param>
+    /// <returns>Returns the matching service instance. Returns NULL if no service is registered with the given names.</returns>
+    virtual Service * FindService(const char * package_name, const char * service_name);
+
+    /// <summary>
+    /// Enable or disable the recording of call statistics.
+    /// When enabled, the server records the number of calls, errors, bytes and the latency of each processing phase
+    /// of the methods of the registered services. Statistics are disabled by default.
+    /// </summary>
+    /// <param name="enabled">Set to true to record call statistics.</param>
+    virtual void SetStatisticsEnabled(bool enabled);
+
+    /// <summary>
+    /// Returns true if call statistics are recorded.
+    /// </summary>
+    /// <returns>Returns true if call statistics are recorded. Returns false otherwise.</returns>
+    virtual bool IsStatisticsEnabled() const;
+
+    /// <summary>
+    /// Enable or disable the EventCallBegin and EventCallEnd events.
+    /// The events are published around the execution of each service method.
+    /// When disabled, the server does not build the events and the cost is a single branch per call.
+    /// Call events are disabled by default.
+    /// </summary>
+    /// <param name="enabled">Set to true to publish call events.</param>
+    virtual void SetCallEventsEnabled(bool enabled);
+
+    /// <summary>
+    /// Returns true if call events are published.
+    /// </summary>
+    /// <returns>Returns true if call events are published. Returns false otherwise.</returns>
+    virtual bool IsCallEventsEnabled() const;
+
+    /// <summary>
+    /// Get the call statistics of the methods of the registered services.
+    /// The statistics can also be published to clients by registering a StatisticsService::Service to the server.
+    /// A call is recorded once its response is written to the client.
+    /// </summary>
+    /// <param name="statistics">The output list of statistics. One element per method.</param>
+    virtual void GetStatistics(std::vector<MethodStatistics> & statistics) const;
+
+    /// <summary>
+    /// Get the call statistics of the methods of the registered services and optionally reset them to zero.
+    /// The statistics of each method are read and reset in a single operation. A call that completes
+    /// at the same time is either returned or kept for the next read but never lost.
+    /// The elements of the list are reused when the list already has one element per method.
+    /// </summary>
+    /// <param name="statistics">The output list of statistics. One element per method.</param>
+    /// <param name="reset">Set to true to reset the statistics of all methods to zero.</param>
+    virtual void GetStatistics(std::vector<MethodStatistics> & statistics, bool reset);
+
+    /// <summary>
+    /// Reset the call statistics of all methods to zero.
+    /// </summary>
+    virtual void ResetStatistics();
+
     // Threads support for client connections
     class ClientSession;
+    class CallTask;
   private:
     friend class ClientSession;
+    friend class CallTask;
+    friend class InProcessConnection;
     virtual unsigned long RunMessageProcessingLoop(ClientSession * context);
     virtual Status RouteMessageToServiceMethod(const std::string & input, std::string & output);
+    virtual Status RouteMessageToServiceMethod(const ClientRequest & client_message, std::string & output);
+    Status InvokeServiceMethod(ClientSession * context, const ClientRequest & client_message, std::string & output);
+    Status DecodeClientRequest(const std::string & input, ClientRequest & client_message);
+    bool ExecuteCall(ClientSession * context, const ClientRequest & client_message, Status status, std::string & write_buffer, CallRecord & record);
+    bool WriteResponse(ClientSession * context, const std::string & write_buffer);
+    void CompleteCall(ClientSession * context, bool success, const std::string & write_buffer, CallRecord & record);
+    void ScheduleCall(ClientSession * context, CallTask * task, const std::string & service_key, const std::string & method_key);
+    Status Startup();
+    void Cleanup();
+    Status StartSession(Connection * connection);
+    void InitPlacementSlots();
+    int AcquirePlacementSlot();
+    void ReleasePlacementSlot(int slot);
   public:
 
     /// <summary>
-    /// Returns true if the server is running the Run() method.
+    /// Returns true if the server is running the Run() method or was started with Start().
     /// </summary>
-    /// <returns>Returns true if the server is running the Run() method. Returns false otherwise.</returns>
+    /// <returns>Returns true if the server is running. Returns false otherwise.</returns>
     virtual bool IsRunning() const;
 
     /// <summary>
     /// Shut down the server. This forces the Run() method to exit gracefully.
+    /// A server started with Start() is shut down from the calling thread.
+    /// The function may be called from a client session thread, for example from a service method. It must not be called from a worker thread.
     /// The shutdown process may fail if Client Session are still active after the shut down signal is sent to the server.
     /// </summary>
     /// <returns>Returns a Status instance which code is set to STATUS_CODE_SUCCESS when the operation is successful.</returns>
     virtual Status Shutdown();
 
+    /// <summary>
+    /// Format the contention statistics of all named locks into a human readable table.
+    /// Statistics are only recorded when the library is built with PBOP_ENABLE_LOCK_PROFILING.
+    /// </summary>
+    /// <returns>Returns a string with one line per named lock.</returns>
+    virtual std::string DumpLockStatistics() const;
+
     /// <summary>Callback function for the event that is published when the server starting up.</summary>
     virtual void OnEvent(EventStartup * e) {};
 
@@ -136,6 +343,12 @@ namespace pbop
     /// <summary>Callback function for the event that is published when a client session has encountered an error.</summary>
     virtual void OnEvent(EventClientError * e) {};
 
+    /// <summary>Callback function for the event that is published before a service method is executed. See SetCallEventsEnabled().</summary>
+    virtual void OnEvent(EventCallBegin * e) {};
+
+    /// <summary>Callback function for the event that is published after a service method is executed. See SetCallEventsEnabled().</summary>
+    virtual void OnEvent(EventCallEnd * e) {};
+
   private:
     std::string pipe_name_;
     unsigned int buffer_size_;
@@ -143,6 +356,19 @@ namespace pbop
     bool running_;
     volatile bool shutdown_request_;
     volatile bool shutdown_processed_;
+    SessionPlacement placement_;
+    PlacementUnit placement_unit_;
+    std::vector<std::vector<unsigned int> > placement_slots_; // processors of each slot
+    std::vector<unsigned int> placement_loads_;               // number of active sessions of each slot
+    size_t next_placement_slot_;
+    CriticalSection placement_lock_;
+    CriticalSection sessions_lock_; // protects client_sessions_ and next_connection_id_
+    unsigned int num_workers_;
+    WorkStealingExecutor * executor_;
+    CallScheduler * scheduler_;
+    volatile bool call_events_enabled_;
+    volatile bool statistics_enabled_;
+    StatisticsRegistry * statistics_;
   protected:
     std::vector<Service *> services_;
     std::vector<ClientSession *> client_sessions_;
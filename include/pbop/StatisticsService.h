@@ -0,0 +1,112 @@
+/**********************************************************************************
+ * MIT License
+ * 
+ * Copyright (c) 2018 Antoine Beauchamp
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#ifndef LIB_PBOP_STATISTICS_SERVICE
+#define LIB_PBOP_STATISTICS_SERVICE
+
+#include "pbop/Status.h"
+#include "pbop/Service.h"
+#include "pbop/Connection.h"
+
+namespace pbop
+{
+
+  class Server;
+  class GetStatisticsRequest;
+  class GetStatisticsResponse;
+
+  /// <summary>
+  /// A service that publishes the call statistics of a server to its clients.
+  /// The messages of the service are defined in pbop.proto.
+  /// </summary>
+  class StatisticsService
+  {
+  public:
+
+    /// <summary>
+    /// Client of the statistics service.
+    /// </summary>
+    class Client
+    {
+    public:
+      /// <summary>
+      /// Create a client of the statistics service.
+      /// The client takes ownership of the connection.
+      /// </summary>
+      /// <param name="connection">A connection to the server.</param>
+      Client(Connection * connection);
+      virtual ~Client();
+    private:
+      Client(const Client & copy); //disable copy constructor.
+      Client & operator =(const Client & other); //disable assignment operator.
+    public:
+
+      /// <summary>
+      /// Get the call statistics of the server.
+      /// </summary>
+      /// <param name="request">The request options.</param>
+      /// <param name="response">The statistics of each method of the server.</param>
+      /// <returns>Returns a Status instance which code is set to STATUS_CODE_SUCCESS when the operation is successful.</returns>
+      Status GetStatistics(const GetStatisticsRequest & request, GetStatisticsResponse & response);
+
+    private:
+      Connection * connection_;
+    };
+
+    /// <summary>
+    /// Implementation of the statistics service.
+    /// Register an instance to a server with Server::RegisterService() to publish its statistics.
+    /// </summary>
+    class Service : public pbop::Service
+    {
+    public:
+      /// <summary>
+      /// Create the statistics service of a server.
+      /// </summary>
+      /// <param name="server">The server which statistics are published. The server must outlive the service.</param>
+      Service(Server * server);
+      virtual ~Service();
+
+      virtual const char * GetPackageName() const;
+      virtual const char * GetServiceName() const;
+      virtual const char ** GetFunctionIdentifiers() const;
+      virtual Status InvokeMethod(const size_t & index, const std::string & input, std::string & output);
+
+      /// <summary>
+      /// Fill the response with the server's call statistics.
+      /// </summary>
+      /// <param name="request">The request options.</param>
+      /// <param name="response">The statistics of each method of the server.</param>
+      /// <returns>Returns a Status instance which code is set to STATUS_CODE_SUCCESS when the operation is successful.</returns>
+      virtual Status GetStatistics(const GetStatisticsRequest & request, GetStatisticsResponse & response);
+
+    private:
+      Server * server_;
+    };
+
+  };
+
+}; //namespace pbop
+
+#endif //LIB_PBOP_STATISTICS_SERVICE
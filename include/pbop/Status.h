@@ -27,7 +27,15 @@
 
 #include <string>
 
-#include <google/protobuf/message.h>
+// Forward declarations. Only the protobuf headers of the messages given to Status::Factory are required.
+namespace google
+{
+  namespace protobuf
+  {
+    class Message;
+    class MessageLite;
+  }; //namespace protobuf
+}; //namespace google
 
 namespace pbop
 {
@@ -51,12 +59,20 @@ namespace pbop
     STATUS_CODE_IMPLEMENTATION,       // An error in the server's specific service implementation occured.
   };
 
+  /// <summary>
+  /// The result of an operation: a code and an optional error description.
+  /// The description is stored out-of-line and only allocated when it is not empty.
+  /// A successful status does not allocate memory when it is created, copied or moved.
+  /// The description of a status created by Status::Factory is formatted when it is first read.
+  /// </summary>
   class Status
   {
   public:
     Status();
     Status(const Status & other);
+    Status(Status && other) noexcept;
     Status(const StatusCode & code, const std::string & message);
+    Status(const StatusCode & code, const char * message);
     virtual ~Status();
 
     /// <summary>
@@ -87,12 +103,13 @@ namespace pbop
     /// Provides the error state of the status. Either success or any other error.
     /// </summary>
     /// <returns>Returns true if the code assigned to this status is STATUS_CODE_SUCCESS. Returns false otherwise.</returns>
-    bool Success();
+    bool Success() const;
 
-    friend void swap(Status & first, Status & second);
-    Status & operator=(Status other);
-    bool operator==(const Status & other);
-    bool operator!=(const Status & other);
+    friend void swap(Status & first, Status & second) noexcept;
+    Status & operator=(const Status & other);
+    Status & operator=(Status && other) noexcept;
+    bool operator==(const Status & other) const;
+    bool operator!=(const Status & other) const;
 
     /// <returns>Returns a Status instance which code is set to STATUS_CODE_SUCCESS.</returns>
     static const Status & OK;
@@ -106,6 +123,11 @@ namespace pbop
 
     /// <summary>
     /// Factory class for creating Status with similar error message.
+    /// The error description is not formatted until GetDescription() is called.
+    /// The given function and field strings are not copied and must remain valid for the lifetime
+    /// of the returned Status. ie: string literals or __FUNCTION__.
+    /// The descriptor of the given message type must also outlive the returned Status.
+    /// Messages of the lite runtime do not have a descriptor: their type name is copied.
     /// </summary>
     class Factory
     {
@@ -124,6 +146,7 @@ namespace pbop
       /// <param name="message">The protobuf message that was serialized.</param>
       /// <returns>Returns a Status instance which code is set to STATUS_CODE_SERIALIZE_ERROR.</returns>
       static Status Serialization(const char * function, const ::google::protobuf::Message & message);
+      static Status Serialization(const char * function, const ::google::protobuf::MessageLite & message);
 
       /// <summary>
       /// Create a Status when an deserialization error is found.
@@ -132,6 +155,7 @@ namespace pbop
       /// <param name="message">The protobuf message that was deserialized.</param>
       /// <returns>Returns a Status instance which code is set to STATUS_CODE_DESERIALIZE_ERROR.</returns>
       static Status Deserialization(const char * function, const ::google::protobuf::Message & message);
+      static Status Deserialization(const char * function, const ::google::protobuf::MessageLite & message);
 
       /// <summary>
       /// Create a Status when a protobuf field is missing.
@@ -141,6 +165,7 @@ namespace pbop
       /// <param name="message">The protobuf message that had a missing field.</param>
       /// <returns>Returns a Status instance which code is set to STATUS_CODE_DESERIALIZE_ERROR.</returns>
       static Status MissingField(const char * function, const char * field, const ::google::protobuf::Message & message);
+      static Status MissingField(const char * function, const char * field, const ::google::protobuf::MessageLite & message);
 
       /// <summary>
       /// Create a Status when a function is not implemented.
@@ -151,8 +176,11 @@ namespace pbop
     };
 
   private:
+    struct Detail;
+    Status(const StatusCode & code, Detail * detail);
+
     StatusCode code_;
-    std::string description_;
+    Detail * detail_; // NULL when the description is empty
   };
 
 }; //namespace pbop
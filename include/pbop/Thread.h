@@ -25,24 +25,25 @@
 #ifndef LIB_PBOP_THREAD
 #define LIB_PBOP_THREAD
 
-//Define `HANDLE` ourselve to prevent a dependency on <Windows.h>.
-//Using `#include <WinNT.h>` to only get the definition of `HANDLE` results in multiple errors:
-//  WinNT.h(351): error C2146: syntax error : missing ';' before identifier 'WCHAR'
-//  WinNT.h(351): error C4430: missing type specifier - int assumed. Note: C++ does not support default-int
-//  WinNT.h(355): error C2143: syntax error : missing ';' before '*'
-//  WinNT.h(355): error C2040: 'PWSTR' : 'CONST' differs in levels of indirection from 'WCHAR *'
-//  WinNT.h(355): error C4430: missing type specifier - int assumed. Note: C++ does not support default-int
-//  WinNT.h(357): error C2143: syntax error : missing ';' before '*'
-//  WinNT.h(357): error C2371: 'WCHAR' : redefinition; different basic types
-//Maybe because its missing include/header guards.
-typedef void *PVOID;
-typedef PVOID HANDLE;
-
 #include "pbop/Status.h"
 
+#include <stddef.h>
+#include <vector>
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
 namespace pbop
 {
 
+#ifdef _WIN32
+  ///<summary>Native handle of a thread. Same as the Win32 `HANDLE` type without requiring <Windows.h>.</summary>
+  typedef void * thread_handle_t;
+#else
+  ///<summary>Native handle of a thread.</summary>
+  typedef pthread_t thread_handle_t;
+#endif
+
   class Thread
   {
   public:
@@ -90,7 +91,7 @@ namespace pbop
     /// Get the thread handle.
     /// </summary>
     /// <returns>Returns the thread handle.</returns>
-    virtual HANDLE GetHandle() const = 0;
+    virtual thread_handle_t GetHandle() const = 0;
     
     /// <summary>
     /// Get the thread id.
@@ -98,6 +99,47 @@ namespace pbop
     /// <returns>Returns the thread id.</returns>
     virtual unsigned long GetId() const = 0;
 
+    /// <summary>
+    /// Set the name of the thread. The name is visible in debuggers and system tools.
+    /// The name is applied the next time the thread is started.
+    /// </summary>
+    /// <remarks>On Linux, the name is truncated to 15 characters.</remarks>
+    /// <param name="name">The name of the thread.</param>
+    virtual void SetName(const char * name) = 0;
+
+    /// <summary>
+    /// Get the name of the thread.
+    /// </summary>
+    /// <returns>Returns the name of the thread. Returns an empty string if the thread is not named.</returns>
+    virtual const char * GetName() const = 0;
+
+    /// <summary>
+    /// Set the stack size of the thread.
+    /// The stack size is applied the next time the thread is started.
+    /// </summary>
+    /// <param name="stack_size">The stack size in bytes. The value 0 means the system's default stack size.</param>
+    virtual void SetStackSize(size_t stack_size) = 0;
+
+    /// <summary>
+    /// Get the stack size of the thread.
+    /// </summary>
+    /// <returns>Returns the stack size of the thread in bytes. Returns 0 if the system's default stack size is used.</returns>
+    virtual size_t GetStackSize() const = 0;
+
+    /// <summary>
+    /// Set the processors on which the thread is allowed to run.
+    /// The affinity is applied the next time the thread is started.
+    /// </summary>
+    /// <remarks>On Windows, only the processors of the first processor group (0 to 63) are supported.</remarks>
+    /// <param name="processors">The list of processor numbers. An empty list allows the thread to run on any processor.</param>
+    virtual void SetAffinity(const std::vector<unsigned int> & processors) = 0;
+
+    /// <summary>
+    /// Get the processors on which the thread is allowed to run.
+    /// </summary>
+    /// <returns>Returns the list of processor numbers. Returns an empty list if the thread is allowed to run on any processor.</returns>
+    virtual const std::vector<unsigned int> & GetAffinity() const = 0;
+
   };
 
 }; //namespace pbop
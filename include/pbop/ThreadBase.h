@@ -0,0 +1,91 @@
+/**********************************************************************************
+ * MIT License
+ * 
+ * Copyright (c) 2018 Antoine Beauchamp
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#ifndef LIB_PBOP_THREADBASE
+#define LIB_PBOP_THREADBASE
+
+#include "pbop/Thread.h"
+
+#include <string>
+
+namespace pbop
+{
+
+  /// <summary>
+  /// Portable implementation of the Thread interface.
+  /// Uses the Win32 thread api on Windows and pthreads on other platforms.
+  /// Derived classes implements the Execute() method which is executed concurrently.
+  /// </summary>
+  class ThreadBase : public virtual Thread
+  {
+  private:
+    struct PImpl;
+    PImpl * impl_;
+
+  public:
+    ThreadBase();
+    virtual ~ThreadBase();
+  private:
+    ThreadBase(const ThreadBase & copy); //disable copy constructor.
+    ThreadBase & operator =(const ThreadBase & other); //disable assignment operator.
+
+  protected:
+    /// <summary>
+    /// The function that is executed concurrently when the thread is started.
+    /// </summary>
+    /// <returns>Returns the thread exit code.</returns>
+    virtual unsigned long Execute() = 0;
+
+  public:
+    virtual Status Start();
+    virtual void Join();
+    virtual void SetInterrupt();
+    virtual bool IsInterrupted() const;
+    virtual bool IsRunning() const;
+    virtual thread_handle_t GetHandle() const;
+    virtual unsigned long GetId() const;
+    virtual void SetName(const char * name);
+    virtual const char * GetName() const;
+    virtual void SetStackSize(size_t stack_size);
+    virtual size_t GetStackSize() const;
+
+    /// <summary>
+    /// Set the processors on which the thread is allowed to run. Must be called before Start().
+    /// Start() fails if the thread cannot be pinned to the given processors.
+    /// </summary>
+    /// <param name="processors">The list of processor numbers. An empty list does not pin the thread.</param>
+    virtual void SetAffinity(const std::vector<unsigned int> & processors);
+    virtual const std::vector<unsigned int> & GetAffinity() const;
+
+    /// <summary>
+    /// Get the description of a system error code.
+    /// </summary>
+    /// <param name="code">The error code returned by GetLastError() on Windows or errno on other platforms.</param>
+    /// <returns>Returns the description of the error code.</returns>
+    static std::string GetErrorDescription(unsigned long code);
+  };
+
+}; //namespace pbop
+
+#endif //LIB_PBOP_THREADBASE
@@ -25,35 +25,21 @@
 #ifndef LIB_PBOP_THREADBUILDER
 #define LIB_PBOP_THREADBUILDER
 
-#include "pbop/Thread.h"
-#include <string>
+#include "pbop/ThreadBase.h"
 
 namespace pbop
 {
 
   /// <summary>
-  /// Template class for creating threads.
+  /// Template class for creating threads that execute a method of an object.
   /// Inpired from https://stackoverflow.com/questions/1372967/how-do-you-use-createthread-for-functions-which-are-class-members
   /// </summary>
   template<class T>
-  class ThreadBuilder : public virtual Thread
+  class ThreadBuilder : public ThreadBase
   {
   private:
     ///<summary>Type definition to a pointer of a method of class T with no parameters</summary>
-    typedef DWORD (T::*TMethodPointer)(void);
-
-  protected:
-    ///<summary>Handle of the thread</summary>
-    HANDLE hThread_;
-  private:
-    ///<summary>Thread id of the thread. The value 0 means invalid.</summary>
-    DWORD dwThreadID_;
-
-    ///<summary>An interrupt request flag .</summary>
-    volatile bool bInterrupt_;
-
-    ///<summary>Force that only one thread allowed to call start() mutex.</summary>
-    HANDLE hSingleStart_;
+    typedef unsigned long (T::*TMethodPointer)(void);
 
     ///<summary>The object which owns the method that executes concurently.</summary>
     T* object_;
@@ -61,23 +47,17 @@ namespace pbop
     ///<summary>The method pointer of the object of type T which is executed concurently.</summary>
     TMethodPointer lpMethod_;
 
-  private:
-    /// <summary>
-    /// Target function argument of the CreateThread() function.
-    /// </summary>
-    /// <param name="thread_obj">A pointer to this Thread object.</param>
-    /// <returns>Returns the thread exit code. Returns 0 on </returns>
-    static DWORD Run(LPVOID thread_obj)
-    {
-      ThreadBuilder<T>* thread = (ThreadBuilder<T>*)thread_obj;
-      return (thread->object_->*thread->lpMethod_) ();
-    }
-
     ///<summary>Disable copy constructor. Prevent copying of thread objects.</summary>
-    ThreadBuilder(const ThreadBuilder<T>& other) {}
+    ThreadBuilder(const ThreadBuilder<T>& other);
 
     ///<summary>Disable assignment operator. Prevent assignment of thread objects.</summary>
-    ThreadBuilder<T>& operator =(const ThreadBuilder<T>& other) {}
+    ThreadBuilder<T>& operator =(const ThreadBuilder<T>& other);
+
+  protected:
+    virtual unsigned long Execute()
+    {
+      return (object_->*lpMethod_) ();
+    }
 
   public:
     /// <summary>
@@ -87,135 +67,27 @@ namespace pbop
     /// <param name="lpMethod">The method pointer of the object of type T which is executed concurently.</param>
     explicit ThreadBuilder(T* object, TMethodPointer lpMethod)
     {
-      this->hThread_       = NULL;
       this->object_        = object;
       this->lpMethod_      = lpMethod;
-      this->dwThreadID_    = 0;
-      this->bInterrupt_    = false;
-      this->hSingleStart_  = CreateMutex(NULL, FALSE, NULL);
     }
 
     virtual ~ThreadBuilder(void)
     {
+      // Execute() must not be called once this object is destroyed.
       Join();
-
-      if (hSingleStart_)
-        CloseHandle(hSingleStart_);
-      if (hThread_)
-        CloseHandle(hThread_);
-    }
-
-    std::string GetErrorDesription(DWORD code)
-    {
-      const DWORD error_buffer_size = 10240;
-      char error_buffer[error_buffer_size] = { 0 };
-      ::FormatMessage(FORMAT_MESSAGE_FROM_SYSTEM,
-        NULL,
-        code,
-        MAKELANGID(LANG_NEUTRAL, SUBLANG_DEFAULT),
-        error_buffer,
-        error_buffer_size - 1,
-        NULL);
-      std::string error_desc = error_buffer;
-      return error_desc;
-    }
-
-    class ScopeReleaseMutex
-    {
-    public:
-      HANDLE hMutex_;
-
-    public:
-      ScopeReleaseMutex(HANDLE hMutex) : hMutex_(hMutex) {}
-      ~ScopeReleaseMutex()
-      {
-        ReleaseMutex(hMutex_);
-      }
-    };
-
-    Status Start()
-    {
-      ScopeReleaseMutex scope_release(hSingleStart_);
-
-      if (WaitForSingleObject(hSingleStart_, 0) != WAIT_OBJECT_0)
-      {
-        return Status(STATUS_CODE_CANCELLED, "Another thread is already starting this thread.");
-      }
-      if (hThread_) // The thread had been started sometime in the past
-      {
-        // Is the thread still running?
-        if (WaitForSingleObject(hThread_, 0) == WAIT_TIMEOUT)
-        {
-          return Status(STATUS_CODE_CANCELLED, "The thread is already running.");
-        }
-
-        // Close the handle of the previous running thread.
-        CloseHandle(hThread_);
-        hThread_ = NULL;
-        dwThreadID_ = 0;
-      }
-
-      // Set or reset the 'not interrupted' state
-      bInterrupt_ = false;
-
-      hThread_ = CreateThread(
-        NULL,
-        0,
-        (LPTHREAD_START_ROUTINE) ThreadBuilder<T>::Run,
-        this,
-        0,
-        &this->dwThreadID_);
-
-      if (hThread_)
-      {
-        return Status::OK;
-      }
-
-      // CreateThread has failed.
-      std::string error_description = std::string("CreateThread failed: ") + GetErrorDesription(GetLastError());
-      return Status(STATUS_CODE_CANCELLED, error_description);
-    }
-
-    inline void Join()
-    {
-      WaitForSingleObject(hThread_, INFINITE);
-    }
-
-    inline void SetInterrupt()
-    {
-      bInterrupt_ = true;
-    }
-
-    inline bool IsInterrupted() const
-    {
-      return bInterrupt_;
-    }
-
-    inline bool IsRunning() const
-    {
-      DWORD exitCode = 0;
-      if (hThread_)
-        GetExitCodeThread(hThread_, &exitCode);
-      if (exitCode == STILL_ACTIVE)
-        return true;
-      return false;
-    }
-
-    __declspec(property(get = GetHandle)) HANDLE ThreadHandle;
-    
-    inline HANDLE GetHandle() const
-    {
-      return hThread_;
     }
 
-    __declspec(property(get = GetID)) DWORD ThreadID;
-    
-    inline DWORD GetId() const
+    /// <summary>
+    /// Deprecated. Use ThreadBase::GetErrorDescription() instead.
+    /// </summary>
+    /// <param name="code">The error code returned by GetLastError() on Windows or errno on other platforms.</param>
+    /// <returns>Returns the description of the error code.</returns>
+    std::string GetErrorDesription(unsigned long code)
     {
-      return dwThreadID_;
+      return ThreadBase::GetErrorDescription(code);
     }
   };
 
 }; //namespace pbop
 
-#endif //LIB_PBOP_THREADBUILDER
\ No newline at end of file
+#endif //LIB_PBOP_THREADBUILDER
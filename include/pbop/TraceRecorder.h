@@ -0,0 +1,173 @@
+/**********************************************************************************
+ * MIT License
+ * 
+ * Copyright (c) 2018 Antoine Beauchamp
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#ifndef LIB_PBOP_TRACE_RECORDER
+#define LIB_PBOP_TRACE_RECORDER
+
+#include "pbop/Types.h"
+#include "pbop/Status.h"
+
+#include <string>
+#include <atomic>
+
+namespace pbop
+{
+
+  /// <summary>Steps of a call that are recorded by the TraceRecorder.</summary>
+  enum TracePhase
+  {
+    TRACE_PHASE_DECODE,       // Server: parsing of the client's request.
+    TRACE_PHASE_EXECUTE,      // Server: execution of the service method.
+    TRACE_PHASE_ENCODE,       // Server: serialization of the response.
+    TRACE_PHASE_WRITE,        // Server: writing the response to the client.
+    TRACE_PHASE_CLIENT_CALL,  // Client: the complete call.
+    TRACE_PHASE_CLIENT_WRITE, // Client: writing the request to the server.
+    TRACE_PHASE_CLIENT_READ,  // Client: waiting for and reading the server's response.
+  };
+
+  /// <summary>Type of a trace record.</summary>
+  enum TraceEventType
+  {
+    TRACE_EVENT_BEGIN,
+    TRACE_EVENT_END,
+  };
+
+  /// <summary>
+  /// A fixed-size trace record.
+  /// </summary>
+  struct TraceRecord
+  {
+    unsigned long long timestamp;   // Raw timestamp. Time stamp counter ticks on x86 processors, nanoseconds otherwise.
+    const char * method;            // Identifies the called method. Must point to a string with static storage duration. May be NULL.
+    connection_id_t connection_id;  // The connection id of the call. 0 on the client side.
+    unsigned char phase;            // See TracePhase.
+    unsigned char type;             // See TraceEventType.
+  };
+
+  /// <summary>
+  /// Records the steps of calls into per-thread ring buffers.
+  /// Each thread writes to its own buffer without locking. When a buffer is full, the oldest records are overwritten.
+  /// The buffer of a thread that exits is kept with its records until it is reused by the next thread that records.
+  /// Recording is disabled by default. When disabled, the cost of a trace point is a single branch.
+  /// The records can be saved in the Chrome trace format which can be opened with chrome://tracing or https://ui.perfetto.dev.
+  /// </summary>
+  class TraceRecorder
+  {
+  public:
+    /// <summary>The default number of records of each thread's buffer.</summary>
+    static const size_t DEFAULT_CAPACITY;
+
+    /// <summary>
+    /// Start recording.
+    /// </summary>
+    /// <param name="capacity">The number of records of the buffers of threads that have not recorded yet.</param>
+    static void Enable(size_t capacity);
+
+    /// <summary>
+    /// Stop recording. The records are kept until Clear() is called.
+    /// </summary>
+    static void Disable();
+
+    /// <summary>
+    /// Returns true if the recorder is recording.
+    /// </summary>
+    /// <returns>Returns true if the recorder is recording. Returns false otherwise.</returns>
+    static inline bool IsEnabled()
+    {
+      return enabled_.load(std::memory_order_relaxed);
+    }
+
+    /// <summary>
+    /// Add a record to the calling thread's buffer.
+    /// </summary>
+    /// <param name="phase">The step of the call.</param>
+    /// <param name="type">The type of the record.</param>
+    /// <param name="connection_id">The connection id of the call.</param>
+    /// <param name="method">The name of the called method. Must point to a string with static storage duration. May be NULL.</param>
+    static void Record(TracePhase phase, TraceEventType type, connection_id_t connection_id, const char * method);
+
+    /// <summary>
+    /// Delete the records of all threads. Must not be called while recording.
+    /// </summary>
+    static void Clear();
+
+    /// <summary>
+    /// Get the number of records that are available in the buffers of all threads.
+    /// </summary>
+    /// <returns>Returns the number of records that are available.</returns>
+    static size_t GetRecordCount();
+
+    /// <summary>
+    /// Format the records of all threads in the Chrome trace JSON format.
+    /// For an exact output, this function should be called while recording is disabled.
+    /// </summary>
+    /// <returns>Returns a JSON document.</returns>
+    static std::string ToChromeTrace();
+
+    /// <summary>
+    /// Save the records of all threads to a file in the Chrome trace JSON format.
+    /// </summary>
+    /// <param name="path">The path of the output file.</param>
+    /// <returns>Returns a Status instance which code is set to STATUS_CODE_SUCCESS when the operation is successful.</returns>
+    static Status SaveChromeTrace(const char * path);
+
+  private:
+    static std::atomic<bool> enabled_;
+  };
+
+  /// <summary>
+  /// Records the begin and the end of a call step for the lifetime of the object.
+  /// </summary>
+  class TraceScope
+  {
+  public:
+    inline TraceScope(TracePhase phase, connection_id_t connection_id, const char * method) :
+      active_(TraceRecorder::IsEnabled()),
+      phase_(phase),
+      connection_id_(connection_id),
+      method_(method)
+    {
+      if (active_)
+        TraceRecorder::Record(phase_, TRACE_EVENT_BEGIN, connection_id_, method_);
+    }
+
+    inline ~TraceScope()
+    {
+      if (active_)
+        TraceRecorder::Record(phase_, TRACE_EVENT_END, connection_id_, method_);
+    }
+
+  private:
+    TraceScope(const TraceScope & copy); //disable copy constructor.
+    TraceScope & operator =(const TraceScope & other); //disable assignment operator.
+
+    bool active_;
+    TracePhase phase_;
+    connection_id_t connection_id_;
+    const char * method_;
+  };
+
+}; //namespace pbop
+
+#endif //LIB_PBOP_TRACE_RECORDER
@@ -0,0 +1,103 @@
+/**********************************************************************************
+ * MIT License
+ * 
+ * Copyright (c) 2018 Antoine Beauchamp
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#ifndef LIB_PBOP_WORK_STEALING_EXECUTOR
+#define LIB_PBOP_WORK_STEALING_EXECUTOR
+
+#include "pbop/Status.h"
+
+#include <stddef.h>
+
+namespace pbop
+{
+
+  /// <summary>
+  /// A unit of work executed by an executor.
+  /// </summary>
+  class Task
+  {
+  public:
+    Task() {}
+    virtual ~Task() {}
+
+    /// <summary>
+    /// Execute the task.
+    /// </summary>
+    virtual void Execute() = 0;
+  };
+
+  /// <summary>
+  /// A pool of worker threads which executes tasks concurrently.
+  /// Each worker owns a queue of tasks. A worker that runs out of tasks steals tasks from the other workers' queues.
+  /// Tasks submitted from a worker thread are queued to that worker's own queue.
+  /// </summary>
+  class WorkStealingExecutor
+  {
+  private:
+    struct PImpl;
+    PImpl * impl_;
+
+  public:
+    WorkStealingExecutor();
+    ~WorkStealingExecutor();
+  private:
+    WorkStealingExecutor(const WorkStealingExecutor & copy); //disable copy constructor.
+    WorkStealingExecutor & operator =(const WorkStealingExecutor & other); //disable assignment operator.
+  public:
+
+    /// <summary>
+    /// Start the worker threads.
+    /// </summary>
+    /// <param name="num_workers">The number of worker threads. The value 0 means one worker per processor.</param>
+    /// <returns>Returns a Status instance which code is set to STATUS_CODE_SUCCESS when the operation is successful.</returns>
+    Status Start(size_t num_workers);
+
+    /// <summary>
+    /// Stop the worker threads. Blocks until all submitted tasks are executed.
+    /// </summary>
+    void Stop();
+
+    /// <summary>
+    /// Returns true if the worker threads are started.
+    /// </summary>
+    /// <returns>Returns true if the worker threads are started. Returns false otherwise.</returns>
+    bool IsRunning() const;
+
+    /// <summary>
+    /// Get the number of worker threads.
+    /// </summary>
+    /// <returns>Returns the number of worker threads.</returns>
+    size_t GetWorkerCount() const;
+
+    /// <summary>
+    /// Submit a task for execution. The executor takes ownership of the task and deletes it once executed.
+    /// </summary>
+    /// <param name="task">A valid task instance.</param>
+    /// <returns>Returns true if the task was queued. Returns false if the executor is not running. In that case, the caller keeps ownership of the task.</returns>
+    bool Submit(Task * task);
+  };
+
+}; //namespace pbop
+
+#endif //LIB_PBOP_WORK_STEALING_EXECUTOR
@@ -0,0 +1,62 @@
+/**********************************************************************************
+ * MIT License
+ * 
+ * Copyright (c) 2018 Antoine Beauchamp
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#include "pbop/ArenaBlock.h"
+
+namespace pbop
+{
+
+  const size_t ArenaBlock::BLOCK_SIZE;
+
+  // The block is aligned on 8 bytes like the blocks allocated by an arena.
+  static thread_local unsigned long long g_arena_block[ArenaBlock::BLOCK_SIZE / sizeof(unsigned long long)];
+  static thread_local bool g_arena_block_lent = false;
+
+  ArenaBlock::ArenaBlock() :
+    block_(NULL)
+  {
+    if (!g_arena_block_lent)
+    {
+      g_arena_block_lent = true;
+      block_ = reinterpret_cast<char *>(g_arena_block);
+    }
+  }
+
+  ArenaBlock::~ArenaBlock()
+  {
+    if (block_)
+      g_arena_block_lent = false;
+  }
+
+  char * ArenaBlock::GetBlock() const
+  {
+    return block_;
+  }
+
+  size_t ArenaBlock::GetSize() const
+  {
+    return (block_ ? BLOCK_SIZE : 0);
+  }
+
+}; //namespace pbop
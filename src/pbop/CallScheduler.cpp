@@ -0,0 +1,176 @@
+/**********************************************************************************
+ * MIT License
+ * 
+ * Copyright (c) 2018 Antoine Beauchamp
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#include "CallScheduler.h"
+
+namespace pbop
+{
+
+  CallScheduler::CallScheduler() :
+    capacity_(0),
+    running_(0)
+  {
+  }
+
+  CallScheduler::~CallScheduler()
+  {
+  }
+
+  void CallScheduler::SetCapacity(size_t capacity)
+  {
+    std::vector<ScheduledCall *> calls;
+    {
+      std::lock_guard<std::mutex> scope_lock(lock_);
+      capacity_ = capacity;
+      CollectDispatchableCalls(calls);
+    }
+    for(size_t i=0; i<calls.size(); i++)
+      calls[i]->Dispatch();
+  }
+
+  void CallScheduler::SetOptions(const std::string & key, const Server::MethodOptions & options)
+  {
+    std::vector<ScheduledCall *> calls;
+    {
+      std::lock_guard<std::mutex> scope_lock(lock_);
+      LimitMap::iterator it = limits_.find(key);
+      if (it == limits_.end())
+      {
+        CallLimit limit;
+        limit.options = options;
+        limit.running = 0;
+        limits_[key] = limit;
+      }
+      else
+        it->second.options = options;
+
+      // A higher limit may allow queued calls to run
+      CollectDispatchableCalls(calls);
+    }
+    for(size_t i=0; i<calls.size(); i++)
+      calls[i]->Dispatch();
+  }
+
+  bool CallScheduler::GetOptions(const std::string & key, Server::MethodOptions & options) const
+  {
+    std::lock_guard<std::mutex> scope_lock(lock_);
+    LimitMap::const_iterator it = limits_.find(key);
+    if (it == limits_.end())
+      return false;
+    options = it->second.options;
+    return true;
+  }
+
+  bool CallScheduler::HasOptions() const
+  {
+    std::lock_guard<std::mutex> scope_lock(lock_);
+    return !limits_.empty();
+  }
+
+  bool CallScheduler::HasOptions(const std::string & service_key, const std::string & method_key) const
+  {
+    std::lock_guard<std::mutex> scope_lock(lock_);
+    return (limits_.find(method_key) != limits_.end() || limits_.find(service_key) != limits_.end());
+  }
+
+  void CallScheduler::Schedule(ScheduledCall * call, const std::string & service_key, const std::string & method_key)
+  {
+    std::vector<ScheduledCall *> calls;
+    {
+      std::lock_guard<std::mutex> scope_lock(lock_);
+
+      // Find the options of the call. Method options have precedence over service options.
+      CallLimit * limit = NULL;
+      LimitMap::iterator it = limits_.find(method_key);
+      if (it == limits_.end())
+        it = limits_.find(service_key);
+      if (it != limits_.end())
+        limit = &it->second;
+
+      call->limit_ = limit;
+      call->priority_ = (limit ? limit->options.priority : Server::PRIORITY_NORMAL);
+      if (call->priority_ < Server::PRIORITY_LOW || call->priority_ > Server::PRIORITY_HIGH)
+        call->priority_ = Server::PRIORITY_NORMAL;
+
+      queues_[call->priority_].push_back(call);
+      CollectDispatchableCalls(calls);
+    }
+
+    // Dispatch outside of the lock. Dispatching may execute the call.
+    for(size_t i=0; i<calls.size(); i++)
+      calls[i]->Dispatch();
+  }
+
+  void CallScheduler::Release(ScheduledCall * call)
+  {
+    std::vector<ScheduledCall *> calls;
+    {
+      std::lock_guard<std::mutex> scope_lock(lock_);
+
+      CallLimit * limit = call->limit_;
+      if (limit && limit->running > 0)
+        limit->running--;
+      if (running_ > 0)
+        running_--;
+      call->limit_ = NULL;
+
+      CollectDispatchableCalls(calls);
+    }
+    for(size_t i=0; i<calls.size(); i++)
+      calls[i]->Dispatch();
+  }
+
+  void CallScheduler::CollectDispatchableCalls(std::vector<ScheduledCall *> & calls)
+  {
+    // Dispatch queued calls by priority class while there is capacity left.
+    // Calls whose method has reached its concurrency limit are skipped and stay queued.
+    while(capacity_ == 0 || running_ < capacity_)
+    {
+      ScheduledCall * next = NULL;
+      for(size_t priority=NUM_PRIORITIES; priority>0 && next == NULL; priority--)
+      {
+        std::deque<ScheduledCall *> & queue = queues_[priority-1];
+        for(std::deque<ScheduledCall *>::iterator it = queue.begin(); it != queue.end(); ++it)
+        {
+          CallLimit * limit = (*it)->limit_;
+          if (limit == NULL || limit->options.max_concurrency == 0 || limit->running < limit->options.max_concurrency)
+          {
+            next = *it;
+            queue.erase(it);
+            break;
+          }
+        }
+      }
+      if (next == NULL)
+        break;
+
+      CallLimit * limit = next->limit_;
+      if (limit)
+        limit->running++;
+      running_++;
+      calls.push_back(next);
+    }
+  }
+
+}; //namespace pbop
@@ -0,0 +1,147 @@
+/**********************************************************************************
+ * MIT License
+ * 
+ * Copyright (c) 2018 Antoine Beauchamp
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#ifndef LIB_PBOP_CALL_SCHEDULER
+#define LIB_PBOP_CALL_SCHEDULER
+
+#include "pbop/Server.h"
+
+#include <string>
+#include <map>
+#include <deque>
+#include <vector>
+#include <mutex>
+
+namespace pbop
+{
+
+  /// <summary>
+  /// The options of a method or service and its number of running calls.
+  /// </summary>
+  struct CallLimit
+  {
+    Server::MethodOptions options;
+    size_t running;
+  };
+
+  /// <summary>
+  /// A call that is scheduled by a CallScheduler.
+  /// </summary>
+  class ScheduledCall
+  {
+  public:
+    ScheduledCall() : limit_(NULL), priority_(Server::PRIORITY_NORMAL) {}
+    virtual ~ScheduledCall() {}
+
+    /// <summary>
+    /// Start the execution of the call. Called by the scheduler once the call is allowed to run.
+    /// </summary>
+    virtual void Dispatch() = 0;
+
+  private:
+    friend class CallScheduler;
+    CallLimit * limit_;
+    Server::CallPriority priority_;
+  };
+
+  /// <summary>
+  /// Schedules calls according to the concurrency limit and the priority class of their method.
+  /// Calls that cannot run are queued and dispatched by priority class, then by arrival order.
+  /// </summary>
+  class CallScheduler
+  {
+  public:
+    CallScheduler();
+    ~CallScheduler();
+  private:
+    CallScheduler(const CallScheduler & copy); //disable copy constructor.
+    CallScheduler & operator =(const CallScheduler & other); //disable assignment operator.
+  public:
+
+    /// <summary>
+    /// Set the maximum number of calls that can run at the same time, regardless of their method.
+    /// </summary>
+    /// <param name="capacity">The maximum number of calls. The value 0 means unlimited.</param>
+    void SetCapacity(size_t capacity);
+
+    /// <summary>
+    /// Set the options of a method or a service.
+    /// </summary>
+    /// <param name="key">The key of the method (package.service.function) or the service (package.service).</param>
+    /// <param name="options">The options of the method or service.</param>
+    void SetOptions(const std::string & key, const Server::MethodOptions & options);
+
+    /// <summary>
+    /// Get the options of a method or a service.
+    /// </summary>
+    /// <param name="key">The key of the method (package.service.function) or the service (package.service).</param>
+    /// <param name="options">The output options.</param>
+    /// <returns>Returns true if options are defined for the given key. Returns false otherwise.</returns>
+    bool GetOptions(const std::string & key, Server::MethodOptions & options) const;
+
+    /// <summary>
+    /// Returns true if options are defined for at least one method or service.
+    /// </summary>
+    /// <returns>Returns true if options are defined for at least one method or service. Returns false otherwise.</returns>
+    bool HasOptions() const;
+
+    /// <summary>
+    /// Returns true if options are defined for a method or for its service.
+    /// </summary>
+    /// <param name="service_key">The key of the service (package.service).</param>
+    /// <param name="method_key">The key of the method (package.service.function).</param>
+    /// <returns>Returns true if the calls of the method are scheduled. Returns false otherwise.</returns>
+    bool HasOptions(const std::string & service_key, const std::string & method_key) const;
+
+    /// <summary>
+    /// Schedule a call. The call is dispatched immediately if allowed, otherwise it is queued.
+    /// The options of the method are used first. If the method has no options, the options of its service are used.
+    /// </summary>
+    /// <param name="call">The call to schedule.</param>
+    /// <param name="service_key">The key of the call's service (package.service).</param>
+    /// <param name="method_key">The key of the call's method (package.service.function).</param>
+    void Schedule(ScheduledCall * call, const std::string & service_key, const std::string & method_key);
+
+    /// <summary>
+    /// Release the resources of a completed call and dispatch the queued calls that are allowed to run.
+    /// </summary>
+    /// <param name="call">The call that is completed.</param>
+    void Release(ScheduledCall * call);
+
+  private:
+    typedef std::map<std::string, CallLimit> LimitMap;
+    static const size_t NUM_PRIORITIES = Server::PRIORITY_HIGH + 1;
+
+    void CollectDispatchableCalls(std::vector<ScheduledCall *> & calls);
+
+    mutable std::mutex lock_;
+    LimitMap limits_;
+    std::deque<ScheduledCall *> queues_[NUM_PRIORITIES];
+    size_t capacity_;
+    size_t running_;
+  };
+
+}; //namespace pbop
+
+#endif //LIB_PBOP_CALL_SCHEDULER
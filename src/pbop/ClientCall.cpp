@@ -0,0 +1,66 @@
+/**********************************************************************************
+ * MIT License
+ * 
+ * Copyright (c) 2018 Antoine Beauchamp
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#include "pbop/ClientCall.h"
+#include "pbop/Envelope.h"
+#include "pbop/TraceRecorder.h"
+
+namespace pbop
+{
+
+  Status ClientCall(Connection * connection, const CallDescriptor & descriptor, const ::google::protobuf::MessageLite & request, ::google::protobuf::MessageLite & response)
+  {
+    if (!connection)
+      return Status(STATUS_CODE_INVALID_ARGUMENT, "Connection is NULL.");
+
+    TraceScope trace(TRACE_PHASE_CLIENT_CALL, 0, descriptor.name);
+
+    // Serialize a ClientRequest ready for sending to the connection
+    std::string write_buffer;
+    Status status = EncodeClientRequest(descriptor.identifier, descriptor.identifier_size, request, write_buffer);
+    if (!status.Success())
+      return status;
+
+    // Send
+    {
+      TraceScope trace_write(TRACE_PHASE_CLIENT_WRITE, 0, descriptor.name);
+      status = connection->Write(write_buffer);
+    }
+    if (!status.Success())
+      return status;
+
+    // Wait for a response.
+    std::string read_buffer;
+    {
+      TraceScope trace_read(TRACE_PHASE_CLIENT_READ, 0, descriptor.name);
+      status = connection->Read(read_buffer);
+    }
+    if (!status.Success())
+      return status;
+
+    // Deserialize server's response and the response message
+    return DecodeServerResponse(read_buffer, response);
+  }
+
+}; //namespace pbop
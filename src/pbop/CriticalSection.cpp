@@ -23,6 +23,7 @@
  *********************************************************************************/
 
 #include "pbop/CriticalSection.h"
+#include "LockCounters.h"
 
 #define WIN32_LEAN_AND_MEAN
 #include <Windows.h>
@@ -33,18 +34,28 @@ namespace pbop
   struct CriticalSection::PImpl
   {
     CRITICAL_SECTION cs;
+    std::string name;
+    LockCounters * counters;
+    unsigned long long acquisition_time;
+    int lock_depth;
   };
 
   CriticalSection::CriticalSection() :
     impl_(new CriticalSection::PImpl())
   {
     InitializeCriticalSection(&impl_->cs);
+    impl_->counters = NULL;
+    impl_->acquisition_time = 0;
+    impl_->lock_depth = 0;
   }
 
   CriticalSection::~CriticalSection()
   {
     if (impl_)
+    {
+      delete impl_->counters;
       delete impl_;
+    }
     impl_ = NULL;
   }
 
@@ -52,16 +63,79 @@ namespace pbop
   {
     if (impl_)
     {
-      EnterCriticalSection(&impl_->cs);
+      if (impl_->counters == NULL)
+      {
+        EnterCriticalSection(&impl_->cs);
+        return;
+      }
+
+      // Try to enter the critical section without waiting to detect contention.
+      unsigned long long wait_start = GetMonotonicTime();
+      bool contended = (TryEnterCriticalSection(&impl_->cs) == FALSE);
+      if (contended)
+        EnterCriticalSection(&impl_->cs);
+      unsigned long long acquisition_time = impl_->counters->RecordAcquisition(wait_start, contended);
+
+      // The critical section is recursive. Only the outermost lock measures the hold time.
+      if (impl_->lock_depth++ == 0)
+        impl_->acquisition_time = acquisition_time;
     }
   }
 
+  bool CriticalSection::TryLock()
+  {
+    if (impl_)
+    {
+      unsigned long long wait_start = GetMonotonicTime();
+      if (TryEnterCriticalSection(&impl_->cs) == FALSE)
+        return false;
+      if (impl_->counters)
+      {
+        unsigned long long acquisition_time = impl_->counters->RecordAcquisition(wait_start, false);
+        if (impl_->lock_depth++ == 0)
+          impl_->acquisition_time = acquisition_time;
+      }
+      return true;
+    }
+    return false;
+  }
+
   void CriticalSection::Unlock()
   {
     if (impl_)
     {
+      if (impl_->counters && impl_->lock_depth > 0 && --impl_->lock_depth == 0)
+        impl_->counters->RecordRelease(impl_->acquisition_time);
       LeaveCriticalSection(&impl_->cs);
     }
   }
 
+  void CriticalSection::SetName(const char * name)
+  {
+    if (impl_)
+    {
+      impl_->name = (name ? name : "");
+      delete impl_->counters;
+      impl_->counters = CreateLockCounters(impl_->name.c_str());
+    }
+  }
+
+  const char * CriticalSection::GetName() const
+  {
+    if (impl_)
+      return impl_->name.c_str();
+    return "";
+  }
+
+  void CriticalSection::GetStatistics(LockStatistics & statistics) const
+  {
+    statistics = LockStatistics();
+    if (impl_)
+    {
+      statistics.name = impl_->name;
+      if (impl_->counters)
+        impl_->counters->GetStatistics(statistics);
+    }
+  }
+
 }; //namespace pbop
@@ -0,0 +1,99 @@
+/**********************************************************************************
+ * MIT License
+ * 
+ * Copyright (c) 2018 Antoine Beauchamp
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#ifdef _WIN32
+//google/protobuf/io/coded_stream.h(869): warning C4800: 'google::protobuf::internal::Atomic32' : forcing value to bool 'true' or 'false' (performance warning)
+//google/protobuf/wire_format_lite.h(863): warning C4146: unary minus operator applied to unsigned type, result still unsigned
+//google/protobuf/wire_format_lite.h(874): warning C4146: unary minus operator applied to unsigned type, result still unsigned
+//google/protobuf/generated_message_util.h(160): warning C4800: 'const google::protobuf::uint32' : forcing value to bool 'true' or 'false' (performance warning)
+__pragma( warning(push) )
+__pragma( warning(disable: 4800))
+__pragma( warning(disable: 4146))
+#endif //_WIN32
+
+#include "pbop/Envelope.h"
+
+#include "pbop.pb.h"
+
+#include <google/protobuf/io/coded_stream.h>
+
+#ifdef _WIN32
+__pragma( warning(pop) )
+#endif //_WIN32
+
+#include <string.h>
+
+namespace pbop
+{
+
+  Status EncodeClientRequest(const unsigned char * identifier, size_t identifier_size, const ::google::protobuf::MessageLite & request, std::string & buffer)
+  {
+    static const ::google::protobuf::uint32 REQUEST_BUFFER_TAG = (2 << 3) | 2; // field 2, length-delimited
+
+    // Same as SerializeToString(), proto2 messages with missing required fields are not sent.
+    if (!request.IsInitialized())
+      return Status::Factory::Serialization(__FUNCTION__, request);
+
+    const size_t request_size = request.ByteSizeLong();
+    if (request_size > 0x7FFFFFFF)
+      return Status::Factory::Serialization(__FUNCTION__, request);
+    const ::google::protobuf::uint32 request_size32 = static_cast< ::google::protobuf::uint32>(request_size);
+
+    buffer.resize(identifier_size + 1 + ::google::protobuf::io::CodedOutputStream::VarintSize32(request_size32) + request_size);
+    ::google::protobuf::uint8 * target = reinterpret_cast< ::google::protobuf::uint8 *>(&buffer[0]);
+    memcpy(target, identifier, identifier_size);
+    target += identifier_size;
+    target = ::google::protobuf::io::CodedOutputStream::WriteTagToArray(REQUEST_BUFFER_TAG, target);
+    target = ::google::protobuf::io::CodedOutputStream::WriteVarint32ToArray(request_size32, target);
+    request.SerializeWithCachedSizesToArray(target);
+
+    return Status::OK;
+  }
+
+  Status DecodeServerResponse(const std::string & buffer, ::google::protobuf::MessageLite & response)
+  {
+    // Deserialize server's response
+    ServerResponse server_response;
+    bool success = server_response.ParseFromString(buffer);
+    if (!success)
+      return Status::Factory::Deserialization(__FUNCTION__, server_response);
+
+    // Read server status
+    if (!server_response.has_status())
+      return Status::Factory::MissingField(__FUNCTION__, "status", server_response);
+
+    // Convert StatusMessage to Status
+    const StatusMessage & status_message = server_response.status();
+    if (status_message.code() != STATUS_CODE_SUCCESS)
+      return Status(static_cast<StatusCode>(status_message.code()), status_message.description());
+
+    // Deserialize response message
+    success = response.ParseFromString(server_response.response_buffer());
+    if (!success)
+      return Status::Factory::Deserialization(__FUNCTION__, response);
+
+    return Status::OK;
+  }
+
+}; //namespace pbop
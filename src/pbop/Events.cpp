@@ -47,4 +47,82 @@ namespace pbop
     return status_;
   }
 
+  void EventCallBase::SetFunction(const char * package, const char * service, const char * function, size_t function_index)
+  {
+    package_ = package;
+    service_ = service;
+    function_ = function;
+    function_index_ = function_index;
+  }
+
+  const char * EventCallBase::GetPackageName() const
+  {
+    return package_;
+  }
+
+  const char * EventCallBase::GetServiceName() const
+  {
+    return service_;
+  }
+
+  const char * EventCallBase::GetFunctionName() const
+  {
+    return function_;
+  }
+
+  size_t EventCallBase::GetFunctionIndex() const
+  {
+    return function_index_;
+  }
+
+  void EventCallBase::SetRequestSize(size_t size)
+  {
+    request_size_ = size;
+  }
+
+  size_t EventCallBase::GetRequestSize() const
+  {
+    return request_size_;
+  }
+
+  void EventCallBase::SetBeginTime(unsigned long long timestamp)
+  {
+    begin_time_ = timestamp;
+  }
+
+  unsigned long long EventCallBase::GetBeginTime() const
+  {
+    return begin_time_;
+  }
+
+  void EventCallEnd::SetResponseSize(size_t size)
+  {
+    response_size_ = size;
+  }
+
+  size_t EventCallEnd::GetResponseSize() const
+  {
+    return response_size_;
+  }
+
+  void EventCallEnd::SetEndTime(unsigned long long timestamp)
+  {
+    end_time_ = timestamp;
+  }
+
+  unsigned long long EventCallEnd::GetEndTime() const
+  {
+    return end_time_;
+  }
+
+  void EventCallEnd::SetStatus(const Status & status)
+  {
+    status_ = status;
+  }
+
+  const Status & EventCallEnd::GetStatus() const
+  {
+    return status_;
+  }
+
 }; //namespace pbop
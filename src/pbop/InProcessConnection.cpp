@@ -0,0 +1,130 @@
+/**********************************************************************************
+ * MIT License
+ * 
+ * Copyright (c) 2018 Antoine Beauchamp
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#ifdef _WIN32
+//google/protobuf/io/coded_stream.h(869): warning C4800: 'google::protobuf::internal::Atomic32' : forcing value to bool 'true' or 'false' (performance warning)
+//google/protobuf/wire_format_lite.h(863): warning C4146: unary minus operator applied to unsigned type, result still unsigned
+//google/protobuf/wire_format_lite.h(874): warning C4146: unary minus operator applied to unsigned type, result still unsigned
+//google/protobuf/generated_message_util.h(160): warning C4800: 'const google::protobuf::uint32' : forcing value to bool 'true' or 'false' (performance warning)
+__pragma( warning(push) )
+__pragma( warning(disable: 4800))
+__pragma( warning(disable: 4146))
+#endif //_WIN32
+
+#include "pbop/InProcessConnection.h"
+#include "pbop/Server.h"
+
+#include "pbop.pb.h"
+
+#ifdef _WIN32
+__pragma( warning(pop) )
+#endif //_WIN32
+
+namespace pbop
+{
+  InProcessConnection::InProcessConnection(Server * server) :
+    server_(server),
+    copy_messages_(false),
+    has_response_(false)
+  {
+  }
+
+  InProcessConnection::~InProcessConnection()
+  {
+  }
+
+  Server * InProcessConnection::GetServer() const
+  {
+    return server_;
+  }
+
+  Service * InProcessConnection::FindService(const char * package_name, const char * service_name) const
+  {
+    if (!server_)
+      return NULL;
+    return server_->FindService(package_name, service_name);
+  }
+
+  void InProcessConnection::SetCopyMessages(bool enabled)
+  {
+    copy_messages_ = enabled;
+  }
+
+  bool InProcessConnection::IsCopyMessages() const
+  {
+    return copy_messages_;
+  }
+
+  Status InProcessConnection::Write(const std::string & buffer)
+  {
+    if (!server_)
+      return Status(STATUS_CODE_INVALID_ARGUMENT, "Server is NULL.");
+
+    // Process the call synchronously
+    std::string * function_call_result = new std::string();
+    Status status = server_->RouteMessageToServiceMethod(buffer, *function_call_result);
+    if (!status.Success())
+    {
+      delete function_call_result;
+      function_call_result = NULL;
+    }
+
+    // Build server response for the client.
+    StatusMessage * status_message = new StatusMessage();
+    status_message->set_code(status.GetCode());
+    if (!status.Success())
+      status_message->set_description(status.GetDescription());
+
+    ServerResponse server_response;
+    server_response.set_allocated_status(status_message);
+    if (function_call_result)
+      server_response.set_allocated_response_buffer(function_call_result);
+
+    bool success = server_response.SerializeToString(&response_);
+    if (!success)
+      return Status::Factory::Serialization(__FUNCTION__, server_response);
+    has_response_ = true;
+
+    return Status::OK;
+  }
+
+  Status InProcessConnection::Read(std::string & buffer)
+  {
+    buffer.clear();
+
+    if (!has_response_)
+      return Status(STATUS_CODE_TIMED_OUT, "No response is pending on the connection.");
+
+    buffer.swap(response_);
+    has_response_ = false;
+
+    return Status::OK;
+  }
+
+  Status InProcessConnection::Read(std::string & buffer, unsigned long timeout)
+  {
+    return Read(buffer);
+  }
+
+}; //namespace pbop
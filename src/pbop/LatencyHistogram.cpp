@@ -0,0 +1,200 @@
+/**********************************************************************************
+ * MIT License
+ * 
+ * Copyright (c) 2018 Antoine Beauchamp
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#include "pbop/LatencyHistogram.h"
+
+#include <stdio.h>
+#include <algorithm>
+
+namespace pbop
+{
+
+  const unsigned int LatencyHistogram::SUB_BUCKET_BITS;
+  const unsigned int LatencyHistogram::SUB_BUCKET_COUNT;
+  const unsigned int LatencyHistogram::BUCKET_COUNT;
+
+  LatencyHistogram::LatencyHistogram() :
+    counts_(BUCKET_COUNT, 0),
+    count_(0),
+    min_(0),
+    max_(0),
+    sum_(0.0)
+  {
+  }
+
+  LatencyHistogram::~LatencyHistogram()
+  {
+  }
+
+  unsigned int LatencyHistogram::GetBucketIndex(unsigned long long value)
+  {
+    if (value < SUB_BUCKET_COUNT)
+      return (unsigned int)value;
+
+    // Find the position of the most significant bit
+    unsigned int msb = 0;
+    unsigned long long tmp = value;
+    while(tmp >>= 1)
+      msb++;
+
+    // Keep SUB_BUCKET_BITS+1 significant bits of the value
+    unsigned int shift = msb - SUB_BUCKET_BITS;
+    unsigned int sub_bucket = (unsigned int)(value >> shift); // in range [SUB_BUCKET_COUNT, 2*SUB_BUCKET_COUNT-1]
+    return (shift + 1) * SUB_BUCKET_COUNT + (sub_bucket - SUB_BUCKET_COUNT);
+  }
+
+  unsigned long long LatencyHistogram::GetBucketLowestValue(unsigned int index)
+  {
+    if (index < SUB_BUCKET_COUNT)
+      return index;
+    unsigned int shift = index / SUB_BUCKET_COUNT - 1;
+    unsigned long long sub_bucket = index % SUB_BUCKET_COUNT + SUB_BUCKET_COUNT;
+    return sub_bucket << shift;
+  }
+
+  unsigned long long LatencyHistogram::GetBucketHighestValue(unsigned int index)
+  {
+    if (index < SUB_BUCKET_COUNT)
+      return index;
+    unsigned int shift = index / SUB_BUCKET_COUNT - 1;
+    unsigned long long width = (1ULL << shift);
+    return GetBucketLowestValue(index) + (width - 1);
+  }
+
+  void LatencyHistogram::Record(unsigned long long value)
+  {
+    counts_[GetBucketIndex(value)]++;
+    if (count_ == 0 || value < min_)
+      min_ = value;
+    if (count_ == 0 || value > max_)
+      max_ = value;
+    count_++;
+    sum_ += (double)value;
+  }
+
+  void LatencyHistogram::Merge(const LatencyHistogram & other)
+  {
+    if (other.count_ == 0)
+      return;
+    for(size_t i=0; i<BUCKET_COUNT; i++)
+    {
+      counts_[i] += other.counts_[i];
+    }
+    if (count_ == 0 || other.min_ < min_)
+      min_ = other.min_;
+    if (count_ == 0 || other.max_ > max_)
+      max_ = other.max_;
+    count_ += other.count_;
+    sum_ += other.sum_;
+  }
+
+  void LatencyHistogram::Reset()
+  {
+    counts_.assign(BUCKET_COUNT, 0);
+    count_ = 0;
+    min_ = 0;
+    max_ = 0;
+    sum_ = 0.0;
+  }
+
+  void LatencyHistogram::Swap(LatencyHistogram & other)
+  {
+    counts_.swap(other.counts_);
+    std::swap(count_, other.count_);
+    std::swap(min_, other.min_);
+    std::swap(max_, other.max_);
+    std::swap(sum_, other.sum_);
+  }
+
+  unsigned long long LatencyHistogram::GetCount() const
+  {
+    return count_;
+  }
+
+  unsigned long long LatencyHistogram::GetMin() const
+  {
+    return min_;
+  }
+
+  unsigned long long LatencyHistogram::GetMax() const
+  {
+    return max_;
+  }
+
+  double LatencyHistogram::GetMean() const
+  {
+    if (count_ == 0)
+      return 0.0;
+    return sum_ / (double)count_;
+  }
+
+  unsigned long long LatencyHistogram::GetPercentile(double percentile) const
+  {
+    if (count_ == 0)
+      return 0;
+    if (percentile < 0.0)
+      percentile = 0.0;
+    if (percentile > 100.0)
+      percentile = 100.0;
+
+    // Compute the rank of the requested sample (1-based)
+    unsigned long long rank = (unsigned long long)(percentile / 100.0 * (double)count_ + 0.5);
+    if (rank < 1)
+      rank = 1;
+    if (rank > count_)
+      rank = count_;
+
+    unsigned long long total = 0;
+    for(unsigned int i=0; i<BUCKET_COUNT; i++)
+    {
+      total += counts_[i];
+      if (total >= rank)
+      {
+        unsigned long long value = GetBucketHighestValue(i);
+        if (value > max_)
+          value = max_;
+        if (value < min_)
+          value = min_;
+        return value;
+      }
+    }
+    return max_;
+  }
+
+  std::string LatencyHistogram::ToJson() const
+  {
+    char buffer[512];
+    sprintf(buffer, "{\"count\": %llu, \"min\": %llu, \"mean\": %.1f, \"max\": %llu, \"p50\": %llu, \"p90\": %llu, \"p99\": %llu, \"p999\": %llu}",
+      count_,
+      min_,
+      GetMean(),
+      max_,
+      GetPercentile(50.0),
+      GetPercentile(90.0),
+      GetPercentile(99.0),
+      GetPercentile(99.9));
+    return std::string(buffer);
+  }
+
+}; //namespace pbop
@@ -0,0 +1,85 @@
+/**********************************************************************************
+ * MIT License
+ * 
+ * Copyright (c) 2018 Antoine Beauchamp
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#ifndef LIB_PBOP_LOCK_COUNTERS
+#define LIB_PBOP_LOCK_COUNTERS
+
+#include "pbop/LockProfiler.h"
+#include "pbop/Timing.h"
+
+#include <atomic>
+#include <string>
+
+namespace pbop
+{
+
+  /// <summary>
+  /// Contention counters of a single named lock.
+  /// An instance registers itself to the LockProfiler when created and unregisters itself when destroyed.
+  /// </summary>
+  class LockCounters
+  {
+  public:
+    LockCounters(const char * name);
+    ~LockCounters();
+  private:
+    LockCounters(const LockCounters & copy); //disable copy constructor.
+    LockCounters & operator =(const LockCounters & other); //disable assignment operator.
+  public:
+
+    /// <summary>
+    /// Record a lock acquisition.
+    /// </summary>
+    /// <param name="wait_start">The time when the thread started waiting for the lock.</param>
+    /// <param name="contended">True if the lock was held by another thread when the acquisition started.</param>
+    /// <returns>Returns the time when the lock was acquired.</returns>
+    unsigned long long RecordAcquisition(unsigned long long wait_start, bool contended);
+
+    /// <summary>
+    /// Record the release of the lock.
+    /// </summary>
+    /// <param name="acquisition_time">The time when the lock was acquired.</param>
+    void RecordRelease(unsigned long long acquisition_time);
+
+    void GetStatistics(LockStatistics & statistics) const;
+    void Reset();
+
+  private:
+    std::string name_;
+    std::atomic<unsigned long long> acquisitions_;
+    std::atomic<unsigned long long> contentions_;
+    std::atomic<unsigned long long> wait_time_;
+    std::atomic<unsigned long long> hold_time_;
+  };
+
+  /// <summary>
+  /// Create the counters of a named lock.
+  /// </summary>
+  /// <param name="name">The name of the lock.</param>
+  /// <returns>Returns a new LockCounters instance. Returns NULL if the library is built without lock profiling support.</returns>
+  LockCounters * CreateLockCounters(const char * name);
+
+}; //namespace pbop
+
+#endif //LIB_PBOP_LOCK_COUNTERS
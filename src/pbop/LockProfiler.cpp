@@ -0,0 +1,166 @@
+/**********************************************************************************
+ * MIT License
+ * 
+ * Copyright (c) 2018 Antoine Beauchamp
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#include "pbop/config.h"
+#include "pbop/LockProfiler.h"
+#include "pbop/CriticalSection.h"
+#include "pbop/ScopeLock.h"
+
+#include "LockCounters.h"
+
+#include <stdio.h>
+#include <algorithm>
+
+namespace pbop
+{
+
+  // Registry of all named locks.
+  // The registry is never destroyed to allow static locks to unregister themselves at exit.
+  struct LockRegistry
+  {
+    CriticalSection lock; // Unnamed, the registry lock is not profiled.
+    std::vector<LockCounters *> counters;
+  };
+
+  LockRegistry & GetLockRegistry()
+  {
+    static LockRegistry * registry = new LockRegistry();
+    return *registry;
+  }
+
+  LockCounters::LockCounters(const char * name) :
+    name_(name ? name : ""),
+    acquisitions_(0),
+    contentions_(0),
+    wait_time_(0),
+    hold_time_(0)
+  {
+    LockRegistry & registry = GetLockRegistry();
+    ScopeLock scope_lock(&registry.lock);
+    registry.counters.push_back(this);
+  }
+
+  LockCounters::~LockCounters()
+  {
+    LockRegistry & registry = GetLockRegistry();
+    ScopeLock scope_lock(&registry.lock);
+    std::vector<LockCounters *>::iterator it = std::find(registry.counters.begin(), registry.counters.end(), this);
+    if (it != registry.counters.end())
+      registry.counters.erase(it);
+  }
+
+  unsigned long long LockCounters::RecordAcquisition(unsigned long long wait_start, bool contended)
+  {
+    unsigned long long now = GetMonotonicTime();
+    acquisitions_++;
+    if (contended)
+      contentions_++;
+    wait_time_ += (now - wait_start);
+    return now;
+  }
+
+  void LockCounters::RecordRelease(unsigned long long acquisition_time)
+  {
+    unsigned long long now = GetMonotonicTime();
+    hold_time_ += (now - acquisition_time);
+  }
+
+  void LockCounters::GetStatistics(LockStatistics & statistics) const
+  {
+    statistics.name         = name_;
+    statistics.acquisitions = acquisitions_;
+    statistics.contentions  = contentions_;
+    statistics.wait_time    = wait_time_;
+    statistics.hold_time    = hold_time_;
+  }
+
+  void LockCounters::Reset()
+  {
+    acquisitions_ = 0;
+    contentions_ = 0;
+    wait_time_ = 0;
+    hold_time_ = 0;
+  }
+
+  LockCounters * CreateLockCounters(const char * name)
+  {
+#ifdef PBOP_LOCK_PROFILING
+    return new LockCounters(name);
+#else
+    return NULL;
+#endif
+  }
+
+  bool LockProfiler::IsEnabled()
+  {
+#ifdef PBOP_LOCK_PROFILING
+    return true;
+#else
+    return false;
+#endif
+  }
+
+  void LockProfiler::GetStatistics(std::vector<LockStatistics> & statistics)
+  {
+    statistics.clear();
+
+    LockRegistry & registry = GetLockRegistry();
+    ScopeLock scope_lock(&registry.lock);
+    for(size_t i=0; i<registry.counters.size(); i++)
+    {
+      LockStatistics s;
+      registry.counters[i]->GetStatistics(s);
+      statistics.push_back(s);
+    }
+  }
+
+  void LockProfiler::Reset()
+  {
+    LockRegistry & registry = GetLockRegistry();
+    ScopeLock scope_lock(&registry.lock);
+    for(size_t i=0; i<registry.counters.size(); i++)
+    {
+      registry.counters[i]->Reset();
+    }
+  }
+
+  std::string LockProfiler::ToString()
+  {
+    std::vector<LockStatistics> statistics;
+    GetStatistics(statistics);
+
+    std::string output;
+    char line[1024];
+    sprintf(line, "%-40s %14s %14s %16s %16s\n", "name", "acquisitions", "contentions", "wait (us)", "hold (us)");
+    output += line;
+    for(size_t i=0; i<statistics.size(); i++)
+    {
+      const LockStatistics & s = statistics[i];
+      sprintf(line, "%-40.40s %14llu %14llu %16llu %16llu\n", s.name.c_str(), s.acquisitions, s.contentions, s.wait_time / 1000, s.hold_time / 1000);
+      output += line;
+    }
+    return output;
+  }
+
+}; //namespace pbop
@@ -0,0 +1,156 @@
+/**********************************************************************************
+ * MIT License
+ * 
+ * Copyright (c) 2018 Antoine Beauchamp
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#include "pbop/LoopbackConnection.h"
+
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+namespace pbop
+{
+  // A bounded ring of messages in one direction.
+  class LoopbackConnection::Channel
+  {
+  public:
+    Channel(size_t capacity) :
+      slots_(capacity > 0 ? capacity : 1),
+      head_(0),
+      count_(0),
+      closed_(false)
+    {
+    }
+
+    std::mutex lock_;
+    std::condition_variable not_empty_;
+    std::condition_variable not_full_;
+    std::vector<std::string> slots_;  // the slots keep their capacity to prevent allocations
+    size_t head_;                     // index of the next message to read
+    size_t count_;                    // number of pending messages
+    bool closed_;
+
+    void Close()
+    {
+      std::lock_guard<std::mutex> scope_lock(lock_);
+      closed_ = true;
+      not_empty_.notify_all();
+      not_full_.notify_all();
+    }
+
+    // Remove the next message. The lock must be acquired and a message must be pending.
+    void Pop(std::string & buffer)
+    {
+      buffer.swap(slots_[head_]);
+      slots_[head_].clear();
+      head_ = (head_ + 1) % slots_.size();
+      count_--;
+      not_full_.notify_one();
+    }
+  };
+
+  const size_t LoopbackConnection::DEFAULT_CAPACITY = 1024;
+
+  void LoopbackConnection::CreatePair(LoopbackConnection ** first, LoopbackConnection ** second, size_t capacity)
+  {
+    std::shared_ptr<Channel> forward(new Channel(capacity));
+    std::shared_ptr<Channel> backward(new Channel(capacity));
+    if (first)
+      *first = new LoopbackConnection(backward, forward);
+    if (second)
+      *second = new LoopbackConnection(forward, backward);
+  }
+
+  LoopbackConnection::LoopbackConnection(const std::shared_ptr<Channel> & input, const std::shared_ptr<Channel> & output) :
+    input_(input),
+    output_(output)
+  {
+  }
+
+  LoopbackConnection::~LoopbackConnection()
+  {
+    Close();
+  }
+
+  void LoopbackConnection::Close()
+  {
+    input_->Close();
+    output_->Close();
+  }
+
+  Status LoopbackConnection::Write(const std::string & buffer)
+  {
+    Channel & channel = *output_;
+    std::unique_lock<std::mutex> scope_lock(channel.lock_);
+    while(!channel.closed_ && channel.count_ == channel.slots_.size())
+      channel.not_full_.wait(scope_lock);
+    if (channel.closed_)
+      return Status(STATUS_CODE_PIPE_ERROR, "The connection is closed.");
+
+    const size_t tail = (channel.head_ + channel.count_) % channel.slots_.size();
+    channel.slots_[tail].assign(buffer);
+    channel.count_++;
+    channel.not_empty_.notify_one();
+
+    return Status::OK;
+  }
+
+  Status LoopbackConnection::Read(std::string & buffer)
+  {
+    buffer.clear();
+
+    Channel & channel = *input_;
+    std::unique_lock<std::mutex> scope_lock(channel.lock_);
+    while(!channel.closed_ && channel.count_ == 0)
+      channel.not_empty_.wait(scope_lock);
+    if (channel.count_ == 0)
+      return Status(STATUS_CODE_PIPE_ERROR, "The connection is closed.");
+
+    channel.Pop(buffer);
+
+    return Status::OK;
+  }
+
+  Status LoopbackConnection::Read(std::string & buffer, unsigned long timeout)
+  {
+    buffer.clear();
+
+    const std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout);
+
+    Channel & channel = *input_;
+    std::unique_lock<std::mutex> scope_lock(channel.lock_);
+    while(!channel.closed_ && channel.count_ == 0)
+    {
+      if (channel.not_empty_.wait_until(scope_lock, deadline) == std::cv_status::timeout && channel.count_ == 0 && !channel.closed_)
+        return Status(STATUS_CODE_TIMED_OUT, "No message received in the allowed time.");
+    }
+    if (channel.count_ == 0)
+      return Status(STATUS_CODE_PIPE_ERROR, "The connection is closed.");
+
+    channel.Pop(buffer);
+
+    return Status::OK;
+  }
+
+}; //namespace pbop
@@ -0,0 +1,252 @@
+/**********************************************************************************
+ * MIT License
+ * 
+ * Copyright (c) 2018 Antoine Beauchamp
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#include "MethodCounters.h"
+#include "pbop/ScopeLock.h"
+
+namespace pbop
+{
+
+  const char * GetCallPhaseName(CallPhase phase)
+  {
+    switch(phase)
+    {
+    case CALL_PHASE_DECODE:
+      return "decode";
+    case CALL_PHASE_QUEUE:
+      return "queue";
+    case CALL_PHASE_EXECUTE:
+      return "execute";
+    case CALL_PHASE_ENCODE:
+      return "encode";
+    case CALL_PHASE_WRITE:
+      return "write";
+    case CALL_PHASE_TOTAL:
+      return "total";
+    default:
+      return "";
+    };
+  }
+
+  void InitCallRecord(CallRecord & record)
+  {
+    record.counters = NULL;
+    record.read_time = 0;
+    record.decode_time = 0;
+    record.start_time = 0;
+    record.execute_time = 0;
+    record.encode_time = 0;
+    record.bytes_in = 0;
+    record.bytes_out = 0;
+    record.error = false;
+  }
+
+  inline unsigned long long GetElapsedTime(unsigned long long start, unsigned long long end)
+  {
+    return (end > start ? end - start : 0);
+  }
+
+  MethodCounters::MethodCounters(const std::string & package, const std::string & service, const std::string & function) :
+    package_(package),
+    service_(service),
+    function_(function)
+  {
+    statistics_.package = package;
+    statistics_.service = service;
+    statistics_.function = function;
+    statistics_.calls = 0;
+    statistics_.errors = 0;
+    statistics_.bytes_in = 0;
+    statistics_.bytes_out = 0;
+  }
+
+  MethodCounters::~MethodCounters()
+  {
+  }
+
+  void MethodCounters::Record(const CallRecord & record, unsigned long long write_time)
+  {
+    std::lock_guard<std::mutex> scope_lock(lock_);
+
+    statistics_.calls++;
+    if (record.error)
+      statistics_.errors++;
+    statistics_.bytes_in += record.bytes_in;
+    statistics_.bytes_out += record.bytes_out;
+
+    // Phases that were not reached (ie: the response could not be encoded) are not recorded.
+    statistics_.latency[CALL_PHASE_DECODE].Record(GetElapsedTime(record.read_time, record.decode_time));
+    if (record.start_time)
+      statistics_.latency[CALL_PHASE_QUEUE].Record(GetElapsedTime(record.decode_time, record.start_time));
+    if (record.execute_time)
+      statistics_.latency[CALL_PHASE_EXECUTE].Record(GetElapsedTime(record.start_time, record.execute_time));
+    if (record.encode_time)
+      statistics_.latency[CALL_PHASE_ENCODE].Record(GetElapsedTime(record.execute_time, record.encode_time));
+    if (record.encode_time && write_time)
+      statistics_.latency[CALL_PHASE_WRITE].Record(GetElapsedTime(record.encode_time, write_time));
+    if (write_time)
+      statistics_.latency[CALL_PHASE_TOTAL].Record(GetElapsedTime(record.read_time, write_time));
+  }
+
+  void MethodCounters::GetStatistics(MethodStatistics & statistics, bool reset)
+  {
+    statistics.package = package_;
+    statistics.service = service_;
+    statistics.function = function_;
+
+    std::lock_guard<std::mutex> scope_lock(lock_);
+
+    statistics.calls = statistics_.calls;
+    statistics.errors = statistics_.errors;
+    statistics.bytes_in = statistics_.bytes_in;
+    statistics.bytes_out = statistics_.bytes_out;
+    for(size_t i=0; i<CALL_PHASE_COUNT; i++)
+    {
+      if (reset)
+        statistics_.latency[i].Swap(statistics.latency[i]);
+      else
+        statistics.latency[i] = statistics_.latency[i];
+    }
+
+    if (reset)
+    {
+      statistics_.calls = 0;
+      statistics_.errors = 0;
+      statistics_.bytes_in = 0;
+      statistics_.bytes_out = 0;
+    }
+  }
+
+  void MethodCounters::Reset()
+  {
+    std::lock_guard<std::mutex> scope_lock(lock_);
+
+    statistics_.calls = 0;
+    statistics_.errors = 0;
+    statistics_.bytes_in = 0;
+    statistics_.bytes_out = 0;
+    for(size_t i=0; i<CALL_PHASE_COUNT; i++)
+    {
+      statistics_.latency[i].Reset();
+    }
+  }
+
+  // Compare the names of a method with the given names.
+  inline int CompareMethod(const MethodCounters * counters, const std::string & package, const std::string & service, const std::string & function)
+  {
+    int result = counters->GetPackage().compare(package);
+    if (result == 0)
+      result = counters->GetService().compare(service);
+    if (result == 0)
+      result = counters->GetFunction().compare(function);
+    return result;
+  }
+
+  StatisticsRegistry::StatisticsRegistry()
+  {
+    lock_.SetName("pbop::StatisticsRegistry::lock_");
+  }
+
+  StatisticsRegistry::~StatisticsRegistry()
+  {
+    ScopeLock scope_lock(&lock_, ScopeLock::WRITING);
+
+    for(size_t i=0; i<counters_.size(); i++)
+    {
+      delete counters_[i];
+    }
+    counters_.clear();
+  }
+
+  size_t StatisticsRegistry::LowerBound(const std::string & package, const std::string & service, const std::string & function) const
+  {
+    // Binary search of the first counters that are not lower than the given names.
+    size_t first = 0;
+    size_t count = counters_.size();
+    while(count > 0)
+    {
+      size_t step = count / 2;
+      size_t middle = first + step;
+      if (CompareMethod(counters_[middle], package, service, function) < 0)
+      {
+        first = middle + 1;
+        count -= step + 1;
+      }
+      else
+        count = step;
+    }
+    return first;
+  }
+
+  void StatisticsRegistry::AddMethod(const std::string & package, const std::string & service, const std::string & function)
+  {
+    ScopeLock scope_lock(&lock_, ScopeLock::WRITING);
+
+    size_t index = LowerBound(package, service, function);
+    if (index < counters_.size() && CompareMethod(counters_[index], package, service, function) == 0)
+      return;
+    counters_.insert(counters_.begin() + index, new MethodCounters(package, service, function));
+  }
+
+  MethodCounters * StatisticsRegistry::FindMethod(const std::string & package, const std::string & service, const std::string & function)
+  {
+    ScopeLock scope_lock(&lock_, ScopeLock::READING);
+
+    size_t index = LowerBound(package, service, function);
+    if (index < counters_.size() && CompareMethod(counters_[index], package, service, function) == 0)
+      return counters_[index];
+    return NULL;
+  }
+
+  void StatisticsRegistry::GetStatistics(std::vector<MethodStatistics> & statistics, bool reset)
+  {
+    ScopeLock scope_lock(&lock_, ScopeLock::READING);
+
+    // Reuse the histograms of the output list. Histograms that are swapped must be empty.
+    if (statistics.size() != counters_.size())
+      statistics.resize(counters_.size());
+    for(size_t i=0; i<counters_.size(); i++)
+    {
+      if (reset)
+      {
+        for(size_t j=0; j<CALL_PHASE_COUNT; j++)
+        {
+          statistics[i].latency[j].Reset();
+        }
+      }
+      counters_[i]->GetStatistics(statistics[i], reset);
+    }
+  }
+
+  void StatisticsRegistry::Reset()
+  {
+    ScopeLock scope_lock(&lock_, ScopeLock::READING);
+
+    for(size_t i=0; i<counters_.size(); i++)
+    {
+      counters_[i]->Reset();
+    }
+  }
+
+}; //namespace pbop
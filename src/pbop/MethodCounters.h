@@ -0,0 +1,163 @@
+/**********************************************************************************
+ * MIT License
+ * 
+ * Copyright (c) 2018 Antoine Beauchamp
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#ifndef LIB_PBOP_METHOD_COUNTERS
+#define LIB_PBOP_METHOD_COUNTERS
+
+#include "pbop/MethodStatistics.h"
+#include "pbop/ReadWriteLock.h"
+
+#include <string>
+#include <vector>
+#include <mutex>
+
+namespace pbop
+{
+
+  class MethodCounters;
+
+  /// <summary>
+  /// Timestamps and sizes of a single call. Timestamps are from GetMonotonicTime().
+  /// </summary>
+  struct CallRecord
+  {
+    MethodCounters * counters;      // Counters of the called method. NULL if statistics are not recorded for this call.
+    unsigned long long read_time;   // The request was received.
+    unsigned long long decode_time; // The request was parsed.
+    unsigned long long start_time;  // The execution of the method has started.
+    unsigned long long execute_time;// The execution of the method has completed.
+    unsigned long long encode_time; // The response was serialized.
+    size_t bytes_in;
+    size_t bytes_out;
+    bool error;
+  };
+
+  /// <summary>
+  /// Initialize a CallRecord for a call which is not recorded.
+  /// </summary>
+  /// <param name="record">The record to initialize.</param>
+  void InitCallRecord(CallRecord & record);
+
+  /// <summary>
+  /// Accumulates the statistics of the calls to a single method.
+  /// </summary>
+  class MethodCounters
+  {
+  public:
+    MethodCounters(const std::string & package, const std::string & service, const std::string & function);
+    ~MethodCounters();
+  private:
+    MethodCounters(const MethodCounters & copy); //disable copy constructor.
+    MethodCounters & operator =(const MethodCounters & other); //disable assignment operator.
+  public:
+
+    /// <summary>
+    /// Add a completed call to the statistics.
+    /// </summary>
+    /// <param name="record">The record of the call.</param>
+    /// <param name="write_time">The time at which the response was written.</param>
+    void Record(const CallRecord & record, unsigned long long write_time);
+
+    /// <summary>
+    /// Get a copy of the statistics.
+    /// When reset is requested, the histograms are swapped with the histograms of the output
+    /// statistics instead of being copied. The output histograms must be empty.
+    /// </summary>
+    /// <param name="statistics">The output statistics.</param>
+    /// <param name="reset">Set to true to reset the statistics to zero in the same operation.</param>
+    void GetStatistics(MethodStatistics & statistics, bool reset);
+
+    /// <summary>
+    /// Reset the statistics to zero.
+    /// </summary>
+    void Reset();
+
+    const std::string & GetPackage() const { return package_; }
+    const std::string & GetService() const { return service_; }
+    const std::string & GetFunction() const { return function_; }
+
+  private:
+    // The names of the method never change and are read without locking.
+    const std::string package_;
+    const std::string service_;
+    const std::string function_;
+    std::mutex lock_;
+    MethodStatistics statistics_;
+  };
+
+  /// <summary>
+  /// The counters of all the methods of a server.
+  /// </summary>
+  class StatisticsRegistry
+  {
+  public:
+    StatisticsRegistry();
+    ~StatisticsRegistry();
+  private:
+    StatisticsRegistry(const StatisticsRegistry & copy); //disable copy constructor.
+    StatisticsRegistry & operator =(const StatisticsRegistry & other); //disable assignment operator.
+  public:
+
+    /// <summary>
+    /// Create the counters of a method. Does nothing if the counters already exist.
+    /// </summary>
+    /// <param name="package">The package name of the service.</param>
+    /// <param name="service">The name of the service.</param>
+    /// <param name="function">The name of the method.</param>
+    void AddMethod(const std::string & package, const std::string & service, const std::string & function);
+
+    /// <summary>
+    /// Find the counters of a method. The function does not allocate memory.
+    /// </summary>
+    /// <param name="package">The package name of the service.</param>
+    /// <param name="service">The name of the service.</param>
+    /// <param name="function">The name of the method.</param>
+    /// <returns>Returns the counters of the method. Returns NULL if the method is unknown.</returns>
+    MethodCounters * FindMethod(const std::string & package, const std::string & service, const std::string & function);
+
+    /// <summary>
+    /// Get a copy of the statistics of all methods.
+    /// The elements of the output list are reused when the list already has one element per method.
+    /// </summary>
+    /// <param name="statistics">The output list of statistics. One element per method.</param>
+    /// <param name="reset">Set to true to reset the statistics of each method to zero in the same operation.</param>
+    void GetStatistics(std::vector<MethodStatistics> & statistics, bool reset);
+
+    /// <summary>
+    /// Reset the statistics of all methods to zero.
+    /// </summary>
+    void Reset();
+
+  private:
+    size_t LowerBound(const std::string & package, const std::string & service, const std::string & function) const;
+
+  private:
+    typedef std::vector<MethodCounters *> CountersList;
+    ReadWriteLock lock_;
+    CountersList counters_; // Sorted by package, service and function names
+  };
+
+}; //namespace pbop
+
+#endif //LIB_PBOP_METHOD_COUNTERS
@@ -23,6 +23,7 @@
  *********************************************************************************/
 
 #include "pbop/Mutex.h"
+#include "LockCounters.h"
 
 #define WIN32_LEAN_AND_MEAN
 #include <Windows.h>
@@ -33,12 +34,19 @@ namespace pbop
   struct Mutex::PImpl
   {
     HANDLE mutex;
+    std::string name;
+    LockCounters * counters;
+    unsigned long long acquisition_time;
+    int lock_depth;
   };
 
   Mutex::Mutex() :
     impl_(new Mutex::PImpl())
   {
     impl_->mutex = CreateMutex(NULL, FALSE, NULL);
+    impl_->counters = NULL;
+    impl_->acquisition_time = 0;
+    impl_->lock_depth = 0;
   }
 
   Mutex::~Mutex()
@@ -46,6 +54,7 @@ namespace pbop
     if (impl_)
     {
       CloseHandle(impl_->mutex);
+      delete impl_->counters;
       delete impl_;
     }
     impl_ = NULL;
@@ -55,7 +64,22 @@ namespace pbop
   {
     if (impl_)
     {
-      WaitForSingleObject(impl_->mutex, INFINITE);
+      if (impl_->counters == NULL)
+      {
+        WaitForSingleObject(impl_->mutex, INFINITE);
+        return;
+      }
+
+      // Try to acquire the mutex without waiting to detect contention.
+      unsigned long long wait_start = GetMonotonicTime();
+      bool contended = (WaitForSingleObject(impl_->mutex, 0) == WAIT_TIMEOUT);
+      if (contended)
+        WaitForSingleObject(impl_->mutex, INFINITE);
+      unsigned long long acquisition_time = impl_->counters->RecordAcquisition(wait_start, contended);
+
+      // The mutex is recursive. Only the outermost lock measures the hold time.
+      if (impl_->lock_depth++ == 0)
+        impl_->acquisition_time = acquisition_time;
     }
   }
 
@@ -63,8 +87,38 @@ namespace pbop
   {
     if (impl_)
     {
+      if (impl_->counters && impl_->lock_depth > 0 && --impl_->lock_depth == 0)
+        impl_->counters->RecordRelease(impl_->acquisition_time);
       ReleaseMutex(impl_->mutex);
     }
   }
 
+  void Mutex::SetName(const char * name)
+  {
+    if (impl_)
+    {
+      impl_->name = (name ? name : "");
+      delete impl_->counters;
+      impl_->counters = CreateLockCounters(impl_->name.c_str());
+    }
+  }
+
+  const char * Mutex::GetName() const
+  {
+    if (impl_)
+      return impl_->name.c_str();
+    return "";
+  }
+
+  void Mutex::GetStatistics(LockStatistics & statistics) const
+  {
+    statistics = LockStatistics();
+    if (impl_)
+    {
+      statistics.name = impl_->name;
+      if (impl_->counters)
+        impl_->counters->GetStatistics(statistics);
+    }
+  }
+
 }; //namespace pbop
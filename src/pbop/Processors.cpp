@@ -0,0 +1,190 @@
+/**********************************************************************************
+ * MIT License
+ * 
+ * Copyright (c) 2018 Antoine Beauchamp
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#include "pbop/Processors.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sched.h>
+#endif
+
+namespace pbop
+{
+
+#if !defined(_WIN32) && defined(__linux__)
+  // Parse a cpu list such as `0-3,8-11` as published in /sys/devices/system/node/node*/cpulist.
+  bool ReadCpuList(const char * path, std::vector<unsigned int> & processors)
+  {
+    FILE * f = fopen(path, "r");
+    if (f == NULL)
+      return false;
+
+    char buffer[4096] = {0};
+    bool success = (fgets(buffer, sizeof(buffer), f) != NULL);
+    fclose(f);
+    if (!success)
+      return false;
+
+    const char * cursor = buffer;
+    while(*cursor >= '0' && *cursor <= '9')
+    {
+      char * end = NULL;
+      unsigned long first = strtoul(cursor, &end, 10);
+      unsigned long last = first;
+      cursor = end;
+      if (*cursor == '-')
+      {
+        last = strtoul(cursor + 1, &end, 10);
+        cursor = end;
+      }
+      for(unsigned long i=first; i<=last; i++)
+        processors.push_back((unsigned int)i);
+      if (*cursor == ',')
+        cursor++;
+    }
+    return true;
+  }
+#endif
+
+  unsigned int GetProcessorCount()
+  {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    unsigned int count = (unsigned int)info.dwNumberOfProcessors;
+#else
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    if (count < 1)
+      return 1;
+    return (unsigned int)count;
+  }
+
+  bool GetProcessProcessors(std::vector<unsigned int> & processors)
+  {
+    processors.clear();
+#ifdef _WIN32
+    // The mask is 0 when the threads of the process are in multiple processor groups.
+    DWORD_PTR process_mask = 0;
+    DWORD_PTR system_mask = 0;
+    if (!GetProcessAffinityMask(GetCurrentProcess(), &process_mask, &system_mask))
+      return false;
+    for(unsigned int i=0; i<sizeof(process_mask)*8; i++)
+    {
+      if (process_mask & ((DWORD_PTR)1 << i))
+        processors.push_back(i);
+    }
+#elif defined(__linux__)
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    if (sched_getaffinity(0, sizeof(cpu_set), &cpu_set) != 0)
+      return false;
+    for(unsigned int i=0; i<CPU_SETSIZE; i++)
+    {
+      if (CPU_ISSET(i, &cpu_set))
+        processors.push_back(i);
+    }
+#else
+    unsigned int count = GetProcessorCount();
+    for(unsigned int i=0; i<count; i++)
+      processors.push_back(i);
+#endif
+    return !processors.empty();
+  }
+
+  unsigned int GetNumaNodeCount()
+  {
+#ifdef _WIN32
+    ULONG highest_node = 0;
+    if (!GetNumaHighestNodeNumber(&highest_node))
+      return 1;
+    return (unsigned int)highest_node + 1;
+#elif defined(__linux__)
+    unsigned int count = 0;
+    char path[256];
+    for(;;)
+    {
+      sprintf(path, "/sys/devices/system/node/node%u", count);
+      if (access(path, F_OK) != 0)
+        break;
+      count++;
+    }
+    if (count == 0)
+      return 1;
+    return count;
+#else
+    return 1;
+#endif
+  }
+
+  bool GetNumaNodeProcessors(unsigned int node, std::vector<unsigned int> & processors)
+  {
+    processors.clear();
+#ifdef _WIN32
+    ULONGLONG mask = 0;
+    if (node > 0xFF || !GetNumaNodeProcessorMask((UCHAR)node, &mask))
+      return false;
+    for(unsigned int i=0; i<sizeof(mask)*8; i++)
+    {
+      if (mask & ((ULONGLONG)1 << i))
+        processors.push_back(i);
+    }
+    return !processors.empty();
+#else
+#ifdef __linux__
+    char path[256];
+    sprintf(path, "/sys/devices/system/node/node%u/cpulist", node);
+    if (ReadCpuList(path, processors))
+      return !processors.empty();
+#endif
+    // Without NUMA support, all processors belongs to node 0.
+    if (node != 0)
+      return false;
+    unsigned int count = GetProcessorCount();
+    for(unsigned int i=0; i<count; i++)
+      processors.push_back(i);
+    return true;
+#endif
+  }
+
+  unsigned int GetCurrentProcessor()
+  {
+#ifdef _WIN32
+    return (unsigned int)GetCurrentProcessorNumber();
+#elif defined(__linux__)
+    int processor = sched_getcpu();
+    if (processor < 0)
+      return 0;
+    return (unsigned int)processor;
+#else
+    return 0;
+#endif
+  }
+
+}; //namespace pbop
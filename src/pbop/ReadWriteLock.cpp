@@ -24,6 +24,7 @@
 
 #include "pbop/ReadWriteLock.h"
 #include "pbop/CriticalSection.h"
+#include "LockCounters.h"
 
 #define WIN32_LEAN_AND_MEAN
 #include <Windows.h>
@@ -40,6 +41,10 @@ namespace pbop
     HANDLE no_readers_event;
     int num_readers;
     bool waiting_writer;
+    std::string name;
+    LockCounters * counters;
+    unsigned long long read_acquisition_time;  // Time when num_readers changed from 0 to 1. Protected by counters_lock.
+    unsigned long long write_acquisition_time;
   };
 
   ReadWriteLock::ReadWriteLock() :
@@ -50,6 +55,9 @@ namespace pbop
     impl_->no_readers_event = CreateEvent(NULL, FALSE, FALSE, NULL);
     impl_->num_readers = 0;
     impl_->waiting_writer = false;
+    impl_->counters = NULL;
+    impl_->read_acquisition_time = 0;
+    impl_->write_acquisition_time = 0;
   }
 
   ReadWriteLock::~ReadWriteLock()
@@ -60,6 +68,7 @@ namespace pbop
         CloseHandle(impl_->no_readers_event);
       impl_->no_readers_event = NULL;
 
+      delete impl_->counters;
       delete impl_;
     }
     impl_ = NULL;
@@ -72,9 +81,26 @@ namespace pbop
       // We need to lock the writer_lock too, otherwise a writer could
       // do the whole of LockWrite() after the num_readers changed
       // from 0 to 1, but before the event was reset.
-      impl_->writer_lock.Lock();
+      unsigned long long wait_start = 0;
+      bool contended = false;
+      if (impl_->counters)
+      {
+        wait_start = GetMonotonicTime();
+        contended = !impl_->writer_lock.TryLock();
+        if (contended)
+          impl_->writer_lock.Lock();
+      }
+      else
+        impl_->writer_lock.Lock();
       impl_->counters_lock.Lock();
       impl_->num_readers++;
+      if (impl_->counters)
+      {
+        // For readers, the hold time is the time where at least one reader owns the lock.
+        unsigned long long acquisition_time = impl_->counters->RecordAcquisition(wait_start, contended);
+        if (impl_->num_readers == 1)
+          impl_->read_acquisition_time = acquisition_time;
+      }
       impl_->counters_lock.Unlock();
       impl_->writer_lock.Unlock();
     }
@@ -88,6 +114,9 @@ namespace pbop
       assert (impl_->num_readers > 0);
       if (--impl_->num_readers == 0)
       {
+          if (impl_->counters)
+            impl_->counters->RecordRelease(impl_->read_acquisition_time);
+
           if (impl_->waiting_writer)
           {
               // Clear waiting_writer here to avoid taking counters_lock
@@ -104,7 +133,20 @@ namespace pbop
   {
     if (impl_)
     {
-      impl_->writer_lock.Lock();
+      unsigned long long wait_start = 0;
+      bool contended = false;
+      if (impl_->counters)
+      {
+        wait_start = GetMonotonicTime();
+        contended = !impl_->writer_lock.TryLock();
+        if (contended)
+          impl_->writer_lock.Lock();
+        else
+          contended = (impl_->num_readers > 0);
+      }
+      else
+        impl_->writer_lock.Lock();
+
       // num_readers cannot become non-zero within the writer_lock CS,
       // but it can become zero...
       if (impl_->num_readers > 0) {
@@ -121,6 +163,9 @@ namespace pbop
           }
       }
 
+      if (impl_->counters)
+        impl_->write_acquisition_time = impl_->counters->RecordAcquisition(wait_start, contended);
+
       // writer_lock remains locked.
     }
   }
@@ -129,8 +174,38 @@ namespace pbop
   {
     if (impl_)
     {
+      if (impl_->counters)
+        impl_->counters->RecordRelease(impl_->write_acquisition_time);
       impl_->writer_lock.Unlock();
     }
   }
 
+  void ReadWriteLock::SetName(const char * name)
+  {
+    if (impl_)
+    {
+      impl_->name = (name ? name : "");
+      delete impl_->counters;
+      impl_->counters = CreateLockCounters(impl_->name.c_str());
+    }
+  }
+
+  const char * ReadWriteLock::GetName() const
+  {
+    if (impl_)
+      return impl_->name.c_str();
+    return "";
+  }
+
+  void ReadWriteLock::GetStatistics(LockStatistics & statistics) const
+  {
+    statistics = LockStatistics();
+    if (impl_)
+    {
+      statistics.name = impl_->name;
+      if (impl_->counters)
+        impl_->counters->GetStatistics(statistics);
+    }
+  }
+
 }; //namespace pbop
@@ -36,6 +36,9 @@ __pragma( warning(disable: 4146))
 #include "pbop/Status.h"
 #include "pbop/PipeConnection.h"
 #include "pbop/ScopeLock.h"
+#include "pbop/LockProfiler.h"
+#include "pbop/Processors.h"
+#include "pbop/TraceRecorder.h"
 
 #include "pbop.pb.h"
 
@@ -46,6 +49,15 @@ __pragma( warning(pop) )
 #include <Windows.h>
 
 #include "pbop/ThreadBuilder.h"
+#include "pbop/WorkStealingExecutor.h"
+#include "CallScheduler.h"
+#include "MethodCounters.h"
+#include "pbop/Timing.h"
+
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+#include <string.h>
 
 //https://docs.microsoft.com/en-us/windows/win32/ipc/multithreaded-pipe-server
 
@@ -55,18 +67,32 @@ namespace pbop
   {
   public:
     Server * server_;
-    PipeConnection * connection_; //owned by the session
+    Connection * connection_; //owned by the session
     connection_id_t connection_id_;
     Thread * thread_; //owned by the session
+    int placement_slot_; //-1 when the session is not pinned
+    std::string read_buffer_;
+    std::string write_buffer_; //used by the session's current call
+
+    // State of the session's calls. Protected by calls_lock_.
+    // Clients wait for the response of a call before sending the next request
+    // so a session never has more than one call in flight.
+    std::mutex calls_lock_;
+    std::condition_variable calls_done_;
+    size_t pending_calls_;                      // Number of calls that are not completed
+    bool calls_error_;                          // True if a response could not be sent
 
   public:
     ClientSession(Server * server,
-                  PipeConnection * connection,
+                  Connection * connection,
                   connection_id_t connection_id)
     {
       server_ = server;
       connection_ = connection; //the ClientSession takes ownership
       connection_id_ = connection_id;
+      placement_slot_ = -1;
+      pending_calls_ = 0;
+      calls_error_ = false;
       thread_ = new ThreadBuilder<ClientSession>(this, &ClientSession::Run);
     }
 
@@ -101,6 +127,66 @@ namespace pbop
     ClientSession & operator =(const ClientSession & other); //disable assignment operator.
   };
 
+  class Server::CallTask : public Task, public ScheduledCall
+  {
+  public:
+    Server * server_;
+    ClientSession * session_;
+    ClientRequest request_;
+    Status status_; //status of the decoding of the request
+    bool scheduled_;  //true if the call was scheduled by the server's CallScheduler
+    bool dispatched_; //true once the scheduler allows the call to run. Protected by the session's calls_lock_.
+    CallRecord record_; //statistics of the call
+
+  public:
+    CallTask(Server * server, ClientSession * session) :
+      server_(server),
+      session_(session),
+      scheduled_(false),
+      dispatched_(false)
+    {
+      InitCallRecord(record_);
+    }
+
+    // Execute the call and send the response to the client.
+    void Run()
+    {
+      std::string & write_buffer = session_->write_buffer_;
+      bool success = server_->ExecuteCall(session_, request_, status_, write_buffer, record_);
+      if (scheduled_)
+        server_->scheduler_->Release(this);
+      server_->CompleteCall(session_, success, write_buffer, record_);
+    }
+
+    virtual void Dispatch()
+    {
+      if (server_->executor_)
+      {
+        // Execute on the calling thread if the executor refuses the call
+        if (!server_->executor_->Submit(this))
+        {
+          Execute();
+          delete this;
+        }
+        return;
+      }
+
+      // Wake the session's thread which is waiting to execute this call
+      std::lock_guard<std::mutex> scope_lock(session_->calls_lock_);
+      dispatched_ = true;
+      session_->calls_done_.notify_all();
+    }
+
+    virtual void Execute()
+    {
+      Run();
+    }
+
+  private:
+    CallTask(const CallTask & copy); //disable copy constructor.
+    CallTask & operator =(const CallTask & other); //disable assignment operator.
+  };
+
   std::string GetErrorDesription(DWORD code);
 
   const unsigned long & Server::DEFAULT_BUFFER_SIZE = 10240;
@@ -111,8 +197,19 @@ namespace pbop
     next_connection_id_(0),
     running_(false),
     shutdown_request_(false),
-    shutdown_processed_(false)
+    shutdown_processed_(false),
+    placement_(PLACEMENT_NONE),
+    placement_unit_(PLACEMENT_UNIT_PROCESSOR),
+    next_placement_slot_(0),
+    num_workers_(0),
+    executor_(NULL),
+    scheduler_(new CallScheduler()),
+    call_events_enabled_(false),
+    statistics_enabled_(false),
+    statistics_(new StatisticsRegistry())
   {
+    services_lock_.SetName("pbop::Server::services_lock_");
+    sessions_lock_.SetName("pbop::Server::sessions_lock_");
   }
 
   Server::~Server()
@@ -127,6 +224,26 @@ namespace pbop
         delete service;
     }
     services_.clear();
+
+    if (executor_)
+      delete executor_;
+    executor_ = NULL;
+
+    delete scheduler_;
+    scheduler_ = NULL;
+
+    delete statistics_;
+    statistics_ = NULL;
+
+    // Destroy the session of a thread that has shut down the server
+    if (!running_)
+    {
+      for(size_t i=0; i<client_sessions_.size(); i++)
+      {
+        delete client_sessions_[i];
+      }
+      client_sessions_.clear();
+    }
   }
 
   void Server::SetBufferSize(unsigned int buffer_size)
@@ -144,16 +261,150 @@ namespace pbop
     return pipe_name_.c_str();
   }
 
+  void Server::SetSessionPlacement(SessionPlacement placement, PlacementUnit unit)
+  {
+    placement_ = placement;
+    placement_unit_ = unit;
+  }
+
+  Server::SessionPlacement Server::GetSessionPlacement() const
+  {
+    return placement_;
+  }
+
+  Server::PlacementUnit Server::GetPlacementUnit() const
+  {
+    return placement_unit_;
+  }
+
+  void Server::SetWorkerCount(unsigned int num_workers)
+  {
+    num_workers_ = num_workers;
+  }
+
+  unsigned int Server::GetWorkerCount() const
+  {
+    return num_workers_;
+  }
+
+  std::string GetMethodKey(const char * package, const char * service, const char * function)
+  {
+    std::string key;
+    key += (package ? package : "");
+    key += ".";
+    key += (service ? service : "");
+    if (function)
+    {
+      key += ".";
+      key += function;
+    }
+    return key;
+  }
+
+  Status Server::SetMethodOptions(const char * package, const char * service, const char * function, const MethodOptions & options)
+  {
+    // The scheduler only counts the calls that started after the options were set.
+    if (running_)
+      return Status(STATUS_CODE_CANCELLED, "The method options can not be changed while the server is running.");
+
+    scheduler_->SetOptions(GetMethodKey(package, service, function), options);
+    return Status::OK;
+  }
+
+  bool Server::GetMethodOptions(const char * package, const char * service, const char * function, MethodOptions & options) const
+  {
+    return scheduler_->GetOptions(GetMethodKey(package, service, function), options);
+  }
+
+  void Server::InitPlacementSlots()
+  {
+    ScopeLock scope_lock(&placement_lock_);
+
+    placement_slots_.clear();
+    placement_loads_.clear();
+    next_placement_slot_ = 0;
+
+    if (placement_ == PLACEMENT_NONE)
+      return;
+
+    // Sessions are only pinned to the processors on which the process is allowed to run.
+    std::vector<unsigned int> process_processors;
+    if (!GetProcessProcessors(process_processors))
+      return;
+
+    if (placement_unit_ == PLACEMENT_UNIT_NUMA_NODE)
+    {
+      unsigned int num_nodes = GetNumaNodeCount();
+      for(unsigned int i=0; i<num_nodes; i++)
+      {
+        std::vector<unsigned int> node_processors;
+        if (!GetNumaNodeProcessors(i, node_processors))
+          continue;
+        std::vector<unsigned int> processors;
+        for(size_t j=0; j<node_processors.size(); j++)
+        {
+          if (std::find(process_processors.begin(), process_processors.end(), node_processors[j]) != process_processors.end())
+            processors.push_back(node_processors[j]);
+        }
+        if (!processors.empty())
+          placement_slots_.push_back(processors);
+      }
+    }
+    else
+    {
+      for(size_t i=0; i<process_processors.size(); i++)
+      {
+        placement_slots_.push_back(std::vector<unsigned int>(1, process_processors[i]));
+      }
+    }
+    placement_loads_.resize(placement_slots_.size(), 0);
+  }
+
+  int Server::AcquirePlacementSlot()
+  {
+    ScopeLock scope_lock(&placement_lock_);
+
+    if (placement_slots_.empty())
+      return -1;
+
+    size_t slot = 0;
+    if (placement_ == PLACEMENT_LEAST_LOADED)
+    {
+      // Start searching from the next slot to spread sessions when loads are equal.
+      size_t start = next_placement_slot_ % placement_slots_.size();
+      slot = start;
+      for(size_t i=1; i<placement_slots_.size(); i++)
+      {
+        size_t candidate = (start + i) % placement_slots_.size();
+        if (placement_loads_[candidate] < placement_loads_[slot])
+          slot = candidate;
+      }
+      next_placement_slot_ = slot + 1;
+    }
+    else
+    {
+      slot = next_placement_slot_ % placement_slots_.size();
+      next_placement_slot_++;
+    }
+
+    placement_loads_[slot]++;
+    return (int)slot;
+  }
+
+  void Server::ReleasePlacementSlot(int slot)
+  {
+    ScopeLock scope_lock(&placement_lock_);
+
+    if (slot >= 0 && (size_t)slot < placement_loads_.size() && placement_loads_[slot] > 0)
+      placement_loads_[slot]--;
+  }
+
   Status Server::Run(const char * pipe_name) 
   { 
     pipe_name_ = pipe_name;
-    running_ = true;
-    shutdown_request_ = false;
-    shutdown_processed_ = false;
-
-    // Process events
-    EventStartup event_startup;
-    OnEvent(&event_startup);
+    Status status = Startup();
+    if (!status.Success())
+      return status;
 
     // The main loop waits for a client to connect to it.
     // When the client connects, a thread is created to handle communications 
@@ -172,7 +423,7 @@ namespace pbop
       options.buffer_size = buffer_size_;
 
       // Wait for the client to connect
-      Status status = PipeConnection::Listen(pipe_name, &connection, &options);
+      status = PipeConnection::Listen(pipe_name, &connection, &options);
       if (!status.Success())
         return status;
       if (connection == NULL)
@@ -184,48 +435,108 @@ namespace pbop
       if (shutdown_request_)
         break;
 
-      // Process events
-      next_connection_id_++;
-      EventConnection event_connection;
-      event_connection.SetConnectionId(next_connection_id_);
-      OnEvent(&event_connection);
-
       // Build a session for this client
-      ClientSession * session = new ClientSession(this, connection, next_connection_id_);
+      status = StartSession(connection);
+      if (status.GetCode() == STATUS_CODE_CANCELLED)
+      {
+        // A shutdown was requested while the session was created
+        delete connection;
+        break;
+      }
+      if (!status.Success())
+        return status;
+    }
 
-      // Remember this session
-      client_sessions_.push_back(session);
+    // At this point, the listening loop has exited.
+    // There will be no new incomming pipe/connection/session.
+    Cleanup();
 
-      // Start this session's thread.
-      status = session->thread_->Start();
+    return Status::OK; 
+  }
+
+  Status Server::Start()
+  {
+    if (running_)
+      return Status(STATUS_CODE_CANCELLED, "The server is already running.");
+
+    // There is no listening loop. Clients are attached with AddConnection().
+    pipe_name_.clear();
+    return Startup();
+  }
+
+  Status Server::Startup()
+  {
+    shutdown_request_ = false;
+    shutdown_processed_ = false;
+
+    // Compute the processors or NUMA nodes available for client sessions.
+    InitPlacementSlots();
+
+    // Start the workers that execute service methods
+    if (num_workers_ > 0 && executor_ == NULL)
+    {
+      executor_ = new WorkStealingExecutor();
+      Status status = executor_->Start(num_workers_);
       if (!status.Success())
       {
-        //Force a pipe error but keep the same error message
-        status.SetCode(STATUS_CODE_PIPE_ERROR);
+        delete executor_;
+        executor_ = NULL;
         return status;
       }
     }
 
-    // At this point, the listening loop has exited.
-    // There will be no new incomming pipe/connection/session.
+    // Calls waiting for a worker are queued by the scheduler.
+    scheduler_->SetCapacity(executor_ ? executor_->GetWorkerCount() : 0);
+
+    // Connections can now be added to the server
+    {
+      ScopeLock scope_lock(&sessions_lock_);
+      running_ = true;
+    }
+
+    // Process events
+    EventStartup event_startup;
+    OnEvent(&event_startup);
+
+    return Status::OK;
+  }
+
+  void Server::Cleanup()
+  {
     // Because the shutdown_request_ flag is set, the session threads will 
     // eventually exit the RunMessageProcessingLoop() loop for the following:
     // 1) after processing their next message from a client or
     // 2) after having a Connection::Read() timeout because no message is received.
     // Wait for all the ClientSession threads to complete.
-    for(size_t i=0; i<client_sessions_.size(); i++)
+    // The sessions are joined without holding the sessions lock: a session thread may call AddConnection() while the server shuts down.
+    // No session is added once the shutdown_request_ flag is set.
+    std::vector<ClientSession *> sessions;
     {
-      ClientSession * session = client_sessions_[i];
+      ScopeLock scope_lock(&sessions_lock_);
+      sessions.swap(client_sessions_);
+    }
+    const unsigned long current_thread_id = (unsigned long)GetCurrentThreadId();
+    for(size_t i=0; i<sessions.size(); i++)
+    {
+      ClientSession * session = sessions[i];
+      if (session->thread_->GetId() == current_thread_id)
+      {
+        // The server is shut down from this session's thread. The session is destroyed by the next Cleanup() or by the destructor.
+        ScopeLock scope_lock(&sessions_lock_);
+        client_sessions_.push_back(session);
+        continue;
+      }
       session->thread_->Join();
+      delete session;
     }
 
-    // Destroy each session
-    for(size_t i=0; i<client_sessions_.size(); i++)
+    // All sessions have completed their calls. Stop the workers.
+    if (executor_)
     {
-      ClientSession * session = client_sessions_[i];
-      delete session;
+      executor_->Stop();
+      delete executor_;
+      executor_ = NULL;
     }
-    client_sessions_.clear();
 
     // The shutdown process is completed.
     shutdown_processed_ = true;
@@ -234,8 +545,71 @@ namespace pbop
     // Process events
     EventShutdown event_shutdown;
     OnEvent(&event_shutdown);
+  }
 
-    return Status::OK; 
+  Status Server::AddConnection(Connection * connection)
+  {
+    if (connection == NULL)
+      return Status(STATUS_CODE_INVALID_ARGUMENT, "Connection is NULL.");
+
+    return StartSession(connection);
+  }
+
+  Status Server::StartSession(Connection * connection)
+  {
+    connection_id_t connection_id = 0;
+    {
+      ScopeLock scope_lock(&sessions_lock_);
+
+      // Sessions are only joined by a running server
+      if (!running_ || shutdown_request_)
+        return Status(STATUS_CODE_CANCELLED, "The server is not running.");
+
+      next_connection_id_++;
+      connection_id = next_connection_id_;
+    }
+
+    // Process events.
+    // The event handler is called without holding the sessions lock. It may add connections to the server.
+    EventConnection event_connection;
+    event_connection.SetConnectionId(connection_id);
+    OnEvent(&event_connection);
+
+    ScopeLock scope_lock(&sessions_lock_);
+
+    // The server may have been shut down while processing the event
+    if (!running_ || shutdown_request_)
+      return Status(STATUS_CODE_CANCELLED, "The server is not running.");
+
+    // Build a session for this client
+    ClientSession * session = new ClientSession(this, connection, connection_id);
+
+    // Pin this session to a processor or NUMA node
+    session->placement_slot_ = AcquirePlacementSlot();
+    if (session->placement_slot_ >= 0)
+      session->thread_->SetAffinity(placement_slots_[session->placement_slot_]);
+
+    // Remember this session
+    client_sessions_.push_back(session);
+
+    // Start this session's thread.
+    // A session that cannot be pinned runs unpinned and does not count in the load of its slot.
+    Status status = session->thread_->Start();
+    if (!status.Success() && session->placement_slot_ >= 0)
+    {
+      ReleasePlacementSlot(session->placement_slot_);
+      session->placement_slot_ = -1;
+      session->thread_->SetAffinity(std::vector<unsigned int>());
+      status = session->thread_->Start();
+    }
+    if (!status.Success())
+    {
+      //Force a pipe error but keep the same error message
+      status.SetCode(STATUS_CODE_PIPE_ERROR);
+      return status;
+    }
+
+    return Status::OK;
   }
 
   void Server::RegisterService(Service * service)
@@ -244,15 +618,88 @@ namespace pbop
     ScopeLock scope_lock(&services_lock_, ScopeLock::WRITING);
 
     services_.push_back(service);
+
+    // Create the statistics counters of each method of the service
+    const char * package_name = service->GetPackageName();
+    const char * service_name = service->GetServiceName();
+    const char ** functions = service->GetFunctionIdentifiers();
+    for(; functions != NULL && *functions != NULL; functions++)
+    {
+      statistics_->AddMethod(package_name ? package_name : "", service_name ? service_name : "", *functions);
+    }
   }
 
-  Status Server::RouteMessageToServiceMethod(const std::string & input, std::string & output)
+  Service * Server::FindService(const char * package_name, const char * service_name)
   {
     // Prevent other threads from manipulating services while we process this function.
     ScopeLock scope_lock(&services_lock_, ScopeLock::READING);
 
+    if (package_name == NULL)
+      package_name = "";
+    if (service_name == NULL)
+      service_name = "";
+
+    for(size_t i=0; i<services_.size(); i++)
+    {
+      Service * service = services_[i];
+      const char * tmp_package_name = service->GetPackageName();
+      const char * tmp_service_name = service->GetServiceName();
+      if (strcmp(tmp_package_name ? tmp_package_name : "", package_name) == 0 &&
+          strcmp(tmp_service_name ? tmp_service_name : "", service_name) == 0)
+        return service;
+    }
+    return NULL;
+  }
+
+  void Server::SetCallEventsEnabled(bool enabled)
+  {
+    call_events_enabled_ = enabled;
+  }
+
+  bool Server::IsCallEventsEnabled() const
+  {
+    return call_events_enabled_;
+  }
+
+  void Server::SetStatisticsEnabled(bool enabled)
+  {
+    statistics_enabled_ = enabled;
+  }
+
+  bool Server::IsStatisticsEnabled() const
+  {
+    return statistics_enabled_;
+  }
+
+  void Server::GetStatistics(std::vector<MethodStatistics> & statistics) const
+  {
+    statistics_->GetStatistics(statistics, false);
+  }
+
+  void Server::GetStatistics(std::vector<MethodStatistics> & statistics, bool reset)
+  {
+    statistics_->GetStatistics(statistics, reset);
+  }
+
+  void Server::ResetStatistics()
+  {
+    statistics_->Reset();
+  }
+
+  Status Server::RouteMessageToServiceMethod(const std::string & input, std::string & output)
+  {
     // Process the incoming message.
     ClientRequest client_message;
+    Status status = DecodeClientRequest(input, client_message);
+    if (!status.Success())
+      return status;
+
+    status = RouteMessageToServiceMethod(client_message, output);
+    return status;
+  }
+
+  Status Server::DecodeClientRequest(const std::string & input, ClientRequest & client_message)
+  {
     bool success = client_message.ParseFromString(input);
     if (!success)
     {
@@ -266,19 +713,36 @@ namespace pbop
       Status status = Status::Factory::MissingField(__FUNCTION__, "function_identifier", client_message);
       return status;
     }
+
+    return Status::OK;
+  }
+
+  Status Server::RouteMessageToServiceMethod(const ClientRequest & client_message, std::string & output)
+  {
+    return InvokeServiceMethod(NULL, client_message, output);
+  }
+
+  Status Server::InvokeServiceMethod(ClientSession * context, const ClientRequest & client_message, std::string & output)
+  {
     const std::string & package_name = client_message.function_identifier().package();
     const std::string & service_name = client_message.function_identifier().service();
     const std::string & function_name = client_message.function_identifier().function_name();
 
     // Find the associated service
+    // Services are only deleted with the server. The lock is not required once the service is found.
     Service * service = NULL;
-    for(size_t i=0; i<services_.size() && service == NULL; i++)
     {
-      Service * tmp = services_[i];
-      if (tmp->GetPackageName() == package_name &&
-          tmp->GetServiceName() == service_name)
+      // Prevent other threads from manipulating services while we process this function.
+      ScopeLock scope_lock(&services_lock_, ScopeLock::READING);
+
+      for(size_t i=0; i<services_.size() && service == NULL; i++)
       {
-        service = tmp;
+        Service * tmp = services_[i];
+        if (tmp->GetPackageName() == package_name &&
+            tmp->GetServiceName() == service_name)
+        {
+          service = tmp;
+        }
       }
     }
     if (service == NULL)
@@ -321,14 +785,174 @@ namespace pbop
     }
 
     // Run the method
+    TraceScope trace(TRACE_PHASE_EXECUTE, context ? context->connection_id_ : 0, service->GetFunctionIdentifiers()[index]);
+    if (context == NULL || !call_events_enabled_)
+      return service->InvokeMethod(index, client_message.request_buffer(), output);
+
+    // Process events
+    EventCallBegin event_begin;
+    event_begin.SetConnectionId(context->connection_id_);
+    event_begin.SetFunction(service->GetPackageName(), service->GetServiceName(), service->GetFunctionIdentifiers()[index], index);
+    event_begin.SetRequestSize(client_message.request_buffer().size());
+    const unsigned long long begin_time = GetMonotonicTime();
+    event_begin.SetBeginTime(begin_time);
+    OnEvent(&event_begin);
+
     Status status = service->InvokeMethod(index, client_message.request_buffer(), output);
+    const unsigned long long end_time = GetMonotonicTime();
+
+    // Process events
+    EventCallEnd event_end;
+    event_end.SetConnectionId(context->connection_id_);
+    event_end.SetFunction(service->GetPackageName(), service->GetServiceName(), service->GetFunctionIdentifiers()[index], index);
+    event_end.SetRequestSize(client_message.request_buffer().size());
+    event_end.SetBeginTime(begin_time);
+    event_end.SetEndTime(end_time);
+    event_end.SetResponseSize(status.Success() ? output.size() : 0);
+    event_end.SetStatus(status);
+    OnEvent(&event_end);
+
     return status;
   }
 
+  bool Server::ExecuteCall(ClientSession * context, const ClientRequest & client_message, Status status, std::string & write_buffer, CallRecord & record)
+  {
+    // Delegate the message to a service.
+    // This will actually call a method of a service.
+    std::string * function_call_result = NULL;
+    if (status.Success())
+    {
+      if (record.counters)
+        record.start_time = GetMonotonicTime();
+      function_call_result = new std::string();
+      status = InvokeServiceMethod(context, client_message, *function_call_result);
+      if (record.counters)
+        record.execute_time = GetMonotonicTime();
+    }
+    if (!status.Success())
+    {
+      record.error = true;
+
+      delete function_call_result;
+      function_call_result = NULL;
+
+      // Process events
+      EventClientError event_error;
+      event_error.SetConnectionId(context->connection_id_);
+      event_error.SetStatus(status);
+      OnEvent(&event_error);
+    }
+
+    // Build server response for the client.
+    StatusMessage * status_message = new StatusMessage();
+    status_message->set_code(status.GetCode());
+    if (!status.Success())
+      status_message->set_description(status.GetDescription());
+
+    ServerResponse server_response;
+    server_response.set_allocated_status(status_message);
+    if (function_call_result)
+      server_response.set_allocated_response_buffer(function_call_result);
+
+    bool success = false;
+    {
+      TraceScope trace(TRACE_PHASE_ENCODE, context->connection_id_, NULL);
+      success = server_response.SerializeToString(&write_buffer);
+    }
+    if (record.counters && success)
+    {
+      record.encode_time = GetMonotonicTime();
+      record.bytes_out = write_buffer.size();
+    }
+    if (!success)
+    {
+      Status status = Status::Factory::Serialization(__FUNCTION__, server_response);
+
+      // Process events
+      EventClientError event_error;
+      event_error.SetConnectionId(context->connection_id_);
+      event_error.SetStatus(status);
+      OnEvent(&event_error);
+
+      return false;
+    }
+
+    return true;
+  }
+
+  bool Server::WriteResponse(ClientSession * context, const std::string & write_buffer)
+  {
+    // Send response to client through the pipe connection.
+    TraceScope trace(TRACE_PHASE_WRITE, context->connection_id_, NULL);
+    Status status = context->connection_->Write(write_buffer);
+    if (!status.Success())
+    {
+      // Process events
+      EventClientError event_error;
+      event_error.SetConnectionId(context->connection_id_);
+      event_error.SetStatus(status);
+      OnEvent(&event_error);
+
+      return false;
+    }
+
+    return true;
+  }
+
+  // Add a completed call to the statistics of its method.
+  inline void RecordCall(CallRecord & record, bool written)
+  {
+    if (record.counters == NULL)
+      return;
+    if (!written)
+      record.error = true;
+    record.counters->Record(record, written ? GetMonotonicTime() : 0);
+  }
+
+  void Server::CompleteCall(ClientSession * context, bool success, const std::string & write_buffer, CallRecord & record)
+  {
+    // The session waits for this call to complete before reading the next request.
+    // The response can be written without holding the session's lock.
+    bool written = (success && WriteResponse(context, write_buffer));
+    RecordCall(record, written);
+
+    std::lock_guard<std::mutex> scope_lock(context->calls_lock_);
+    if (!written)
+      context->calls_error_ = true;
+    context->pending_calls_--;
+    context->calls_done_.notify_all();
+  }
+
+  void Server::ScheduleCall(ClientSession * context, CallTask * task, const std::string & service_key, const std::string & method_key)
+  {
+    // When workers are enabled, the call is submitted to the executor by the scheduler.
+    task->scheduled_ = true;
+    scheduler_->Schedule(task, service_key, method_key);
+    if (executor_)
+      return;
+
+    // Wait for the scheduler to allow the call to run on this session's thread.
+    {
+      std::unique_lock<std::mutex> scope_lock(context->calls_lock_);
+      while(!task->dispatched_)
+        context->calls_done_.wait(scope_lock);
+    }
+    task->Run();
+    delete task;
+  }
+
   DWORD Server::RunMessageProcessingLoop(Server::ClientSession * context)
   {
     BOOL fSuccess = FALSE;
 
+    // Allocate the session buffers from the session's own thread.
+    // When the thread is pinned, the pages are first touched on the thread's
+    // NUMA node which makes the operating system allocate them locally.
+    context->read_buffer_.assign(buffer_size_, '\0');
+    context->read_buffer_.clear();
+    context->write_buffer_.assign(buffer_size_, '\0');
+    context->write_buffer_.clear();
+
     if (!shutdown_request_)
     {
       // Process events
@@ -343,7 +967,7 @@ namespace pbop
       // Read client requests from the pipe.
       // Timeout after each 5 seconds.
       // Loop until we receive an actual message (not a timeout results).
-      std::string read_buffer;
+      std::string & read_buffer = context->read_buffer_;
       Status status;
       do
       {
@@ -360,8 +984,9 @@ namespace pbop
 
       if (!status.Success())
       {
-        DWORD wLastErrorCode = GetLastError();
-        if (wLastErrorCode == ERROR_BROKEN_PIPE)
+        // Every connection returns STATUS_CODE_PIPE_ERROR when its peer is closed.
+        // The Win32 last error is only set by a PipeConnection.
+        if (status.GetCode() == STATUS_CODE_PIPE_ERROR)
         {
           // Client disconnected
 
@@ -386,59 +1011,68 @@ namespace pbop
         break;
       }
 
-      // Parse and delegate message to a service
-      // This will actually call a method of a service.
-      std::string * function_call_result = new std::string();
-      status = this->RouteMessageToServiceMethod(read_buffer, *function_call_result);
-      if (!status.Success())
+      // Decode the client's request.
+      // Decoding errors are reported to the client by ExecuteCall().
+      CallTask * task = new CallTask(this, context);
+      const bool record_statistics = statistics_enabled_;
+      if (record_statistics)
+        task->record_.read_time = GetMonotonicTime();
       {
-        delete function_call_result;
-        function_call_result = NULL;
-
-        // Process events
-        EventClientError event_error;
-        event_error.SetConnectionId(context->connection_id_);
-        event_error.SetStatus(status);
-        OnEvent(&event_error);
+        TraceScope trace(TRACE_PHASE_DECODE, context->connection_id_, NULL);
+        task->status_ = DecodeClientRequest(read_buffer, task->request_);
       }
-
-      // Build server response for the client.
-      StatusMessage * status_message = new StatusMessage();
-      status_message->set_code(status.GetCode());
-      status_message->set_description(status.GetDescription());
-
-      ServerResponse server_response;
-      server_response.set_allocated_status(status_message);
-      if (function_call_result)
-        server_response.set_allocated_response_buffer(function_call_result);
-      
-      std::string write_buffer;
-      bool success = server_response.SerializeToString(&write_buffer);
-      if (!success)
+      if (record_statistics && task->status_.Success())
       {
-        Status status = Status::Factory::Serialization(__FUNCTION__, server_response);
-
-        // Process events
-        EventClientError event_error;
-        event_error.SetConnectionId(context->connection_id_);
-        event_error.SetStatus(status);
-        OnEvent(&event_error);
-
-        break;
+        // Only the calls to the methods of registered services are recorded
+        const FunctionIdentifier & identifier = task->request_.function_identifier();
+        task->record_.counters = statistics_->FindMethod(identifier.package(), identifier.service(), identifier.function_name());
+        task->record_.decode_time = GetMonotonicTime();
+        task->record_.bytes_in = read_buffer.size();
+      }
+      {
+        std::lock_guard<std::mutex> scope_lock(context->calls_lock_);
+        context->pending_calls_++;
       }
 
-      // Send response to client through the pipe connection.
-      status = context->connection_->Write(write_buffer);
-      if (!status.Success())
+      // The calls of scheduled methods are executed by a worker if an executor is available. The response is written by the worker.
+      // Other calls are executed on the session's thread: the session waits for the response anyway and a worker would only add two thread hand-offs.
+      bool scheduled = false;
+      if (task->status_.Success() && scheduler_->HasOptions())
+      {
+        const FunctionIdentifier & identifier = task->request_.function_identifier();
+        std::string service_key = GetMethodKey(identifier.package().c_str(), identifier.service().c_str(), NULL);
+        std::string method_key = GetMethodKey(identifier.package().c_str(), identifier.service().c_str(), identifier.function_name().c_str());
+        if (scheduler_->HasOptions(service_key, method_key))
+        {
+          ScheduleCall(context, task, service_key, method_key);
+          scheduled = true;
+        }
+      }
+      if (!scheduled)
       {
-        // Process events
-        EventClientError event_error;
-        event_error.SetConnectionId(context->connection_id_);
-        event_error.SetStatus(status);
-        OnEvent(&event_error);
+        task->Run();
+        delete task;
+      }
 
-        break;
+      // Wait for the response to be written before reading the next request.
+      // Leave the loop if the response could not be sent to the client.
+      bool calls_error = false;
+      {
+        std::unique_lock<std::mutex> scope_lock(context->calls_lock_);
+        while(context->pending_calls_ > 0)
+          context->calls_done_.wait(scope_lock);
+        calls_error = context->calls_error_;
       }
+      if (calls_error)
+        break;
+    }
+
+    // Wait for the session's calls that are still executing.
+    // The connection must remain valid until all responses are written.
+    {
+      std::unique_lock<std::mutex> scope_lock(context->calls_lock_);
+      while(context->pending_calls_ > 0)
+        context->calls_done_.wait(scope_lock);
     }
 
     if (!shutdown_request_)
@@ -449,9 +1083,16 @@ namespace pbop
       OnEvent(&event_destroy);
     }
 
+    ReleasePlacementSlot(context->placement_slot_);
+
     return 0;
   }
 
+  std::string Server::DumpLockStatistics() const
+  {
+    return LockProfiler::ToString();
+  }
+
   bool Server::IsRunning() const
   {
     return running_;
@@ -463,6 +1104,14 @@ namespace pbop
     shutdown_processed_ = false;
     shutdown_request_ = true;
 
+    // A server started with Start() has no listening loop to wake up.
+    if (pipe_name_.empty())
+    {
+      if (running_)
+        Cleanup();
+      return Status::OK;
+    }
+
     // Make a dummy connection to the server. This will force the listening loop to exit the
     // blocking Listen() function. On Listen() return, the shutdown_request_ flag is 
     // read and the function stops looping.
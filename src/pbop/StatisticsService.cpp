@@ -0,0 +1,164 @@
+/**********************************************************************************
+ * MIT License
+ * 
+ * Copyright (c) 2018 Antoine Beauchamp
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#ifdef _WIN32
+//google/protobuf/io/coded_stream.h(869): warning C4800: 'google::protobuf::internal::Atomic32' : forcing value to bool 'true' or 'false' (performance warning)
+//google/protobuf/wire_format_lite.h(863): warning C4146: unary minus operator applied to unsigned type, result still unsigned
+//google/protobuf/wire_format_lite.h(874): warning C4146: unary minus operator applied to unsigned type, result still unsigned
+//google/protobuf/generated_message_util.h(160): warning C4800: 'const google::protobuf::uint32' : forcing value to bool 'true' or 'false' (performance warning)
+__pragma( warning(push) )
+__pragma( warning(disable: 4800))
+__pragma( warning(disable: 4146))
+#endif //_WIN32
+
+#include "pbop/StatisticsService.h"
+#include "pbop/Server.h"
+#include "pbop/ClientCall.h"
+
+#include "pbop.pb.h"
+
+#ifdef _WIN32
+__pragma( warning(pop) )
+#endif //_WIN32
+
+namespace pbop
+{
+
+  static const char * STATISTICS_PACKAGE_NAME = "pbop";
+  static const char * STATISTICS_SERVICE_NAME = "StatisticsService";
+
+  // Serialized function_identifier field of the ClientRequest and CallDescriptor of the GetStatistics method.
+  static const unsigned char GetStatistics_identifier[] = { 0x0a, 0x28, 0x0a, 0x04, 0x70, 0x62, 0x6f, 0x70, 0x12, 0x11, 0x53, 0x74, 0x61, 0x74, 0x69, 0x73, 0x74, 0x69, 0x63, 0x73, 0x53, 0x65, 0x72, 0x76, 0x69, 0x63, 0x65, 0x1a, 0x0d, 0x47, 0x65, 0x74, 0x53, 0x74, 0x61, 0x74, 0x69, 0x73, 0x74, 0x69, 0x63, 0x73 };
+  static const CallDescriptor GetStatistics_call = { "GetStatistics", GetStatistics_identifier, sizeof(GetStatistics_identifier) };
+
+  StatisticsService::Client::Client(Connection * connection) : connection_(connection)
+  {
+  }
+
+  StatisticsService::Client::~Client()
+  {
+    if (connection_)
+      delete connection_;
+    connection_ = NULL;
+  }
+
+  Status StatisticsService::Client::GetStatistics(const GetStatisticsRequest & request, GetStatisticsResponse & response)
+  {
+    return ClientCall(connection_, GetStatistics_call, request, response);
+  }
+
+  StatisticsService::Service::Service(Server * server) : server_(server)
+  {
+  }
+
+  StatisticsService::Service::~Service()
+  {
+  }
+
+  const char * StatisticsService::Service::GetPackageName() const
+  {
+    return STATISTICS_PACKAGE_NAME;
+  }
+
+  const char * StatisticsService::Service::GetServiceName() const
+  {
+    return STATISTICS_SERVICE_NAME;
+  }
+
+  const char ** StatisticsService::Service::GetFunctionIdentifiers() const
+  {
+    static const char * identifiers[] = {
+      "GetStatistics",
+      NULL,
+    };
+    return identifiers;
+  }
+
+  Status StatisticsService::Service::InvokeMethod(const size_t & index, const std::string & input, std::string & output)
+  {
+    switch(index)
+    {
+    case 0:
+      {
+        GetStatisticsRequest request;
+        GetStatisticsResponse response;
+        bool success = request.ParseFromString(input);
+        if (!success)
+          return Status::Factory::Deserialization(__FUNCTION__, request);
+        Status status = this->GetStatistics(request, response);
+        if (!status.Success())
+          return status;
+        success = response.SerializeToString(&output);
+        if (!success)
+          return Status::Factory::Serialization(__FUNCTION__, response);
+      }
+      break;
+    default:
+      //Not implemented
+      return Status(STATUS_CODE_NOT_IMPLEMENTED, "Function at index " + std::to_string((unsigned long long)index) + " is not implemented.");
+    };
+
+    return Status::OK;
+  }
+
+  Status StatisticsService::Service::GetStatistics(const GetStatisticsRequest & request, GetStatisticsResponse & response)
+  {
+    if (server_ == NULL)
+      return Status(STATUS_CODE_INVALID_ARGUMENT, "The statistics service is not attached to a server.");
+
+    std::vector<MethodStatistics> statistics;
+    server_->GetStatistics(statistics, request.reset());
+
+    for(size_t i=0; i<statistics.size(); i++)
+    {
+      const MethodStatistics & method = statistics[i];
+      MethodStatisticsMessage * message = response.add_methods();
+      message->mutable_function_identifier()->set_package(method.package);
+      message->mutable_function_identifier()->set_service(method.service);
+      message->mutable_function_identifier()->set_function_name(method.function);
+      message->set_calls(method.calls);
+      message->set_errors(method.errors);
+      message->set_bytes_in(method.bytes_in);
+      message->set_bytes_out(method.bytes_out);
+
+      for(int phase = 0; phase < CALL_PHASE_COUNT; phase++)
+      {
+        const LatencyHistogram & latency = method.latency[phase];
+        LatencyMessage * latency_message = message->add_latencies();
+        latency_message->set_phase(GetCallPhaseName((CallPhase)phase));
+        latency_message->set_count(latency.GetCount());
+        latency_message->set_min(latency.GetMin());
+        latency_message->set_mean(latency.GetMean());
+        latency_message->set_max(latency.GetMax());
+        latency_message->set_p50(latency.GetPercentile(50.0));
+        latency_message->set_p90(latency.GetPercentile(90.0));
+        latency_message->set_p99(latency.GetPercentile(99.0));
+        latency_message->set_p999(latency.GetPercentile(99.9));
+      }
+    }
+
+    return Status::OK;
+  }
+
+}; //namespace pbop
@@ -24,28 +24,134 @@
 
 #include "pbop/Status.h"
 
+#include <google/protobuf/message.h>
+#include <google/protobuf/descriptor.h>
+
+#include <mutex>
+
 namespace pbop
 {
+  // Out-of-line details of a Status.
+  // The description of a Status created by the Factory is formatted on first use.
+  // Formatting runs once under a std::once_flag so that const readers of a shared Status do not race.
+  // The other members are not modified by formatting. A copy keeps them and formats its own description when it is first read.
+  struct Status::Detail
+  {
+    enum Format
+    {
+      FORMAT_NONE,              // description is already formatted
+      FORMAT_OUT_OF_MEMORY,
+      FORMAT_SERIALIZATION,
+      FORMAT_DESERIALIZATION,
+      FORMAT_MISSING_FIELD,
+      FORMAT_NOT_IMPLEMENTED,
+    };
+
+    Format format;
+    const char * function;
+    const char * field;
+    const ::google::protobuf::Descriptor * type;
+    std::string type_name; // type name of a message without descriptor
+    std::string description;
+    std::once_flag formatted;
+
+    Detail(Format f, const char * fn, const char * fd, const ::google::protobuf::Descriptor * t) :
+      format(f),
+      function(fn),
+      field(fd),
+      type(t)
+    {
+    }
+
+    Detail(const std::string & d) :
+      format(FORMAT_NONE),
+      function(NULL),
+      field(NULL),
+      type(NULL),
+      description(d)
+    {
+    }
+
+    Detail(const Detail & other) :
+      format(other.format),
+      function(other.function),
+      field(other.field),
+      type(other.type),
+      type_name(other.type_name)
+    {
+      if (format == FORMAT_NONE)
+        description = other.description;
+    }
+
+    void FormatDescription()
+    {
+      const char * function_name = (function ? function : "");
+      const char * full_name = (type ? type->full_name().c_str() : type_name.c_str());
+      switch(format)
+      {
+      case FORMAT_OUT_OF_MEMORY:
+        description = std::string("Error in function '") + function_name + "': Out of memory.";
+        break;
+      case FORMAT_SERIALIZATION:
+        description = std::string("Error in function '") + function_name + "': failed to serialize request of type '" + full_name + "'.";
+        break;
+      case FORMAT_DESERIALIZATION:
+        description = std::string("Error in function '") + function_name + "': failed to deserialize request of type '" + full_name + "'.";
+        break;
+      case FORMAT_MISSING_FIELD:
+        description = std::string("Error in function '") + function_name + "': missing field '" + (field ? field : "") + "' in '" + full_name + "' message.";
+        break;
+      case FORMAT_NOT_IMPLEMENTED:
+        description = std::string("Error function '") + function_name + "' is not implemented.";
+        break;
+      default:
+        break;
+      };
+    }
+  };
+
   const Status & Status::OK = Status(STATUS_CODE_SUCCESS, "");
 
-  Status::Status() : code_(STATUS_CODE_UNKNOWN)
+  Status::Status() :
+    code_(STATUS_CODE_UNKNOWN),
+    detail_(NULL)
   {
   }
 
   Status::Status(const Status & other) :
     code_(other.code_),
-    description_(other.description_)
+    detail_(other.detail_ ? new Detail(*other.detail_) : NULL)
   {
   }
 
+  Status::Status(Status && other) noexcept :
+    code_(other.code_),
+    detail_(other.detail_)
+  {
+    other.detail_ = NULL;
+  }
+
   Status::Status(const StatusCode & code, const std::string & message) :
     code_(code),
-    description_(message)
+    detail_(message.empty() ? NULL : new Detail(message))
+  {
+  }
+
+  Status::Status(const StatusCode & code, const char * message) :
+    code_(code),
+    detail_(message == NULL || message[0] == '\0' ? NULL : new Detail(message))
+  {
+  }
+
+  Status::Status(const StatusCode & code, Detail * detail) :
+    code_(code),
+    detail_(detail)
   {
   }
 
   Status::~Status()
   {
+    delete detail_;
   }
 
   void Status::SetCode(const StatusCode & code)
@@ -60,44 +166,69 @@ namespace pbop
 
   void Status::SetDescription(const std::string & description)
   {
-    description_ = description;
+    if (description.empty())
+    {
+      delete detail_;
+      detail_ = NULL;
+    }
+    else if (detail_)
+    {
+      detail_->format = Detail::FORMAT_NONE;
+      detail_->description.assign(description);
+    }
+    else
+      detail_ = new Detail(description);
   }
 
   const std::string & Status::GetDescription() const
   {
-    return description_;
+    static const std::string empty_description;
+    if (detail_ == NULL)
+      return empty_description;
+    std::call_once(detail_->formatted, &Detail::FormatDescription, detail_);
+    return detail_->description;
   }
 
-  bool Status::Success()
+  bool Status::Success() const
   {
     if (code_ == STATUS_CODE_SUCCESS)
       return true;
     return false;
   }
 
-  void swap(Status & first, Status & second)
+  void swap(Status & first, Status & second) noexcept
   {
-    //https://stackoverflow.com/questions/3279543/what-is-the-copy-and-swap-idiom
     using std::swap; 
     swap(first.code_, second.code_);
-    swap(first.description_, second.description_);
+    swap(first.detail_, second.detail_);
+  }
+
+  Status & Status::operator=(const Status & other)
+  {
+    if (this == &other)
+      return *this;
+
+    code_ = other.code_;
+    Detail * detail = (other.detail_ ? new Detail(*other.detail_) : NULL);
+    delete detail_;
+    detail_ = detail;
+    return *this;
   }
 
-  Status & Status::operator=(Status other)
+  Status & Status::operator=(Status && other) noexcept
   {
-    //https://stackoverflow.com/questions/3279543/what-is-the-copy-and-swap-idiom
     swap(*this, other);
     return *this;
   }
 
-  bool Status::operator==(const Status & other)
+  bool Status::operator==(const Status & other) const
   {
-    if (this == &other || (this->code_ == other.code_ && this->description_ == other.description_))
+    if (this == &other || (this->code_ == other.code_ && this->GetDescription() == other.GetDescription()))
       return true;
     return false;
   }
 
-  bool Status::operator!=(const Status & other)
+  bool Status::operator!=(const Status & other) const
   {
     return !( (*this) == other );
   }
@@ -137,55 +268,59 @@ namespace pbop
 
   Status Status::Factory::OutOfMemory(const char * function)
   {
-    std::string error_message;
-    error_message += "Error in function '";
-    error_message += function;
-    error_message += "': Out of memory.";
-    return Status(STATUS_CODE_OUT_OF_MEMORY, error_message);
+    return Status(STATUS_CODE_OUT_OF_MEMORY, new Detail(Detail::FORMAT_OUT_OF_MEMORY, function, NULL, NULL));
   }
 
   Status Status::Factory::Serialization(const char * function, const ::google::protobuf::Message & message)
   {
-    std::string error_message;
-    error_message += "Error in function '";
-    error_message += __FUNCTION__;
-    error_message += "': failed to serialize request of type '";
-    error_message += message.GetTypeName();
-    error_message += "'.";
-    return Status(STATUS_CODE_SERIALIZE_ERROR, error_message);
+    return Status(STATUS_CODE_SERIALIZE_ERROR, new Detail(Detail::FORMAT_SERIALIZATION, function, NULL, message.GetDescriptor()));
   }
 
   Status Status::Factory::Deserialization(const char * function, const ::google::protobuf::Message & message)
   {
-    std::string error_message;
-    error_message += "Error in function '";
-    error_message += __FUNCTION__;
-    error_message += "': failed to deserialize request of type '";
-    error_message += message.GetTypeName();
-    error_message += "'.";
-    return Status(STATUS_CODE_DESERIALIZE_ERROR, error_message);
+    return Status(STATUS_CODE_DESERIALIZE_ERROR, new Detail(Detail::FORMAT_DESERIALIZATION, function, NULL, message.GetDescriptor()));
   }
 
   Status Status::Factory::MissingField(const char * function, const char * field, const ::google::protobuf::Message & message)
   {
-    std::string error_message;
-    error_message += "Error in function '";
-    error_message += __FUNCTION__;
-    error_message += "': missing field '";
-    error_message += field;
-    error_message += "' in '";
-    error_message += message.GetTypeName();
-    error_message += "' message.";
-    return Status(STATUS_CODE_DESERIALIZE_ERROR, error_message);
+    return Status(STATUS_CODE_DESERIALIZE_ERROR, new Detail(Detail::FORMAT_MISSING_FIELD, function, field, message.GetDescriptor()));
+  }
+
+  // The MessageLite overloads keep the descriptor of a full Message instead of copying its type name.
+
+  Status Status::Factory::Serialization(const char * function, const ::google::protobuf::MessageLite & message)
+  {
+    const ::google::protobuf::Message * full_message = dynamic_cast<const ::google::protobuf::Message *>(&message);
+    if (full_message)
+      return Serialization(function, *full_message);
+    Detail * detail = new Detail(Detail::FORMAT_SERIALIZATION, function, NULL, NULL);
+    detail->type_name = message.GetTypeName();
+    return Status(STATUS_CODE_SERIALIZE_ERROR, detail);
+  }
+
+  Status Status::Factory::Deserialization(const char * function, const ::google::protobuf::MessageLite & message)
+  {
+    const ::google::protobuf::Message * full_message = dynamic_cast<const ::google::protobuf::Message *>(&message);
+    if (full_message)
+      return Deserialization(function, *full_message);
+    Detail * detail = new Detail(Detail::FORMAT_DESERIALIZATION, function, NULL, NULL);
+    detail->type_name = message.GetTypeName();
+    return Status(STATUS_CODE_DESERIALIZE_ERROR, detail);
+  }
+
+  Status Status::Factory::MissingField(const char * function, const char * field, const ::google::protobuf::MessageLite & message)
+  {
+    const ::google::protobuf::Message * full_message = dynamic_cast<const ::google::protobuf::Message *>(&message);
+    if (full_message)
+      return MissingField(function, field, *full_message);
+    Detail * detail = new Detail(Detail::FORMAT_MISSING_FIELD, function, field, NULL);
+    detail->type_name = message.GetTypeName();
+    return Status(STATUS_CODE_DESERIALIZE_ERROR, detail);
   }
 
   Status Status::Factory::NotImplemented(const char * function)
   {
-    std::string error_message;
-    error_message += "Error function '";
-    error_message += __FUNCTION__;
-    error_message += "' is not implemented.";
-    return Status(STATUS_CODE_NOT_IMPLEMENTED, error_message);
+    return Status(STATUS_CODE_NOT_IMPLEMENTED, new Detail(Detail::FORMAT_NOT_IMPLEMENTED, function, NULL, NULL));
   }
 
 }; //namespace pbop
@@ -0,0 +1,369 @@
+/**********************************************************************************
+ * MIT License
+ * 
+ * Copyright (c) 2018 Antoine Beauchamp
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#include "pbop/ThreadBase.h"
+
+#include <string>
+#include <mutex>
+#include <atomic>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <sched.h>
+#endif
+
+namespace pbop
+{
+
+#ifdef _WIN32
+  std::string GetErrorDesription(DWORD code);
+
+  typedef HRESULT (WINAPI *SetThreadDescriptionFunc)(HANDLE, PCWSTR);
+
+  void SetNativeThreadName(HANDLE hThread, const std::string & name)
+  {
+    // SetThreadDescription() is only available since Windows 10, version 1607.
+    static SetThreadDescriptionFunc set_thread_description = (SetThreadDescriptionFunc)GetProcAddress(GetModuleHandleA("kernel32.dll"), "SetThreadDescription");
+    if (set_thread_description == NULL)
+      return;
+
+    int length = MultiByteToWideChar(CP_UTF8, 0, name.c_str(), -1, NULL, 0);
+    if (length <= 0)
+      return;
+    std::wstring wide_name(length, L'\0');
+    MultiByteToWideChar(CP_UTF8, 0, name.c_str(), -1, &wide_name[0], length);
+    set_thread_description(hThread, wide_name.c_str());
+  }
+#else
+  void SetNativeThreadName(const std::string & name)
+  {
+    // The name of a thread is limited to 16 characters including the terminating null character.
+    std::string short_name = name.substr(0, 15);
+#if defined(__APPLE__)
+    pthread_setname_np(short_name.c_str());
+#elif defined(__linux__)
+    pthread_setname_np(pthread_self(), short_name.c_str());
+#endif
+  }
+#endif
+
+  struct ThreadBase::PImpl
+  {
+    ///<summary>Force that only one thread allowed to call Start().</summary>
+    std::mutex start_lock;
+
+    ///<summary>Force that only one thread joins the native thread.</summary>
+    std::mutex join_lock;
+
+    ///<summary>Handle of the thread. Only valid if `has_handle` is true.</summary>
+    thread_handle_t handle;
+    bool has_handle;
+    bool joined;
+
+    ///<summary>Thread id of the thread. The value 0 means invalid.</summary>
+    unsigned long id;
+
+    ///<summary>An interrupt request flag.</summary>
+    volatile bool interrupt;
+
+    ///<summary>True while Execute() is running.</summary>
+    std::atomic<bool> running;
+
+    std::string name;
+    size_t stack_size;
+    std::vector<unsigned int> affinity;
+
+#ifdef _WIN32
+    static DWORD WINAPI Run(LPVOID thread_obj)
+    {
+      ThreadBase * thread = (ThreadBase *)thread_obj;
+      unsigned long exit_code = thread->Execute();
+      thread->impl_->running = false;
+      return exit_code;
+    }
+#else
+    static void * Run(void * thread_obj)
+    {
+      ThreadBase * thread = (ThreadBase *)thread_obj;
+      if (!thread->impl_->name.empty())
+        SetNativeThreadName(thread->impl_->name);
+      unsigned long exit_code = thread->Execute();
+      thread->impl_->running = false;
+      return (void *)exit_code;
+    }
+#endif
+  };
+
+  ThreadBase::ThreadBase() :
+    impl_(new ThreadBase::PImpl())
+  {
+    impl_->handle = thread_handle_t();
+    impl_->has_handle = false;
+    impl_->joined = false;
+    impl_->id = 0;
+    impl_->interrupt = false;
+    impl_->running = false;
+    impl_->stack_size = 0;
+  }
+
+  ThreadBase::~ThreadBase()
+  {
+    if (impl_)
+    {
+      Join();
+#ifdef _WIN32
+      if (impl_->has_handle)
+        CloseHandle(impl_->handle);
+#endif
+      delete impl_;
+    }
+    impl_ = NULL;
+  }
+
+  Status ThreadBase::Start()
+  {
+    std::unique_lock<std::mutex> scope_lock(impl_->start_lock, std::try_to_lock);
+    if (!scope_lock.owns_lock())
+    {
+      return Status(STATUS_CODE_CANCELLED, "Another thread is already starting this thread.");
+    }
+    if (impl_->has_handle) // The thread had been started sometime in the past
+    {
+      // Is the thread still running?
+      if (impl_->running)
+      {
+        return Status(STATUS_CODE_CANCELLED, "The thread is already running.");
+      }
+
+      // Release the resources of the previous running thread.
+      Join();
+#ifdef _WIN32
+      CloseHandle(impl_->handle);
+#endif
+      impl_->handle = thread_handle_t();
+      impl_->has_handle = false;
+      impl_->id = 0;
+    }
+
+    // Set or reset the 'not interrupted' state
+    impl_->interrupt = false;
+    impl_->joined = false;
+    impl_->running = true;
+
+#ifdef _WIN32
+    // A thread that cannot be pinned to its processors is not started.
+    DWORD_PTR affinity_mask = 0;
+    if (!impl_->affinity.empty())
+    {
+      for(size_t i=0; i<impl_->affinity.size(); i++)
+      {
+        unsigned int processor = impl_->affinity[i];
+        if (processor < sizeof(DWORD_PTR)*8)
+          affinity_mask |= ((DWORD_PTR)1 << processor);
+      }
+      DWORD_PTR process_mask = 0;
+      DWORD_PTR system_mask = 0;
+      if (GetProcessAffinityMask(GetCurrentProcess(), &process_mask, &system_mask))
+        affinity_mask &= process_mask;
+      if (affinity_mask == 0)
+      {
+        impl_->running = false;
+        return Status(STATUS_CODE_INVALID_ARGUMENT, "The thread affinity does not contain any processor of the process.");
+      }
+    }
+
+    DWORD flags = CREATE_SUSPENDED;
+    if (impl_->stack_size)
+      flags |= STACK_SIZE_PARAM_IS_A_RESERVATION;
+    DWORD thread_id = 0;
+    HANDLE hThread = CreateThread(
+      NULL,
+      impl_->stack_size,
+      &ThreadBase::PImpl::Run,
+      this,
+      flags,
+      &thread_id);
+
+    if (hThread == NULL)
+    {
+      impl_->running = false;
+      std::string error_description = std::string("CreateThread failed: ") + GetErrorDesription(GetLastError());
+      return Status(STATUS_CODE_CANCELLED, error_description);
+    }
+
+    // Apply the thread properties while the thread is suspended.
+    if (affinity_mask && SetThreadAffinityMask(hThread, affinity_mask) == 0)
+    {
+      DWORD error = GetLastError();
+      // The thread never ran and holds no resources.
+      TerminateThread(hThread, 0);
+      WaitForSingleObject(hThread, INFINITE);
+      CloseHandle(hThread);
+      impl_->running = false;
+      std::string error_description = std::string("SetThreadAffinityMask failed: ") + GetErrorDesription(error);
+      return Status(STATUS_CODE_INVALID_ARGUMENT, error_description);
+    }
+    if (!impl_->name.empty())
+      SetNativeThreadName(hThread, impl_->name);
+
+    impl_->handle = hThread;
+    impl_->has_handle = true;
+    impl_->id = thread_id;
+
+    ResumeThread(hThread);
+    return Status::OK;
+#else
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    if (impl_->stack_size)
+    {
+      size_t stack_size = impl_->stack_size;
+      if (stack_size < (size_t)PTHREAD_STACK_MIN)
+        stack_size = (size_t)PTHREAD_STACK_MIN;
+      pthread_attr_setstacksize(&attr, stack_size);
+    }
+#ifdef __linux__
+    // A thread that cannot be pinned to its processors is not started.
+    if (!impl_->affinity.empty())
+    {
+      cpu_set_t cpu_set;
+      CPU_ZERO(&cpu_set);
+      for(size_t i=0; i<impl_->affinity.size(); i++)
+      {
+        unsigned int processor = impl_->affinity[i];
+        if (processor < CPU_SETSIZE)
+          CPU_SET(processor, &cpu_set);
+      }
+      int affinity_error = (CPU_COUNT(&cpu_set) > 0 ? pthread_attr_setaffinity_np(&attr, sizeof(cpu_set), &cpu_set) : EINVAL);
+      if (affinity_error != 0)
+      {
+        pthread_attr_destroy(&attr);
+        impl_->running = false;
+        std::string error_description = std::string("pthread_attr_setaffinity_np failed: ") + strerror(affinity_error);
+        return Status(STATUS_CODE_INVALID_ARGUMENT, error_description);
+      }
+    }
+#endif
+
+    pthread_t thread;
+    int error = pthread_create(&thread, &attr, &ThreadBase::PImpl::Run, this);
+    pthread_attr_destroy(&attr);
+
+    if (error != 0)
+    {
+      impl_->running = false;
+      std::string error_description = std::string("pthread_create failed: ") + strerror(error);
+      return Status(STATUS_CODE_CANCELLED, error_description);
+    }
+
+    impl_->handle = thread;
+    impl_->has_handle = true;
+    impl_->id = (unsigned long)thread;
+    return Status::OK;
+#endif
+  }
+
+  void ThreadBase::Join()
+  {
+    std::lock_guard<std::mutex> scope_lock(impl_->join_lock);
+    if (!impl_->has_handle || impl_->joined)
+      return;
+#ifdef _WIN32
+    WaitForSingleObject(impl_->handle, INFINITE);
+#else
+    pthread_join(impl_->handle, NULL);
+#endif
+    impl_->joined = true;
+  }
+
+  void ThreadBase::SetInterrupt()
+  {
+    impl_->interrupt = true;
+  }
+
+  bool ThreadBase::IsInterrupted() const
+  {
+    return impl_->interrupt;
+  }
+
+  bool ThreadBase::IsRunning() const
+  {
+    return impl_->running;
+  }
+
+  thread_handle_t ThreadBase::GetHandle() const
+  {
+    return impl_->handle;
+  }
+
+  unsigned long ThreadBase::GetId() const
+  {
+    return impl_->id;
+  }
+
+  void ThreadBase::SetName(const char * name)
+  {
+    impl_->name = (name ? name : "");
+  }
+
+  const char * ThreadBase::GetName() const
+  {
+    return impl_->name.c_str();
+  }
+
+  void ThreadBase::SetStackSize(size_t stack_size)
+  {
+    impl_->stack_size = stack_size;
+  }
+
+  size_t ThreadBase::GetStackSize() const
+  {
+    return impl_->stack_size;
+  }
+
+  void ThreadBase::SetAffinity(const std::vector<unsigned int> & processors)
+  {
+    impl_->affinity = processors;
+  }
+
+  const std::vector<unsigned int> & ThreadBase::GetAffinity() const
+  {
+    return impl_->affinity;
+  }
+
+  std::string ThreadBase::GetErrorDescription(unsigned long code)
+  {
+#ifdef _WIN32
+    return GetErrorDesription((DWORD)code);
+#else
+    return strerror((int)code);
+#endif
+  }
+
+}; //namespace pbop
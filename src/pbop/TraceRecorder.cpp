@@ -0,0 +1,305 @@
+/**********************************************************************************
+ * MIT License
+ * 
+ * Copyright (c) 2018 Antoine Beauchamp
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#include "pbop/TraceRecorder.h"
+
+#include "pbop/Timing.h"
+
+#include <stdio.h>
+#include <vector>
+#include <mutex>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define PBOP_TRACE_HAS_TSC
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define PBOP_TRACE_HAS_TSC
+#endif
+
+namespace pbop
+{
+
+  const size_t TraceRecorder::DEFAULT_CAPACITY = 65536;
+  std::atomic<bool> TraceRecorder::enabled_(false);
+
+  // Read the raw timestamp of a trace record.
+  static inline unsigned long long ReadTraceTimestamp()
+  {
+#ifdef PBOP_TRACE_HAS_TSC
+    return __rdtsc();
+#else
+    return GetMonotonicTime();
+#endif
+  }
+
+  // Ring buffer of a single thread.
+  // Only the owner thread writes to the buffer. The head is published with release semantics for readers.
+  struct TraceBuffer
+  {
+    std::vector<TraceRecord> records;
+    std::atomic<unsigned long long> head; // Total number of records written to the buffer.
+    unsigned int thread_id;
+  };
+
+  // Registry of all thread buffers.
+  // The registry and the buffers are never destroyed to allow threads to record until the process exits.
+  // The buffer of a thread that exits is reused by the next thread that records. The number of buffers
+  // is bounded by the maximum number of threads that have recorded at the same time.
+  // Each thread that records gets its own thread id, even if it reuses a buffer.
+  struct TraceRegistry
+  {
+    std::mutex lock;
+    std::vector<TraceBuffer *> buffers;
+    std::vector<TraceBuffer *> free_buffers; // Buffers of threads that have exited.
+    unsigned int next_thread_id;
+    size_t capacity;
+    unsigned long long start_ticks; // Raw timestamp when recording was enabled.
+    unsigned long long start_time;  // Monotonic time in nanoseconds when recording was enabled.
+  };
+
+  static TraceRegistry * CreateTraceRegistry()
+  {
+    TraceRegistry * registry = new TraceRegistry();
+    registry->next_thread_id = 1;
+    registry->capacity = TraceRecorder::DEFAULT_CAPACITY;
+    registry->start_ticks = ReadTraceTimestamp();
+    registry->start_time = GetMonotonicTime();
+    return registry;
+  }
+
+  static TraceRegistry & GetTraceRegistry()
+  {
+    static TraceRegistry * registry = CreateTraceRegistry();
+    return *registry;
+  }
+
+  static thread_local TraceBuffer * g_trace_buffer = NULL;
+
+  // Returns the buffer of a thread to the registry when the thread exits.
+  struct TraceBufferOwner
+  {
+    TraceBuffer * buffer;
+
+    TraceBufferOwner() : buffer(NULL) {}
+    ~TraceBufferOwner()
+    {
+      if (buffer == NULL)
+        return;
+      g_trace_buffer = NULL;
+
+      TraceRegistry & registry = GetTraceRegistry();
+      std::lock_guard<std::mutex> scope_lock(registry.lock);
+      registry.free_buffers.push_back(buffer);
+    }
+  };
+
+  static thread_local TraceBufferOwner g_trace_buffer_owner;
+
+  static TraceBuffer * CreateTraceBuffer()
+  {
+    TraceRegistry & registry = GetTraceRegistry();
+    std::lock_guard<std::mutex> scope_lock(registry.lock);
+
+    // Reuse the buffer of a thread that has exited.
+    // The records of the exited thread are discarded so that they are not attributed to the new thread.
+    TraceBuffer * buffer = NULL;
+    if (!registry.free_buffers.empty())
+    {
+      buffer = registry.free_buffers.back();
+      registry.free_buffers.pop_back();
+    }
+    else
+    {
+      buffer = new TraceBuffer();
+      registry.buffers.push_back(buffer);
+    }
+    if (buffer->records.size() != registry.capacity)
+    {
+      buffer->records.clear();
+      buffer->records.resize(registry.capacity);
+    }
+    buffer->head = 0;
+    buffer->thread_id = registry.next_thread_id++;
+    return buffer;
+  }
+
+  static const char * GetTracePhaseName(unsigned char phase)
+  {
+    switch(phase)
+    {
+    case TRACE_PHASE_DECODE:
+      return "decode";
+    case TRACE_PHASE_EXECUTE:
+      return "execute";
+    case TRACE_PHASE_ENCODE:
+      return "encode";
+    case TRACE_PHASE_WRITE:
+      return "write";
+    case TRACE_PHASE_CLIENT_CALL:
+      return "client_call";
+    case TRACE_PHASE_CLIENT_WRITE:
+      return "client_write";
+    case TRACE_PHASE_CLIENT_READ:
+      return "client_read";
+    default:
+      return "unknown";
+    };
+  }
+
+  void TraceRecorder::Enable(size_t capacity)
+  {
+    TraceRegistry & registry = GetTraceRegistry();
+    {
+      std::lock_guard<std::mutex> scope_lock(registry.lock);
+      registry.capacity = (capacity > 0 ? capacity : 1);
+      registry.start_ticks = ReadTraceTimestamp();
+      registry.start_time = GetMonotonicTime();
+    }
+    enabled_ = true;
+  }
+
+  void TraceRecorder::Disable()
+  {
+    enabled_ = false;
+  }
+
+  void TraceRecorder::Record(TracePhase phase, TraceEventType type, connection_id_t connection_id, const char * method)
+  {
+    TraceBuffer * buffer = g_trace_buffer;
+    if (buffer == NULL)
+    {
+      buffer = CreateTraceBuffer();
+      g_trace_buffer = buffer;
+      g_trace_buffer_owner.buffer = buffer;
+    }
+
+    unsigned long long head = buffer->head.load(std::memory_order_relaxed);
+    TraceRecord & record = buffer->records[head % buffer->records.size()];
+    record.timestamp = ReadTraceTimestamp();
+    record.method = method;
+    record.connection_id = connection_id;
+    record.phase = (unsigned char)phase;
+    record.type = (unsigned char)type;
+    buffer->head.store(head + 1, std::memory_order_release);
+  }
+
+  void TraceRecorder::Clear()
+  {
+    TraceRegistry & registry = GetTraceRegistry();
+    std::lock_guard<std::mutex> scope_lock(registry.lock);
+
+    for(size_t i=0; i<registry.buffers.size(); i++)
+    {
+      registry.buffers[i]->head = 0;
+    }
+  }
+
+  size_t TraceRecorder::GetRecordCount()
+  {
+    TraceRegistry & registry = GetTraceRegistry();
+    std::lock_guard<std::mutex> scope_lock(registry.lock);
+
+    size_t count = 0;
+    for(size_t i=0; i<registry.buffers.size(); i++)
+    {
+      TraceBuffer * buffer = registry.buffers[i];
+      unsigned long long head = buffer->head.load(std::memory_order_acquire);
+      count += (size_t)(head < buffer->records.size() ? head : buffer->records.size());
+    }
+    return count;
+  }
+
+  std::string TraceRecorder::ToChromeTrace()
+  {
+    TraceRegistry & registry = GetTraceRegistry();
+    std::lock_guard<std::mutex> scope_lock(registry.lock);
+
+    // Compute the duration of a timestamp tick from the elapsed time since recording was enabled.
+    const unsigned long long now_ticks = ReadTraceTimestamp();
+    const unsigned long long now_time = GetMonotonicTime();
+    double ns_per_tick = 1.0;
+#ifdef PBOP_TRACE_HAS_TSC
+    if (now_ticks > registry.start_ticks && now_time > registry.start_time)
+      ns_per_tick = double(now_time - registry.start_time) / double(now_ticks - registry.start_ticks);
+#endif
+
+    std::string json;
+    json.reserve(4096);
+    json += "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [\n";
+
+    char buffer[512];
+    bool first = true;
+    for(size_t i=0; i<registry.buffers.size(); i++)
+    {
+      TraceBuffer * trace_buffer = registry.buffers[i];
+      const unsigned long long head = trace_buffer->head.load(std::memory_order_acquire);
+      const unsigned long long capacity = trace_buffer->records.size();
+      const unsigned long long first_index = (head > capacity ? head - capacity : 0);
+
+      for(unsigned long long index = first_index; index < head; index++)
+      {
+        const TraceRecord & record = trace_buffer->records[index % capacity];
+
+        // Timestamps are in microseconds relative to the time recording was enabled
+        double ts = double((long long)(record.timestamp - registry.start_ticks)) * ns_per_tick / 1000.0;
+
+        sprintf(buffer, "%s  {\"name\": \"%s%s%.200s\", \"cat\": \"pbop\", \"ph\": \"%s\", \"ts\": %.3f, \"pid\": 1, \"tid\": %u, \"args\": {\"connection_id\": %u}}",
+          (first ? "" : ",\n"),
+          GetTracePhaseName(record.phase),
+          (record.method ? " " : ""),
+          (record.method ? record.method : ""),
+          (record.type == TRACE_EVENT_BEGIN ? "B" : "E"),
+          ts,
+          trace_buffer->thread_id,
+          record.connection_id);
+        json += buffer;
+        first = false;
+      }
+    }
+
+    json += "\n]}\n";
+    return json;
+  }
+
+  Status TraceRecorder::SaveChromeTrace(const char * path)
+  {
+    if (path == NULL)
+      return Status(STATUS_CODE_INVALID_ARGUMENT, "The trace file path is NULL.");
+
+    std::string json = ToChromeTrace();
+
+    FILE * f = fopen(path, "wb");
+    if (f == NULL)
+      return Status(STATUS_CODE_UNKNOWN, std::string("Unable to open trace file '") + path + "' for writing.");
+
+    size_t written = fwrite(json.c_str(), 1, json.size(), f);
+    fclose(f);
+    if (written != json.size())
+      return Status(STATUS_CODE_UNKNOWN, std::string("Unable to write trace file '") + path + "'.");
+
+    return Status::OK;
+  }
+
+}; //namespace pbop
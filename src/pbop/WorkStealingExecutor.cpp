@@ -0,0 +1,264 @@
+/**********************************************************************************
+ * MIT License
+ * 
+ * Copyright (c) 2018 Antoine Beauchamp
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#include "pbop/WorkStealingExecutor.h"
+#include "pbop/ThreadBuilder.h"
+#include "pbop/Processors.h"
+
+#include <stdio.h>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+namespace pbop
+{
+
+  struct ExecutorState;
+
+  class ExecutorWorker
+  {
+  public:
+    ExecutorState * owner_;
+    size_t index_;
+    std::mutex lock_;
+    std::deque<Task *> tasks_;
+    Thread * thread_;
+
+    ExecutorWorker(ExecutorState * owner, size_t index) :
+      owner_(owner),
+      index_(index),
+      thread_(NULL)
+    {
+      thread_ = new ThreadBuilder<ExecutorWorker>(this, &ExecutorWorker::Run);
+    }
+
+    ~ExecutorWorker()
+    {
+      if (thread_)
+      {
+        thread_->Join();
+        delete thread_;
+      }
+      thread_ = NULL;
+    }
+
+    unsigned long Run();
+
+  private:
+    ExecutorWorker(const ExecutorWorker & copy); //disable copy constructor.
+    ExecutorWorker & operator =(const ExecutorWorker & other); //disable assignment operator.
+  };
+
+  // The worker that is running on the current thread. NULL for non-worker threads.
+  static thread_local ExecutorWorker * g_current_worker = NULL;
+
+  // State shared between the executor and its workers
+  struct ExecutorState
+  {
+    std::vector<ExecutorWorker *> workers;
+    std::mutex sleep_lock;
+    std::condition_variable wake;
+    std::atomic<size_t> num_queued;
+    std::atomic<size_t> next_worker;
+    std::atomic<bool> running;
+    bool stopping;
+
+    Task * TakeTask(size_t index)
+    {
+      // Take the most recent task of our own queue (LIFO) for cache locality.
+      {
+        ExecutorWorker * worker = workers[index];
+        std::lock_guard<std::mutex> scope_lock(worker->lock_);
+        if (!worker->tasks_.empty())
+        {
+          Task * task = worker->tasks_.back();
+          worker->tasks_.pop_back();
+          num_queued--;
+          return task;
+        }
+      }
+
+      // Steal the oldest task of another worker (FIFO).
+      for(size_t i=1; i<workers.size(); i++)
+      {
+        ExecutorWorker * victim = workers[(index + i) % workers.size()];
+        std::lock_guard<std::mutex> scope_lock(victim->lock_);
+        if (!victim->tasks_.empty())
+        {
+          Task * task = victim->tasks_.front();
+          victim->tasks_.pop_front();
+          num_queued--;
+          return task;
+        }
+      }
+
+      return NULL;
+    }
+  };
+
+  struct WorkStealingExecutor::PImpl : public ExecutorState
+  {
+  };
+
+  unsigned long ExecutorWorker::Run()
+  {
+    g_current_worker = this;
+
+    for(;;)
+    {
+      Task * task = owner_->TakeTask(index_);
+      if (task)
+      {
+        task->Execute();
+        delete task;
+        continue;
+      }
+
+      // Sleep until a task is submitted or the executor is stopped
+      std::unique_lock<std::mutex> scope_lock(owner_->sleep_lock);
+      if (owner_->num_queued == 0 && owner_->stopping)
+        break;
+      while(owner_->num_queued == 0 && !owner_->stopping)
+        owner_->wake.wait(scope_lock);
+    }
+
+    g_current_worker = NULL;
+    return 0;
+  }
+
+  WorkStealingExecutor::WorkStealingExecutor() :
+    impl_(new WorkStealingExecutor::PImpl())
+  {
+    impl_->num_queued = 0;
+    impl_->next_worker = 0;
+    impl_->running = false;
+    impl_->stopping = false;
+  }
+
+  WorkStealingExecutor::~WorkStealingExecutor()
+  {
+    if (impl_)
+    {
+      Stop();
+      delete impl_;
+    }
+    impl_ = NULL;
+  }
+
+  Status WorkStealingExecutor::Start(size_t num_workers)
+  {
+    if (impl_->running)
+      return Status(STATUS_CODE_CANCELLED, "The executor is already running.");
+
+    if (num_workers == 0)
+      num_workers = GetProcessorCount();
+
+    impl_->stopping = false;
+    for(size_t i=0; i<num_workers; i++)
+    {
+      impl_->workers.push_back(new ExecutorWorker(impl_, i));
+    }
+
+    for(size_t i=0; i<impl_->workers.size(); i++)
+    {
+      ExecutorWorker * worker = impl_->workers[i];
+
+      char name[32];
+      sprintf(name, "pbop-worker-%u", (unsigned int)i);
+      worker->thread_->SetName(name);
+
+      Status status = worker->thread_->Start();
+      if (!status.Success())
+      {
+        Stop();
+        return status;
+      }
+    }
+
+    impl_->running = true;
+    return Status::OK;
+  }
+
+  void WorkStealingExecutor::Stop()
+  {
+    {
+      std::lock_guard<std::mutex> scope_lock(impl_->sleep_lock);
+      impl_->stopping = true;
+    }
+    impl_->wake.notify_all();
+
+    // Workers exit once all queues are empty
+    for(size_t i=0; i<impl_->workers.size(); i++)
+    {
+      ExecutorWorker * worker = impl_->workers[i];
+      worker->thread_->Join();
+    }
+    for(size_t i=0; i<impl_->workers.size(); i++)
+    {
+      ExecutorWorker * worker = impl_->workers[i];
+      delete worker;
+    }
+    impl_->workers.clear();
+    impl_->running = false;
+  }
+
+  bool WorkStealingExecutor::IsRunning() const
+  {
+    return impl_->running;
+  }
+
+  size_t WorkStealingExecutor::GetWorkerCount() const
+  {
+    return impl_->workers.size();
+  }
+
+  bool WorkStealingExecutor::Submit(Task * task)
+  {
+    if (task == NULL || !impl_->running)
+      return false;
+
+    // Tasks submitted from a worker go to the worker's own queue.
+    // Other tasks are distributed to the workers in a round-robin fashion.
+    ExecutorWorker * worker = g_current_worker;
+    if (worker == NULL || worker->owner_ != impl_)
+      worker = impl_->workers[impl_->next_worker++ % impl_->workers.size()];
+
+    {
+      std::lock_guard<std::mutex> scope_lock(worker->lock_);
+      worker->tasks_.push_back(task);
+      impl_->num_queued++;
+    }
+
+    // Wake a sleeping worker
+    {
+      std::lock_guard<std::mutex> scope_lock(impl_->sleep_lock);
+    }
+    impl_->wake.notify_one();
+
+    return true;
+  }
+
+}; //namespace pbop
@@ -23,6 +23,9 @@
  *********************************************************************************/
 
 #include "pbop.h"
+#include "pbop/ScopeLock.h"
+
+#include <set>
 
 namespace pbop
 {
@@ -153,26 +156,68 @@ namespace pbop
     return output;
   }
 
-                                    const google::protobuf::FileDescriptor* AddFileDescriptorToPool(google::protobuf::DescriptorPool & pool, const google::protobuf::FileDescriptor & iFile, bool iIncludeFile)
-{
-  int count = iFile.dependency_count();
-  for(int i=0; i<count; i++)
+  //Add a file and its dependencies to a pool. Each file is visited once: the files already in the pool
+  //and the files that failed to build are not built again, even with diamond shaped imports.
+  static const google::protobuf::FileDescriptor * AddFileDescriptorOnce(google::protobuf::DescriptorPool & pool, const google::protobuf::FileDescriptor & iFile, std::set<const google::protobuf::FileDescriptor *> & visited)
   {
-    const google::protobuf::FileDescriptor * dependency = iFile.dependency(i);
-    AddFileDescriptorToPool(pool, *dependency, true);
-  }
+    if (!visited.insert(&iFile).second)
+      return pool.FindFileByName(iFile.name()); //already visited
+
+    //added by a previous call
+    const google::protobuf::FileDescriptor * existing = pool.FindFileByName(iFile.name());
+    if (existing)
+      return existing;
+
+    int count = iFile.dependency_count();
+    for(int i=0; i<count; i++)
+    {
+      const google::protobuf::FileDescriptor * dependency = iFile.dependency(i);
+      AddFileDescriptorOnce(pool, *dependency, visited);
+    }
 
-  //the file itself
-  if (iIncludeFile)
-  {
+    //the file itself
     google::protobuf::FileDescriptorProto tmpProto;
     iFile.CopyTo(&tmpProto);
     const google::protobuf::FileDescriptor* desc = pool.BuildFile(tmpProto);
     return desc;
   }
 
-  return NULL;
-}
+  const google::protobuf::FileDescriptor* AddFileDescriptorToPool(google::protobuf::DescriptorPool & pool, const google::protobuf::FileDescriptor & iFile, bool iIncludeFile)
+  {
+    std::set<const google::protobuf::FileDescriptor *> visited;
+
+    //the file itself
+    if (iIncludeFile)
+      return AddFileDescriptorOnce(pool, iFile, visited);
+
+    int count = iFile.dependency_count();
+    for(int i=0; i<count; i++)
+    {
+      const google::protobuf::FileDescriptor * dependency = iFile.dependency(i);
+      AddFileDescriptorOnce(pool, *dependency, visited);
+    }
+    return NULL;
+  }
+
+  DescriptorPoolCache::DescriptorPoolCache()
+  {
+  }
+
+  DescriptorPoolCache::~DescriptorPoolCache()
+  {
+  }
+
+  const google::protobuf::FileDescriptor * DescriptorPoolCache::AddFile(const google::protobuf::FileDescriptor & iFile)
+  {
+    ScopeLock lock(&cs_);
+    return AddFileDescriptorToPool(pool_, iFile, true);
+  }
+
+  const google::protobuf::FileDescriptor * DescriptorPoolCache::FindFileByName(const std::string & iName)
+  {
+    ScopeLock lock(&cs_);
+    return pool_.FindFileByName(iName);
+  }
 
   const google::protobuf::FileDescriptor * BuildFileDescriptor(google::protobuf::DescriptorPool & pool, const google::protobuf::FileDescriptorProto & iFileProto)
   {
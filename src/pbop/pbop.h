@@ -42,6 +42,8 @@ __pragma( warning(disable: 4146))
 __pragma( warning(pop) )
 #endif //_WIN32
 
+#include "pbop/CriticalSection.h"
+
 #include <string>
 
 namespace pbop
@@ -74,8 +76,38 @@ namespace pbop
   ///<param name="iFile">The file descriptor to add to the pool.</param>
   ///<param name="iIncludeFile">True if you want to add the given . False if you only need its dependencies</param>
   ///<return>A FileDescriptor * which describes the given FileDescriptor (iFile).</return>
+  ///<remarks>Each file is built only once. The files already in the pool are reused.</remarks>
   const google::protobuf::FileDescriptor * AddFileDescriptorToPool(google::protobuf::DescriptorPool & pool, const google::protobuf::FileDescriptor & iFile, bool iIncludeFile);
 
+  ///<summary>
+  ///A DescriptorPool reused across calls. Each file and each of its dependencies is built only once
+  ///in the pool. The files are never removed from the pool. The class is thread-safe.
+  ///</summary>
+  class DescriptorPoolCache
+  {
+  public:
+    DescriptorPoolCache();
+    ~DescriptorPoolCache();
+  private:
+    DescriptorPoolCache(const DescriptorPoolCache & copy); //disable copy constructor.
+    DescriptorPoolCache & operator =(const DescriptorPoolCache & other); //disable assignment operator.
+  public:
+
+    ///<summary>Add the given FileDescriptor (including its dependencies) to the pool of the cache.</summary>
+    ///<param name="iFile">The file descriptor to add to the pool.</param>
+    ///<return>A FileDescriptor * of the pool which describes the given FileDescriptor (iFile). Returns NULL if the file cannot be built.</return>
+    const google::protobuf::FileDescriptor * AddFile(const google::protobuf::FileDescriptor & iFile);
+
+    ///<summary>Find a file of the pool by its name.</summary>
+    ///<param name="iName">The name of the file.</param>
+    ///<return>A FileDescriptor * of the pool. Returns NULL if the file is not in the pool.</return>
+    const google::protobuf::FileDescriptor * FindFileByName(const std::string & iName);
+
+  private:
+    google::protobuf::DescriptorPool pool_;
+    CriticalSection cs_;
+  };
+
   const google::protobuf::FileDescriptor * BuildFileDescriptor(google::protobuf::DescriptorPool & pool, const google::protobuf::FileDescriptorProto & iFileProto);
 
   const void ToFileDescriptorProto( const google::protobuf::FileDescriptor & iFile, google::protobuf::FileDescriptorProto & oFileProto);
@@ -59,10 +59,23 @@ DebugPrinter::~DebugPrinter()
 }
 
 void DebugPrinter::PrintFile(const FileDescriptor * file, const char * iFilename)
+{
+  std::vector<const FileDescriptor *> files;
+  files.push_back(file);
+  PrintFiles(files, iFilename);
+}
+
+void DebugPrinter::PrintFiles(const std::vector<const FileDescriptor *> & files, const char * iFilename)
 {
   google::protobuf::io::ZeroCopyOutputStream * infoStream = mGenerator->Open(iFilename);
   StreamPrinter info(infoStream); //StreamPrinter takes ownership of the Stream
 
+  for(size_t i=0; i<files.size(); i++)
+    PrintFile(files[i], info);
+}
+
+void DebugPrinter::PrintFile(const FileDescriptor * file, StreamPrinter & info)
+{
   //package
   const std::string & package = file->package();
   info.Print("Found package: %s" NEWLINE, package.c_str());
@@ -78,10 +91,10 @@ void DebugPrinter::PrintFile(const FileDescriptor * file, const char * iFilename
     switch(type)
     {
     case google::protobuf::UnknownField::TYPE_FIXED32:
-      info.Print("Found UnknownField (FIXED32): %d" NEWLINE, field.fixed32());
+      info.Print("Found UnknownField (FIXED32): %u" NEWLINE, field.fixed32());
       break;
     case google::protobuf::UnknownField::TYPE_FIXED64:
-      info.Print("Found UnknownField (FIXED64): %d" NEWLINE, field.fixed64());
+      info.Print("Found UnknownField (FIXED64): %llu" NEWLINE, (unsigned long long)field.fixed64());
       break;
     case google::protobuf::UnknownField::TYPE_GROUP:
       info.Print("Found UnknownField (GROUP): ..." NEWLINE);
@@ -90,7 +103,7 @@ void DebugPrinter::PrintFile(const FileDescriptor * file, const char * iFilename
       info.Print("Found UnknownField (LENGTH_DELIMITED): %s" NEWLINE, field.length_delimited().c_str());
       break;
     case google::protobuf::UnknownField::TYPE_VARINT:
-      info.Print("Found UnknownField (VARINT): %d" NEWLINE, field.varint());
+      info.Print("Found UnknownField (VARINT): %llu" NEWLINE, (unsigned long long)field.varint());
       break;
     //default:
     //  char errorMessage[1024];
@@ -114,7 +127,7 @@ void DebugPrinter::PrintFile(const FileDescriptor * file, const char * iFilename
   for(int i=0; i<numEnumTypes; i++)
   {
     const google::protobuf::EnumDescriptor * d = file->enum_type(i);
-    const std::string fullname = d->full_name();
+    const std::string & fullname = d->full_name();
     const std::string & name = d->name();
     info.Print("Found enum: %s (%s)" NEWLINE, name.c_str(), fullname.c_str());
   }
@@ -125,7 +138,7 @@ void DebugPrinter::PrintFile(const FileDescriptor * file, const char * iFilename
   for(int i=0; i<numExtensions; i++)
   {
     const google::protobuf::FieldDescriptor * d = file->extension(i);
-    const std::string fullname = d->full_name();
+    const std::string & fullname = d->full_name();
     const std::string & name = d->name();
     info.Print("Found extension: %s (%s) typename=%s" NEWLINE, name.c_str(), fullname.c_str(), d->type_name());
 
@@ -155,7 +168,7 @@ void DebugPrinter::PrintFile(const FileDescriptor * file, const char * iFilename
   for(int i=0; i<numMessageTypes; i++)
   {
     const google::protobuf::Descriptor * d = file->message_type(i);
-    const std::string fullname = d->full_name();
+    const std::string & fullname = d->full_name();
     const std::string & name = d->name();
     info.Print("Found message: %s (%s)" NEWLINE, name.c_str(), fullname.c_str());
   }
@@ -164,10 +177,9 @@ void DebugPrinter::PrintFile(const FileDescriptor * file, const char * iFilename
   int numPublicDependencies = file->public_dependency_count();
   for(int i=0; i<numPublicDependencies; i++)
   {
-    const google::protobuf::Descriptor * d = file->message_type(i);
-    const std::string fullname = d->full_name();
+    const google::protobuf::FileDescriptor * d = file->public_dependency(i);
     const std::string & name = d->name();
-    info.Print("Found public dependency: %s (%s)" NEWLINE, name.c_str(), fullname.c_str());
+    info.Print("Found public dependency: %s" NEWLINE, name.c_str());
   }
 
   //services
@@ -175,7 +187,7 @@ void DebugPrinter::PrintFile(const FileDescriptor * file, const char * iFilename
   for(int i=0; i<numServices; i++)
   {
     const google::protobuf::ServiceDescriptor * d = file->service(i);
-    const std::string fullname = d->full_name();
+    const std::string & fullname = d->full_name();
     const std::string & name = d->name();
     info.Print("Found service: %s (%s)" NEWLINE, name.c_str(), fullname.c_str());
     
@@ -184,21 +196,21 @@ void DebugPrinter::PrintFile(const FileDescriptor * file, const char * iFilename
     {
       const google::protobuf::MethodDescriptor * m = d->method(j);
       {
-        const std::string fullname = m->full_name();
+        const std::string & fullname = m->full_name();
         const std::string & name = m->name();
         info.Print("  found method: %s (%s)" NEWLINE, name.c_str(), fullname.c_str());
       }
 
       const google::protobuf::Descriptor * inputDesc = m->input_type();
       {
-        const std::string fullname = inputDesc->full_name();
+        const std::string & fullname = inputDesc->full_name();
         const std::string & name = inputDesc->name();
         info.Print("  input:  %s (%s)" NEWLINE, name.c_str(), fullname.c_str());
       }
 
       const google::protobuf::Descriptor * outputDesc = m->output_type();
       {
-        const std::string fullname = outputDesc->full_name();
+        const std::string & fullname = outputDesc->full_name();
         const std::string & name = outputDesc->name();
         info.Print("  output: %s (%s)" NEWLINE, name.c_str(), fullname.c_str());
       }
@@ -26,6 +26,10 @@
 
 #include <google/protobuf/compiler/code_generator.h>
 
+#include <vector>
+
+class StreamPrinter;
+
 using namespace google::protobuf;
 using namespace google::protobuf::compiler;
 using namespace google::protobuf::io;
@@ -37,7 +41,10 @@ public:
   virtual ~DebugPrinter();
 
   void PrintFile(const FileDescriptor * file, const char * iFilename);
+  void PrintFiles(const std::vector<const FileDescriptor *> & files, const char * iFilename);
 
 private:
+  void PrintFile(const FileDescriptor * file, StreamPrinter & info);
+
   GeneratorContext * mGenerator;
 };
@@ -24,13 +24,19 @@
 
 #include "PluginCodeGenerator.h"
 #include <google/protobuf/compiler/cpp/cpp_generator.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
 
 #include <sstream>  //for std::stringstream
+#include <stdio.h>  //for sprintf
+#include <vector>
+#include <atomic>
 
 #include "StreamPrinter.h"
 #include "DebugPrinter.h"
 #include "pbop.h"
 #include "pbop/version.h"
+#include "pbop/ThreadBase.h"
+#include "pbop/Processors.h"
 
 //for debugging
 #include <Windows.h>
@@ -50,358 +56,744 @@ PluginCodeGenerator::~PluginCodeGenerator()
 {
 }
 
-bool PluginCodeGenerator::GenerateHeader(const google::protobuf::FileDescriptor * file, const std::string & parameter, google::protobuf::compiler::GeneratorContext * generator_context, std::string * error) const
+// Append a value encoded as a protobuf varint to a buffer.
+static void AppendVarint(std::string & buffer, unsigned long long value)
 {
-  const std::string & proto_filename = file->name();
-  const std::string proto_filename_we = pbop::GetFilenameWithoutExtension(proto_filename.c_str());
-  const std::string header_filename = proto_filename_we + ".pbop.pb.h";
-  const std::string cpp_filename = proto_filename_we + ".pbop.pb.cc";
-  const std::string header_guard = "PROTOBUF_" + pbop::Uppercase(proto_filename_we) + "_PBOP_H";
-
-  std::stringstream ss;
-
-  ss << "// Generated by the protocol buffer pbop pluging v" << PBOP_VERSION << ".  DO NOT EDIT!\n";
-  ss << "// https://github.com/end2endzone/protobuf-pbop-plugin\n";
-  ss << "// source: " << proto_filename << "\n";
-  ss << "\n";
-  ss << "#ifndef " << header_guard << "\n";
-  ss << "#define " << header_guard << "\n";
-  ss << "\n";
-  ss << "#include \"" << proto_filename_we << ".pb.h\"\n";
-  ss << "\n";
-  ss << "#include \"pbop/Status.h\"\n";
-  ss << "#include \"pbop/Service.h\"\n";
-  ss << "#include \"pbop/Connection.h\"\n";
-  ss << "\n";
-  ss << "#include <string>\n";
-  ss << "\n";
-  ss << "namespace " << file->package() << " {\n";
-
-
-  //for each services
-  int num_services = file->service_count();
-  for(int i=0; i<num_services; i++)
+  while(value >= 0x80)
   {
-    const google::protobuf::ServiceDescriptor * service = file->service(i);
-    const std::string service_fullname = service->full_name();
-    const std::string & service_name = service->name();
+    buffer += (char)((value & 0x7F) | 0x80);
+    value >>= 7;
+  }
+  buffer += (char)value;
+}
 
-    ss << "  class " << service_name << " {\n";
-    ss << "    public:\n";
-    ss << "    \n";
-    ss << "    class StubInterface {\n";
-    ss << "    public:\n";
-    ss << "      virtual ~StubInterface() {}\n";
+// Append a length-delimited field to a buffer. Empty values are omitted like proto3 does.
+static void AppendLengthDelimitedField(std::string & buffer, int field_number, const std::string & value)
+{
+  if (value.empty())
+    return;
+  AppendVarint(buffer, (field_number << 3) | 2);
+  AppendVarint(buffer, value.size());
+  buffer += value;
+}
 
-    //for each methods
-    int num_methods = service->method_count();
-    for(int j=0; j<num_methods; j++)
+// Returns the serialized `function_identifier` field of a ClientRequest message (see pbop.proto).
+static std::string GetFunctionIdentifierField(const std::string & package, const std::string & service, const std::string & function)
+{
+  std::string identifier;
+  AppendLengthDelimitedField(identifier, 1, package);
+  AppendLengthDelimitedField(identifier, 2, service);
+  AppendLengthDelimitedField(identifier, 3, function);
+
+  std::string field;
+  AppendVarint(field, (1 << 3) | 2);
+  AppendVarint(field, identifier.size());
+  field += identifier;
+  return field;
+}
+
+// Format a buffer as the initializer of a C++ byte array. ie: "0x0a, 0x05, ..."
+static std::string ToCppByteArray(const std::string & buffer)
+{
+  std::string output;
+  char hex[8];
+  for(size_t i=0; i<buffer.size(); i++)
+  {
+    if (i > 0)
+      output += ", ";
+    sprintf(hex, "0x%02x", (unsigned char)buffer[i]);
+    output += hex;
+  }
+  return output;
+}
+
+// Compute the 64-bit FNV-1a hash of a buffer. The hash is stable across platforms and runs.
+static unsigned long long GetHash(const std::string & buffer)
+{
+  unsigned long long hash = 14695981039346656037ULL;
+  for(size_t i=0; i<buffer.size(); i++)
+  {
+    hash ^= (unsigned char)buffer[i];
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+// Format a hash as a fixed width hexadecimal string.
+static std::string ToHexString(unsigned long long hash)
+{
+  char hex[32];
+  sprintf(hex, "%016llx", hash);
+  return hex;
+}
+
+// Returns the subset of a file descriptor that the generated code depends on: the package,
+// the services, the methods and the name of their input and output messages.
+static std::string GetDescriptorSignature(const google::protobuf::FileDescriptor * file)
+{
+  std::string signature;
+  signature += "file " + file->name() + "\n";
+  signature += "package " + file->package() + "\n";
+  for(int i=0; i<file->service_count(); i++)
+  {
+    const google::protobuf::ServiceDescriptor * service = file->service(i);
+    signature += "service " + service->name() + "\n";
+    for(int j=0; j<service->method_count(); j++)
     {
       const google::protobuf::MethodDescriptor * method = service->method(j);
-      const std::string method_fullname = method->full_name();
-      const std::string & method_name = method->name();
+      signature += "method " + method->name() + " " + method->input_type()->full_name() + " " + method->output_type()->full_name() + "\n";
+    }
+  }
+  return signature;
+}
 
-      const google::protobuf::Descriptor * method_input = method->input_type();
-      const std::string method_input_fullname = method_input->full_name();
-      const std::string & method_input_name = method_input->name();
+// Returns the variables of the generated code of each method of a service.
+// The variables are computed once per service and shared by the declarations and the definitions of the service.
+static void GetMethodVariables(const PluginCodeGenerator::Options & options, const PluginCodeGenerator::VariableMap & service_vars, const google::protobuf::ServiceDescriptor * service, std::vector<PluginCodeGenerator::VariableMap> & methods_vars)
+{
+  const int num_methods = service->method_count();
+  methods_vars.assign(num_methods, service_vars);
+  for(int j=0; j<num_methods; j++)
+  {
+    const google::protobuf::MethodDescriptor * method = service->method(j);
+    PluginCodeGenerator::VariableMap & vars = methods_vars[j];
 
-      const google::protobuf::Descriptor * method_output = method->output_type();
-      const std::string method_output_fullname = method_output->full_name();
-      const std::string & method_output_name = method_output->name();
+    char index[32];
+    sprintf(index, "%d", j);
 
-      ss << "      virtual pbop::Status " << method_name << "(const " << method_input_name << " & request, " << method_output_name << " & response) = 0;\n";
+    vars["method_name"] = method->name();
+    vars["method_index"] = index;
+    vars["input_name"] = method->input_type()->name();
+    vars["output_name"] = method->output_type()->name();
+    if (!options.server_only)
+    {
+      const std::string field = GetFunctionIdentifierField(service->file()->package(), service->name(), method->name());
+      vars["identifier_name"] = method->name() + "_identifier";
+      vars["identifier"] = ToCppByteArray(field);
+      vars["descriptor_name"] = method->name() + "_call";
     }
+  }
+}
 
-    ss << "    }; // class StubInterface\n";
-    ss << "  \n";
-    ss << "    class Client : public virtual StubInterface {\n";
-    ss << "    public:\n";
-    ss << "      Client(pbop::Connection * connection);\n";
-    ss << "      virtual ~Client();\n";
+// Print the declaration of the request and response messages of a service method.
+// With the `arena` option, the messages are allocated on an arena which initial block is lent by the calling thread.
+static void PrintMessageDeclarations(const PluginCodeGenerator::Options & options, const PluginCodeGenerator::VariableMap & vars, StreamPrinter & printer)
+{
+  if (options.arena)
+  {
+    printer.Print(vars,
+      "        pbop::ArenaBlock arena_block;\n"
+      "        ::google::protobuf::ArenaOptions arena_options;\n"
+      "        arena_options.initial_block = arena_block.GetBlock();\n"
+      "        arena_options.initial_block_size = arena_block.GetSize();\n"
+      "        ::google::protobuf::Arena arena(arena_options);\n"
+      "        $input_name$ & request = *::google::protobuf::Arena::CreateMessage<$input_name$>(&arena);\n"
+      "        $output_name$ & response = *::google::protobuf::Arena::CreateMessage<$output_name$>(&arena);\n");
+  }
+  else
+  {
+    printer.Print(vars,
+      "        $input_name$ request;\n"
+      "        $output_name$ response;\n");
+  }
+}
 
-    //for each methods
-    for(int j=0; j<num_methods; j++)
-    {
-      const google::protobuf::MethodDescriptor * method = service->method(j);
-      const std::string method_fullname = method->full_name();
-      const std::string & method_name = method->name();
+// Print the CallDescriptor of the client methods in range [method_begin, method_end).
+static void PrintCallDescriptors(const PluginCodeGenerator::VariableMap & service_vars, const std::vector<PluginCodeGenerator::VariableMap> & methods_vars, size_t method_begin, size_t method_end, StreamPrinter & printer)
+{
+  // The names are nested in a namespace per service. Names built by joining the service and method names could collide.
+  printer.Print(service_vars,
+    "\n"
+    "  // Serialized function_identifier field of the ClientRequest and CallDescriptor of each method.\n"
+    "  namespace pbop_calls {\n"
+    "  namespace $service_name$ {\n");
+
+  //for each methods
+  for(size_t j=method_begin; j<method_end; j++)
+  {
+    printer.Print(methods_vars[j],
+      "    static const unsigned char $identifier_name$[] = { $identifier$ };\n"
+      "    static const CallDescriptor $descriptor_name$ = { \"$method_name$\", $identifier_name$, sizeof($identifier_name$) };\n");
+  }
+
+  printer.Print(service_vars,
+    "  }; //namespace $service_name$\n"
+    "  }; //namespace pbop_calls\n");
+}
+
+// Print the definition of the client methods in range [method_begin, method_end).
+static void PrintClientMethods(const std::vector<PluginCodeGenerator::VariableMap> & methods_vars, size_t method_begin, size_t method_end, StreamPrinter & printer)
+{
+  //for each methods
+  for(size_t j=method_begin; j<method_end; j++)
+  {
+    printer.Print(methods_vars[j],
+      "  Status $service_name$::Client::$method_name$(const $input_name$ & request, $output_name$ & response)\n"
+      "  {\n"
+      "    if (direct_)\n"
+      "    {\n"
+      "      TraceScope trace(TRACE_PHASE_CLIENT_CALL, 0, \"$method_name$\");\n"
+      "      if (!copy_messages_)\n"
+      "      {\n"
+      "        response.Clear();\n"
+      "        return direct_->$method_name$(request, response);\n"
+      "      }\n"
+      "      $input_name$ request_copy(request);\n"
+      "      $output_name$ response_copy;\n"
+      "      Status status = direct_->$method_name$(request_copy, response_copy);\n"
+      "      if (status.Success())\n"
+      "        response.Swap(&response_copy);\n"
+      "      return status;\n"
+      "    }\n"
+      "    \n"
+      "    return ClientCall(connection_, pbop_calls::$service_name$::$descriptor_name$, request, response);\n"
+      "  }\n"
+      "  \n");
+  }
+}
 
-      const google::protobuf::Descriptor * method_input = method->input_type();
-      const std::string method_input_fullname = method_input->full_name();
-      const std::string & method_input_name = method_input->name();
+// Print the beginning of a source file: the includes up to the opening of the namespace of the package.
+static void PrintSourcePrologue(const PluginCodeGenerator::Options & options, const PluginCodeGenerator::VariableMap & file_vars, StreamPrinter & printer)
+{
+  printer.Print(file_vars,
+    "// Generated by the protocol buffer pbop pluging v$version$.  DO NOT EDIT!\n"
+    "// https://github.com/end2endzone/protobuf-pbop-plugin\n"
+    "// source: $proto_filename$\n"
+    "\n"
+    "#include \"$proto_filename_we$.pbop.pb.h\"\n");
+  if (!options.server_only)
+  {
+    printer.Print(file_vars,
+      "#include \"pbop/ClientCall.h\"\n"
+      "#include \"pbop/TraceRecorder.h\"\n"
+      "#include \"pbop/InProcessConnection.h\"\n");
+  }
+  if (options.arena && !options.client_only)
+    printer.Print(file_vars, "#include <google/protobuf/arena.h>\n");
+  printer.Print(file_vars,
+    "\n"
+    "using namespace ::pbop;\n"
+    "\n"
+    "namespace $package$ {\n");
+}
 
-      const google::protobuf::Descriptor * method_output = method->output_type();
-      const std::string method_output_fullname = method_output->full_name();
-      const std::string & method_output_name = method_output->name();
+// Parse a strictly positive decimal number.
+static bool ParseCount(const std::string & value, size_t & count)
+{
+  if (value.empty() || value.size() > 9)
+    return false;
+  count = 0;
+  for(size_t i=0; i<value.size(); i++)
+  {
+    if (value[i] < '0' || value[i] > '9')
+      return false;
+    count = count * 10 + (value[i] - '0');
+  }
+  return (count > 0);
+}
 
-      ss << "      virtual pbop::Status " << method_name << "(const " << method_input_name << " & request, " << method_output_name << " & response);\n";
+bool PluginCodeGenerator::ParseOptions(const std::string & parameter, Options & options, std::string * error) const
+{
+  options.crtp = false;
+  options.manifest = false;
+  options.debug = false;
+  options.client_only = false;
+  options.server_only = false;
+  options.no_virtual = false;
+  options.arena = false;
+  options.split_services = false;
+  options.methods_per_file = 0;
+
+  std::vector<std::pair<std::string, std::string> > pairs;
+  google::protobuf::compiler::ParseGeneratorParameter(parameter, &pairs);
+  for(size_t i=0; i<pairs.size(); i++)
+  {
+    const std::string & name = pairs[i].first;
+    const std::string & value = pairs[i].second;
+
+    if (name == "crtp" && value.empty())
+      options.crtp = true;
+    else if (name == "manifest" && value.empty())
+      options.manifest = true;
+    else if (name == "debug" && value.empty())
+      options.debug = true;
+    else if (name == "client_only" && value.empty())
+      options.client_only = true;
+    else if (name == "server_only" && value.empty())
+      options.server_only = true;
+    else if (name == "no_virtual" && value.empty())
+      options.no_virtual = true;
+    else if (name == "arena" && value.empty())
+      options.arena = true;
+    else if (name == "split_services" && value.empty())
+      options.split_services = true;
+    else if (name == "methods_per_file")
+    {
+      if (!ParseCount(value, options.methods_per_file))
+      {
+        if (error)
+          *error = "Generator option methods_per_file expects a positive number of methods: " + name + "=" + value;
+        return false;
+      }
+      options.split_services = true;
+    }
+    else
+    {
+      if (error)
+        *error = "Unknown generator option: " + name + (value.empty() ? "" : "=" + value);
+      return false;
     }
+  }
 
-    ss << "    private:\n";
-    ss << "      pbop::Status ProcessCall(const char * name, const ::google::protobuf::Message & request, ::google::protobuf::Message & response);\n";
-    ss << "      pbop::Connection * connection_;\n";
-    ss << "    }; // class Client\n";
-    ss << "    \n";
-    ss << "    class Service : public virtual StubInterface, public virtual pbop::Service {\n";
-    ss << "    public:\n";
-    ss << "      Service();\n";
-    ss << "      virtual ~Service();\n";
-    ss << "      virtual const char * GetPackageName() const;\n";
-    ss << "      virtual const char * GetServiceName() const;\n";
-    ss << "      virtual const char ** GetFunctionIdentifiers() const;\n";
-    ss << "      virtual pbop::Status InvokeMethod(const size_t & index, const std::string & input, std::string & output);\n";
+  if (options.client_only && options.server_only)
+  {
+    if (error)
+      *error = "Generator options client_only and server_only are mutually exclusive.";
+    return false;
+  }
+  if (options.client_only && options.crtp)
+  {
+    if (error)
+      *error = "Generator option crtp generates server code and cannot be used with client_only.";
+    return false;
+  }
 
-    //for each methods
-    for(int j=0; j<num_methods; j++)
+  return true;
+}
+
+void PluginCodeGenerator::GenerateServiceTemplate(const Options & options, const VariableMap & service_vars, const std::vector<VariableMap> & methods_vars, StreamPrinter & printer) const
+{
+  const size_t num_methods = methods_vars.size();
+
+  printer.Print(service_vars,
+    "    /// <summary>\n"
+    "    /// Service implementation with a static dispatch of the methods.\n"
+    "    /// The implementation class derives from ServiceT<Impl> and hides the methods it implements with non-virtual functions.\n"
+    "    /// ie: class MyImpl : public ServiceT<MyImpl> { public: pbop::Status Method(const Request & request, Response & response); };\n"
+    "    /// </summary>\n"
+    "    template <class Impl>\n"
+    "    class ServiceT : public pbop::Service {\n"
+    "    public:\n"
+    "      ServiceT() {}\n"
+    "      virtual ~ServiceT() {}\n"
+    "      virtual const char * GetPackageName() const { return \"$package$\"; }\n"
+    "      virtual const char * GetServiceName() const { return \"$service_name$\"; }\n"
+    "      virtual const char ** GetFunctionIdentifiers() const {\n"
+    "        static const char * identifiers[] = {\n");
+  for(size_t j=0; j<num_methods; j++)
+  {
+    printer.Print(methods_vars[j],
+      "          \"$method_name$\",\n");
+  }
+  printer.Print(service_vars,
+    "          NULL\n"
+    "        };\n"
+    "        return identifiers;\n"
+    "      }\n"
+    "      virtual pbop::Status InvokeMethod(const size_t & index, const std::string & input, std::string & output) {\n");
+  if (num_methods > 0)
+  {
+    printer.Print(service_vars,
+      "        typedef pbop::Status (*Handler)(Impl & impl, const std::string & input, std::string & output);\n"
+      "        static constexpr Handler handlers[] = {\n");
+    for(size_t j=0; j<num_methods; j++)
     {
-      const google::protobuf::MethodDescriptor * method = service->method(j);
-      const std::string method_fullname = method->full_name();
-      const std::string & method_name = method->name();
+      printer.Print(methods_vars[j],
+        "          &ServiceT::Invoke$method_name$,\n");
+    }
+    printer.Print(service_vars,
+      "        };\n"
+      "        if (index < sizeof(handlers) / sizeof(handlers[0]))\n"
+      "          return handlers[index](static_cast<Impl &>(*this), input, output);\n");
+  }
+  printer.Print(service_vars,
+    "        return pbop::Status(pbop::STATUS_CODE_NOT_IMPLEMENTED, \"Function at index \" + std::to_string((unsigned long long)index) + \" is not implemented.\");\n"
+    "      }\n");
+
+  //for each methods
+  for(size_t j=0; j<num_methods; j++)
+  {
+    printer.Print(methods_vars[j],
+      "      inline pbop::Status $method_name$(const $input_name$ & request, $output_name$ & response) { return pbop::Status::Factory::NotImplemented(__FUNCTION__); }\n");
+  }
+
+  if (num_methods > 0)
+    printer.Print(service_vars, "    private:\n");
+
+  //for each methods
+  for(size_t j=0; j<num_methods; j++)
+  {
+    const VariableMap & vars = methods_vars[j];
+    printer.Print(vars,
+      "      static pbop::Status Invoke$method_name$(Impl & impl, const std::string & input, std::string & output) {\n");
+    PrintMessageDeclarations(options, vars, printer);
+    printer.Print(vars,
+      "        bool success = request.ParseFromString(input);\n"
+      "        if (!success)\n"
+      "          return pbop::Status::Factory::Deserialization(__FUNCTION__, request);\n"
+      "        pbop::Status status = impl.$method_name$(request, response);\n"
+      "        if (!status.Success())\n"
+      "          return status;\n"
+      "        success = response.SerializeToString(&output);\n"
+      "        if (!success)\n"
+      "          return pbop::Status::Factory::Serialization(__FUNCTION__, response);\n"
+      "        return pbop::Status::OK;\n"
+      "      }\n");
+  }
 
-      const google::protobuf::Descriptor * method_input = method->input_type();
-      const std::string method_input_fullname = method_input->full_name();
-      const std::string & method_input_name = method_input->name();
+  printer.Print(service_vars,
+    "    };  // class ServiceT\n"
+    "  \n");
+}
+
+void PluginCodeGenerator::GenerateServiceHeader(const Options & options, const VariableMap & service_vars, const std::vector<VariableMap> & methods_vars, StreamPrinter & printer) const
+{
+  const size_t num_methods = methods_vars.size();
+
+  printer.Print(service_vars,
+    "  class $service_name$ {\n"
+    "    public:\n"
+    "    \n"
+    "    class StubInterface {\n"
+    "    public:\n"
+    "      virtual ~StubInterface() {}\n");
+
+  //for each methods
+  for(size_t j=0; j<num_methods; j++)
+  {
+    printer.Print(methods_vars[j],
+      "      virtual pbop::Status $method_name$(const $input_name$ & request, $output_name$ & response) = 0;\n");
+  }
 
-      const google::protobuf::Descriptor * method_output = method->output_type();
-      const std::string method_output_fullname = method_output->full_name();
-      const std::string & method_output_name = method_output->name();
+  printer.Print(service_vars,
+    "    }; // class StubInterface\n"
+    "  \n");
 
-      ss << "      inline pbop::Status " << method_name << "(const " << method_input_name << " & request, " << method_output_name << " & response) { return pbop::Status::Factory::NotImplemented(__FUNCTION__); }\n";
+  if (!options.server_only)
+  {
+    // With the no_virtual option, the client does not implement StubInterface and its methods are not virtual.
+    if (options.no_virtual)
+      printer.Print(service_vars, "    class Client {\n");
+    else
+      printer.Print(service_vars, "    class Client : public virtual StubInterface {\n");
+    printer.Print(service_vars,
+      "    public:\n"
+      "      Client(pbop::Connection * connection);\n"
+      "      $client_virtual$~Client();\n");
+
+    //for each methods
+    for(size_t j=0; j<num_methods; j++)
+    {
+      printer.Print(methods_vars[j],
+        "      $client_virtual$pbop::Status $method_name$(const $input_name$ & request, $output_name$ & response);\n");
     }
 
-    ss << "    };  // class Service\n";
-    ss << "  \n";
-    ss << "  }; // class " << service_name << "\n";
+    printer.Print(service_vars,
+      "    private:\n"
+      "      pbop::Connection * connection_;\n"
+      "      StubInterface * direct_; // service implementation of an in-process connection\n"
+      "      bool copy_messages_;\n"
+      "    }; // class Client\n"
+      "    \n");
   }
 
-  ss << "}; //namespace " << file->package() << "\n";
-  ss << "\n";
-  ss << "#endif //" << header_guard << "\n";
+  if (!options.client_only)
+  {
+    printer.Print(service_vars,
+      "    class Service : public virtual StubInterface, public virtual pbop::Service {\n"
+      "    public:\n"
+      "      Service();\n"
+      "      virtual ~Service();\n"
+      "      virtual const char * GetPackageName() const;\n"
+      "      virtual const char * GetServiceName() const;\n"
+      "      virtual const char ** GetFunctionIdentifiers() const;\n"
+      "      virtual pbop::Status InvokeMethod(const size_t & index, const std::string & input, std::string & output);\n");
 
+    //for each methods
+    for(size_t j=0; j<num_methods; j++)
+    {
+      printer.Print(methods_vars[j],
+        "      inline pbop::Status $method_name$(const $input_name$ & request, $output_name$ & response) { return pbop::Status::Factory::NotImplemented(__FUNCTION__); }\n");
+    }
 
-  //output to header file
-  google::protobuf::io::ZeroCopyOutputStream * stream = generator_context->Open(header_filename.c_str());
-  StreamPrinter printer(stream); //StreamPrinter takes ownership of the Stream
-  const std::string buffer = ss.str();
-  printer.Print(buffer.c_str(), buffer.size());
+    printer.Print(service_vars,
+      "    };  // class Service\n"
+      "  \n");
 
-  return true;
+    if (options.crtp)
+      GenerateServiceTemplate(options, service_vars, methods_vars, printer);
+  }
+
+  printer.Print(service_vars,
+    "  }; // class $service_name$\n");
 }
 
-bool PluginCodeGenerator::GenerateSource(const google::protobuf::FileDescriptor * file, const std::string & parameter, google::protobuf::compiler::GeneratorContext * generator_context, std::string * error) const
+void PluginCodeGenerator::GenerateServiceSource(const Options & options, const VariableMap & service_vars, const std::vector<VariableMap> & methods_vars, StreamPrinter & printer) const
 {
-  const std::string & proto_filename = file->name();
-  const std::string proto_filename_we = pbop::GetFilenameWithoutExtension(proto_filename.c_str());
-  const std::string header_filename = proto_filename_we + ".pbop.pb.h";
-  const std::string cpp_filename = proto_filename_we + ".pbop.pb.cc";
-  const std::string header_guard = "PROTOBUF_" + pbop::Uppercase(proto_filename_we) + "_PBOP_H";
+  const size_t num_methods = methods_vars.size();
 
-  std::stringstream ss;
+  // With the methods_per_file option, the remaining client methods are defined by GenerateServiceSourcePart()
+  size_t num_client_methods = num_methods;
+  if (options.methods_per_file > 0 && options.methods_per_file < num_methods)
+    num_client_methods = options.methods_per_file;
 
-  ss << "// Generated by the protocol buffer pbop pluging v" << PBOP_VERSION << ".  DO NOT EDIT!\n";
-  ss << "// https://github.com/end2endzone/protobuf-pbop-plugin\n";
-  ss << "// source: " << proto_filename << "\n";
-  ss << "\n";
-  ss << "#include \"" << proto_filename_we << ".pbop.pb.h\"\n";
-  ss << "#include \"pbop/pbop.pb.h\"\n";
-  ss << "\n";
-  ss << "using namespace ::pbop;\n";
-  ss << "\n";
-  ss << "namespace " << file->package() << " {\n";
+  if (!options.server_only)
+  {
+    PrintCallDescriptors(service_vars, methods_vars, 0, num_client_methods, printer);
+
+    printer.Print(service_vars,
+      "  \n"
+      "  $service_name$::Client::Client(Connection * connection) : connection_(connection), direct_(NULL), copy_messages_(false) {\n"
+      "    // Call the service implementation directly if the server lives in the same process\n"
+      "    InProcessConnection * in_process = dynamic_cast<InProcessConnection *>(connection);\n"
+      "    if (in_process)\n"
+      "    {\n"
+      "      direct_ = dynamic_cast<StubInterface *>(in_process->FindService(\"$package$\", \"$service_name$\"));\n"
+      "      copy_messages_ = in_process->IsCopyMessages();\n"
+      "    }\n"
+      "  }\n"
+      "  \n"
+      "  $service_name$::Client::~Client() {\n"
+      "    if (connection_)\n"
+      "      delete connection_;\n"
+      "    connection_ = NULL;\n"
+      "  }\n"
+      "  \n");
+
+    PrintClientMethods(methods_vars, 0, num_client_methods, printer);
+  }
 
-  //for each services
-  int num_services = file->service_count();
-  for(int i=0; i<num_services; i++)
+  if (!options.client_only)
   {
-    const google::protobuf::ServiceDescriptor * service = file->service(i);
-    const std::string service_fullname = service->full_name();
-    const std::string & service_name = service->name();
-    
-    ss << "\n";
-    ss << "  " << service_name << "::Client::Client(Connection * connection) : connection_(connection) {\n";
-    ss << "  }\n";
-    ss << "  \n";
-    ss << "  " << service_name << "::Client::~Client() {\n";
-    ss << "    if (connection_)\n";
-    ss << "      delete connection_;\n";
-    ss << "    connection_ = NULL;\n";
-    ss << "  }\n";
-    ss << "  \n";
+    printer.Print(service_vars,
+      "  $service_name$::Service::Service() {\n"
+      "  }\n"
+      "  \n"
+      "  $service_name$::Service::~Service() {\n"
+      "  }\n"
+      "  \n"
+      "  const char * $service_name$::Service::GetPackageName() const {\n"
+      "    return \"$package$\";\n"
+      "  }\n"
+      "  \n"
+      "  const char * $service_name$::Service::GetServiceName() const {\n"
+      "    return \"$service_name$\";\n"
+      "  }\n"
+      "  \n"
+      "  const char ** $service_name$::Service::GetFunctionIdentifiers() const {\n"
+      "    static const char * identifiers[] = {\n");
 
     //for each methods
-    int num_methods = service->method_count();
-    for(int j=0; j<num_methods; j++)
+    for(size_t j=0; j<num_methods; j++)
     {
-      const google::protobuf::MethodDescriptor * method = service->method(j);
-      const std::string method_fullname = method->full_name();
-      const std::string & method_name = method->name();
-
-      const google::protobuf::Descriptor * method_input = method->input_type();
-      const std::string method_input_fullname = method_input->full_name();
-      const std::string & method_input_name = method_input->name();
-
-      const google::protobuf::Descriptor * method_output = method->output_type();
-      const std::string method_output_fullname = method_output->full_name();
-      const std::string & method_output_name = method_output->name();
-
-      ss << "  Status " << service_name << "::Client::" << method_name << "(const " << method_input_name << " & request, " << method_output_name << " & response)\n";
-      ss << "  {\n";
-      ss << "    Status status = ProcessCall(\"" << method_name << "\", request, response);\n";
-      ss << "    return status;\n";
-      ss << "  }\n";
-      ss << "  \n";
+      printer.Print(methods_vars[j],
+        "      \"$method_name$\",\n");
     }
 
-    ss << "  Status " << service_name << "::Client::ProcessCall(const char * name, const ::google::protobuf::Message & request, ::google::protobuf::Message & response)\n";
-    ss << "  {\n";
-    ss << "    ClientRequest client_message;\n";
-    ss << "    \n";
-    ss << "    //function_identifier\n";
-    ss << "    client_message.mutable_function_identifier()->set_package(\"" << file->package() << "\");\n";
-    ss << "    client_message.mutable_function_identifier()->set_service(\"" << service_name << "\");\n";
-    ss << "    client_message.mutable_function_identifier()->set_function_name(name);\n";
-    ss << "    \n";
-    ss << "    // Serialize the request message into ClientRequest\n";
-    ss << "    bool success = request.SerializeToString(client_message.mutable_request_buffer());\n";
-    ss << "    if (!success)\n";
-    ss << "      return Status::Factory::Serialization(__FUNCTION__, request);\n";
-    ss << "    \n";
-    ss << "    // Serialize the client_message ready for sending to the connection\n";
-    ss << "    std::string write_buffer;\n";
-    ss << "    success = client_message.SerializeToString(&write_buffer);\n";
-    ss << "    if (!success)\n";
-    ss << "      return Status::Factory::Serialization(__FUNCTION__, request);\n";
-    ss << "    \n";
-    ss << "    // Send\n";
-    ss << "    Status status = connection_->Write(write_buffer);\n";
-    ss << "    if (!status.Success())\n";
-    ss << "      return status;\n";
-    ss << "    \n";
-    ss << "    // Wait for a response.\n";
-    ss << "    std::string read_buffer;\n";
-    ss << "    status = connection_->Read(read_buffer);\n";
-    ss << "    if (!status.Success())\n";
-    ss << "      return status;\n";
-    ss << "    \n";
-    ss << "    // Deserialize server's response\n";
-    ss << "    ServerResponse server_response;\n";
-    ss << "    success = server_response.ParseFromString(read_buffer);\n";
-    ss << "    if (!success)\n";
-    ss << "      return Status::Factory::Deserialization(__FUNCTION__, server_response);\n";
-    ss << "    \n";
-    ss << "    // Read server status\n";
-    ss << "    if (!server_response.has_status())\n";
-    ss << "      return Status::Factory::MissingField(__FUNCTION__, \"status\", server_response);\n";
-    ss << "    \n";
-    ss << "    // Convert StatusMessage to Status\n";
-    ss << "    status.SetCode( static_cast<StatusCode>(server_response.status().code()) );\n";
-    ss << "    status.SetDescription(server_response.status().description());\n";
-    ss << "    if (!status.Success())\n";
-    ss << "      return status;\n";
-    ss << "    \n";
-    ss << "    // Deserialize response message\n";
-    ss << "    response.ParseFromString(server_response.response_buffer());\n";
-    ss << "    if (!success)\n";
-    ss << "      return Status::Factory::Deserialization(__FUNCTION__, response);\n";
-    ss << "    \n";
-    ss << "    // Success\n";
-    ss << "    return Status::OK;\n";
-    ss << "  }\n";
-    ss << "  \n";
-    ss << "  " << service_name << "::Service::Service() {\n";
-    ss << "  }\n";
-    ss << "  \n";
-    ss << "  " << service_name << "::Service::~Service() {\n";
-    ss << "  }\n";
-    ss << "  \n";
-    ss << "  const char * " << service_name << "::Service::GetPackageName() const {\n";
-    ss << "    return \"" << file->package() << "\";\n";
-    ss << "  }\n";
-    ss << "  \n";
-    ss << "  const char * " << service_name << "::Service::GetServiceName() const {\n";
-    ss << "    return \"" << service_name << "\";\n";
-    ss << "  }\n";
-    ss << "  \n";
-    ss << "  const char ** " << service_name << "::Service::GetFunctionIdentifiers() const {\n";
-    ss << "    static const char * identifiers[] = {\n";
+    printer.Print(service_vars,
+      "      NULL\n"
+      "    };\n"
+      "    return identifiers;\n"
+      "  }\n"
+      "  \n"
+      "  pbop::Status $service_name$::Service::InvokeMethod(const size_t & index, const std::string & input, std::string & output) {\n"
+      "    switch(index)\n"
+      "    {\n");
 
     //for each methods
-    for(int j=0; j<num_methods; j++)
+    for(size_t j=0; j<num_methods; j++)
     {
-      const google::protobuf::MethodDescriptor * method = service->method(j);
-      const std::string method_fullname = method->full_name();
-      const std::string & method_name = method->name();
+      const VariableMap & vars = methods_vars[j];
+      printer.Print(vars,
+        "    case $method_index$:\n"
+        "      {\n");
+      PrintMessageDeclarations(options, vars, printer);
+      printer.Print(vars,
+        "        bool success = request.ParseFromString(input);\n"
+        "        if (!success)\n"
+        "          return Status::Factory::Deserialization(__FUNCTION__, request);\n"
+        "        Status status = this->$method_name$(request, response);\n"
+        "        if (!status.Success())\n"
+        "          return status;\n"
+        "        success = response.SerializeToString(&output);\n"
+        "        if (!success)\n"
+        "          return Status::Factory::Serialization(__FUNCTION__, response);\n"
+        "      }\n"
+        "      break;\n");
+    }
 
-      const google::protobuf::Descriptor * method_input = method->input_type();
-      const std::string method_input_fullname = method_input->full_name();
-      const std::string & method_input_name = method_input->name();
+    printer.Print(service_vars,
+      "    default:\n"
+      "      //Not implemented\n"
+      "      return Status(STATUS_CODE_NOT_IMPLEMENTED, \"Function at index \" + std::to_string((unsigned long long)index) + \" is not implemented.\");\n"
+      "    };\n"
+      "    \n"
+      "    return Status::OK;\n"
+      "  }\n");
+  }
 
-      const google::protobuf::Descriptor * method_output = method->output_type();
-      const std::string method_output_fullname = method_output->full_name();
-      const std::string & method_output_name = method_output->name();
+  printer.Print(service_vars, "  \n");
+}
 
-      ss << "      \"" << method_name << "\",\n";
-    }
-    ss << "      NULL\n";
-    ss << "    };\n";
-    ss << "    return identifiers;\n";
-    ss << "  }\n";
-    ss << "  \n";
-    ss << "  pbop::Status " << service_name << "::Service::InvokeMethod(const size_t & index, const std::string & input, std::string & output) {\n";
-    ss << "    switch(index)\n";
-    ss << "    {\n";
+void PluginCodeGenerator::GenerateServiceSourcePart(const Options & options, const VariableMap & service_vars, const std::vector<VariableMap> & methods_vars, size_t method_begin, size_t method_end, StreamPrinter & printer) const
+{
+  // The server side of the service is always defined in the first source file of the service
+  if (!options.server_only)
+  {
+    PrintCallDescriptors(service_vars, methods_vars, method_begin, method_end, printer);
+    printer.Print(service_vars, "  \n");
+    PrintClientMethods(methods_vars, method_begin, method_end, printer);
+  }
+}
 
-    //for each methods
-    for(int j=0; j<num_methods; j++)
+void PluginCodeGenerator::GenerateFile(const google::protobuf::FileDescriptor * file, const Options & options, GeneratedFile & output) const
+{
+  const std::string & proto_filename = file->name();
+  const std::string proto_filename_we = pbop::GetFilenameWithoutExtension(proto_filename.c_str());
+  const std::string header_filename = proto_filename_we + ".pbop.pb.h";
+  const std::string cpp_filename = proto_filename_we + ".pbop.pb.cc";
+
+  VariableMap file_vars;
+  file_vars["version"] = PBOP_VERSION;
+  file_vars["proto_filename"] = proto_filename;
+  file_vars["proto_filename_we"] = proto_filename_we;
+  file_vars["header_guard"] = "PROTOBUF_" + pbop::Uppercase(proto_filename_we) + "_PBOP_H";
+  file_vars["package"] = file->package();
+
+  output.header_filename = header_filename;
+  output.header.clear();
+  output.source_filename = cpp_filename;
+  output.source.clear();
+  output.service_sources.clear();
+
+  // The printers write directly to the output strings. The
+  // content of the strings is final once the printers are destroyed.
+  {
+    StreamPrinter header(new google::protobuf::io::StringOutputStream(&output.header)); //StreamPrinter takes ownership of the Stream
+    StreamPrinter source(new google::protobuf::io::StringOutputStream(&output.source));
+
+    header.Print(file_vars,
+      "// Generated by the protocol buffer pbop pluging v$version$.  DO NOT EDIT!\n"
+      "// https://github.com/end2endzone/protobuf-pbop-plugin\n"
+      "// source: $proto_filename$\n"
+      "\n"
+      "#ifndef $header_guard$\n"
+      "#define $header_guard$\n"
+      "\n"
+      "#include \"$proto_filename_we$.pb.h\"\n"
+      "\n"
+      "#include \"pbop/Status.h\"\n");
+    if (!options.client_only)
+      header.Print(file_vars, "#include \"pbop/Service.h\"\n");
+    if (options.arena && !options.client_only)
+      header.Print(file_vars, "#include \"pbop/ArenaBlock.h\"\n");
+    if (!options.server_only)
+      header.Print(file_vars, "#include \"pbop/Connection.h\"\n");
+    header.Print(file_vars,
+      "\n"
+      "#include <string>\n"
+      "\n"
+      "namespace $package$ {\n");
+
+    PrintSourcePrologue(options, file_vars, source);
+
+    //for each services, output the declarations and the definitions at once
+    VariableMap service_vars = file_vars;
+    service_vars["client_virtual"] = (options.no_virtual ? "" : "virtual ");
+    std::vector<VariableMap> methods_vars;
+    int num_services = file->service_count();
+    for(int i=0; i<num_services; i++)
     {
-      const google::protobuf::MethodDescriptor * method = service->method(j);
-      const std::string method_fullname = method->full_name();
-      const std::string & method_name = method->name();
-
-      const google::protobuf::Descriptor * method_input = method->input_type();
-      const std::string method_input_fullname = method_input->full_name();
-      const std::string & method_input_name = method_input->name();
-
-      const google::protobuf::Descriptor * method_output = method->output_type();
-      const std::string method_output_fullname = method_output->full_name();
-      const std::string & method_output_name = method_output->name();
-
-      ss << "    case " << j << ":\n";
-      ss << "      {\n";
-      ss << "        " << method_input_name << " request;\n";
-      ss << "        " << method_output_name << " response;\n";
-      ss << "        bool success = request.ParseFromString(input);\n";
-      ss << "        if (!success)\n";
-      ss << "          return Status::Factory::Deserialization(__FUNCTION__, request);\n";
-      ss << "        Status status = this->" << method_name << "(request, response);\n";
-      ss << "        if (!status.Success())\n";
-      ss << "          return status;\n";
-      ss << "        success = response.SerializeToString(&output);\n";
-      ss << "        if (!success)\n";
-      ss << "          return Status::Factory::Serialization(__FUNCTION__, response);\n";
-      ss << "      }\n";
-      ss << "      break;\n";
+      const google::protobuf::ServiceDescriptor * service = file->service(i);
+      service_vars["service_name"] = service->name();
+      GetMethodVariables(options, service_vars, service, methods_vars);
+
+      GenerateServiceHeader(options, service_vars, methods_vars, header);
+      if (!options.split_services)
+      {
+        GenerateServiceSource(options, service_vars, methods_vars, source);
+        continue;
+      }
+
+      // Output the definitions of the service to its own source files. ie: `name.pbop.Service.pb.cc`, `name.pbop.Service.1.pb.cc`, ...
+      // Only the client methods are split with the methods_per_file option.
+      const size_t num_methods = methods_vars.size();
+      size_t num_parts = 1;
+      if (options.methods_per_file > 0 && !options.server_only && num_methods > options.methods_per_file)
+        num_parts = (num_methods + options.methods_per_file - 1) / options.methods_per_file;
+      for(size_t part=0; part<num_parts; part++)
+      {
+        std::string filename = proto_filename_we + ".pbop." + service->name();
+        if (part > 0)
+        {
+          char index[32];
+          sprintf(index, ".%u", (unsigned int)part);
+          filename += index;
+        }
+        filename += ".pb.cc";
+
+        output.service_sources.push_back(std::pair<std::string, std::string>(filename, std::string()));
+        StreamPrinter service_source(new google::protobuf::io::StringOutputStream(&output.service_sources.back().second));
+
+        PrintSourcePrologue(options, file_vars, service_source);
+        if (part == 0)
+          GenerateServiceSource(options, service_vars, methods_vars, service_source);
+        else
+        {
+          const size_t method_begin = part * options.methods_per_file;
+          const size_t method_end = (method_begin + options.methods_per_file < num_methods ? method_begin + options.methods_per_file : num_methods);
+          GenerateServiceSourcePart(options, service_vars, methods_vars, method_begin, method_end, service_source);
+        }
+        service_source.Print(file_vars,
+          "}; //namespace $package$\n");
+      }
     }
 
-    ss << "    default:\n";
-    ss << "      //Not implemented\n";
-    ss << "      return Status(STATUS_CODE_NOT_IMPLEMENTED, \"Function at index \" + std::to_string((unsigned long long)index) + \" is not implemented.\");\n";
-    ss << "    };\n";
-    ss << "    \n";
-    ss << "    return Status::OK;\n";
-    ss << "  }\n";
-    ss << "  \n";
+    header.Print(file_vars,
+      "}; //namespace $package$\n"
+      "\n"
+      "#endif //$header_guard$\n");
+
+    source.Print(file_vars,
+      "}; //namespace $package$\n");
   }
-  ss << "}; //namespace " << file->package() << "\n";
 
+  if (options.manifest)
+  {
+    // The descriptor hash also covers the plugin version and the options that change the generated code.
+    std::string signature;
+    signature += "version " PBOP_VERSION "\n";
+    signature += std::string("crtp ") + (options.crtp ? "1" : "0") + "\n";
+    signature += std::string("client_only ") + (options.client_only ? "1" : "0") + "\n";
+    signature += std::string("server_only ") + (options.server_only ? "1" : "0") + "\n";
+    signature += std::string("no_virtual ") + (options.no_virtual ? "1" : "0") + "\n";
+    signature += std::string("arena ") + (options.arena ? "1" : "0") + "\n";
+    signature += std::string("split_services ") + (options.split_services ? "1" : "0") + "\n";
+    signature += "methods_per_file " + std::to_string((unsigned long long)options.methods_per_file) + "\n";
+    signature += GetDescriptorSignature(file);
+
+    std::stringstream manifest;
+    manifest << "# Generated by the protocol buffer pbop pluging v" << PBOP_VERSION << ".  DO NOT EDIT!\n";
+    manifest << "# source: " << proto_filename << "\n";
+    manifest << "descriptor " << ToHexString(GetHash(signature)) << "\n";
+    manifest << header_filename << " " << ToHexString(GetHash(output.header)) << "\n";
+    manifest << cpp_filename << " " << ToHexString(GetHash(output.source)) << "\n";
+    for(size_t i=0; i<output.service_sources.size(); i++)
+      manifest << output.service_sources[i].first << " " << ToHexString(GetHash(output.service_sources[i].second)) << "\n";
+
+    output.manifest_filename = proto_filename_we + ".pbop.manifest";
+    output.manifest = manifest.str();
+  }
 
-  //output to cpp file
-  google::protobuf::io::ZeroCopyOutputStream * stream = generator_context->Open(cpp_filename.c_str());
-  StreamPrinter printer(stream); //StreamPrinter takes ownership of the Stream
-  const std::string buffer = ss.str();
-  printer.Print(buffer.c_str(), buffer.size());
+  output.success = true;
+}
 
-  return true;
+// Write the content of a generated file to the output of protoc.
+static void WriteFile(google::protobuf::compiler::GeneratorContext * generator_context, const std::string & filename, const std::string & content)
+{
+  google::protobuf::io::ZeroCopyOutputStream * stream = generator_context->Open(filename.c_str());
+  StreamPrinter printer(stream); //StreamPrinter takes ownership of the Stream
+  printer.Print(content);
 }
 
 bool PluginCodeGenerator::Generate(const google::protobuf::FileDescriptor * file, const std::string & parameter, google::protobuf::compiler::GeneratorContext * generator_context, string * error) const
@@ -414,24 +806,118 @@ bool PluginCodeGenerator::Generate(const google::protobuf::FileDescriptor * file
   int a = 0;
 #endif
 
-  // Debug content of the file
-  DebugPrinter debugger(generator_context);
-  debugger.PrintFile(file, "debug.txt");
+  std::vector<const google::protobuf::FileDescriptor *> files;
+  files.push_back(file);
+  return GenerateAll(files, parameter, generator_context, error);
+}
 
-  // Header file
-  bool success = GenerateHeader(file, parameter, generator_context, error);
-  if (!success)
-    return false;
+/// <summary>
+/// Thread that generates the files of a GenerateAll() call.
+/// The threads share the index of the next file to generate.
+/// </summary>
+class GeneratorThread : public pbop::ThreadBase
+{
+public:
+  GeneratorThread(const PluginCodeGenerator * generator, const PluginCodeGenerator::Options & options, const std::vector<const google::protobuf::FileDescriptor *> & files, std::vector<PluginCodeGenerator::GeneratedFile> & outputs, std::atomic<size_t> & next_index) :
+    generator_(generator),
+    options_(options),
+    files_(files),
+    outputs_(outputs),
+    next_index_(next_index)
+  {
+  }
+  virtual ~GeneratorThread()
+  {
+  }
+
+protected:
+  virtual unsigned long Execute()
+  {
+    size_t index = next_index_.fetch_add(1);
+    while(index < files_.size())
+    {
+      generator_->GenerateFile(files_[index], options_, outputs_[index]);
+      index = next_index_.fetch_add(1);
+    }
+    return 0;
+  }
 
-  // Source file
-  success = GenerateSource(file, parameter, generator_context, error);
+private:
+  const PluginCodeGenerator * generator_;
+  const PluginCodeGenerator::Options & options_;
+  const std::vector<const google::protobuf::FileDescriptor *> & files_;
+  std::vector<PluginCodeGenerator::GeneratedFile> & outputs_;
+  std::atomic<size_t> & next_index_;
+};
+
+bool PluginCodeGenerator::GenerateAll(const std::vector<const google::protobuf::FileDescriptor *> & files, const std::string & parameter, google::protobuf::compiler::GeneratorContext * generator_context, string * error) const
+{
+  // Parse generator options
+  Options options;
+  bool success = ParseOptions(parameter, options, error);
   if (!success)
     return false;
 
-  if (error)
+  // Generate the files concurrently. The descriptors are read-only and each
+  // thread outputs to its own GeneratedFile. The GeneratorContext is not thread-safe
+  // and is only used by this thread.
+  std::vector<GeneratedFile> outputs(files.size());
+  std::atomic<size_t> next_index(0);
+
+  size_t num_threads = pbop::GetProcessorCount();
+  if (num_threads > files.size())
+    num_threads = files.size();
+
+  std::vector<GeneratorThread *> threads;
+  for(size_t i=1; i<num_threads; i++)
+  {
+    GeneratorThread * thread = new GeneratorThread(this, options, files, outputs, next_index);
+    thread->SetName("pbop::GeneratorThread");
+    if (thread->Start().Success())
+      threads.push_back(thread);
+    else
+      delete thread;
+  }
+
+  // Debug content of the files
+  if (options.debug)
+  {
+    DebugPrinter debugger(generator_context);
+    debugger.PrintFiles(files, "debug.txt");
+  }
+
+  // This thread also generates files until all files are processed
+  size_t index = next_index.fetch_add(1);
+  while(index < files.size())
+  {
+    GenerateFile(files[index], options, outputs[index]);
+    index = next_index.fetch_add(1);
+  }
+
+  for(size_t i=0; i<threads.size(); i++)
   {
-    std::string & e = (*error);
-    //e = "unknown error";
+    threads[i]->Join();
+    delete threads[i];
+  }
+  threads.clear();
+
+  // Output the files in the order of the given file descriptors
+  for(size_t i=0; i<outputs.size(); i++)
+  {
+    const GeneratedFile & output = outputs[i];
+    if (!output.success)
+    {
+      if (error)
+        *error = output.error;
+      return false;
+    }
+
+    WriteFile(generator_context, output.header_filename, output.header);
+    WriteFile(generator_context, output.source_filename, output.source);
+    for(size_t j=0; j<output.service_sources.size(); j++)
+      WriteFile(generator_context, output.service_sources[j].first, output.service_sources[j].second);
+    if (!output.manifest_filename.empty())
+      WriteFile(generator_context, output.manifest_filename, output.manifest);
   }
 
   return true;
@@ -28,14 +28,69 @@
 #include <google/protobuf/compiler/code_generator.h>
 #include <google/protobuf/io/zero_copy_stream.h>
 
+#include <vector>
+#include <utility> //for std::pair
+
+#include "StreamPrinter.h"
+
 class PluginCodeGenerator : public google::protobuf::compiler::CodeGenerator
 {
 public:
   PluginCodeGenerator();
   virtual ~PluginCodeGenerator();
 
+  /// <summary>
+  /// Options of the generator. Options are specified with the parameter of the `--pbop_out` command line argument.
+  /// ie: `--pbop_out=crtp:<output_directory>`
+  /// </summary>
+  struct Options
+  {
+    bool crtp; // Also generate a ServiceT<Impl> template with a static dispatch table.
+    bool manifest; // Also generate a manifest file with the hash of the descriptor and of the generated files.
+    bool debug; // Also output the content of the proto files to debug.txt.
+    bool client_only; // Only generate the client side of the services.
+    bool server_only; // Only generate the server side of the services.
+    bool no_virtual; // Generate clients which methods are not virtual.
+    bool arena; // Allocate the messages of the server side on an arena.
+    bool split_services; // Output the definitions of each service to its own source file.
+    size_t methods_per_file; // Maximum number of client methods per source file of a service. Implies split_services. 0 for no maximum.
+  };
+
+  /// <summary>
+  /// Variables of the generated code. A variable `$name$` in a template is replaced by its value.
+  /// </summary>
+  typedef StreamPrinter::VariableMap VariableMap;
+
   virtual bool Generate(const google::protobuf::FileDescriptor * file, const std::string & parameter, google::protobuf::compiler::GeneratorContext * generator_context, std::string * error) const;
+
+  /// <summary>
+  /// Generates the code of multiple files. The files are generated concurrently, one thread per processor.
+  /// </summary>
+  virtual bool GenerateAll(const std::vector<const google::protobuf::FileDescriptor *> & files, const std::string & parameter, google::protobuf::compiler::GeneratorContext * generator_context, std::string * error) const;
 private:
-  bool GenerateHeader(const google::protobuf::FileDescriptor * file, const std::string & parameter, google::protobuf::compiler::GeneratorContext * generator_context, std::string * error) const;
-  bool GenerateSource(const google::protobuf::FileDescriptor * file, const std::string & parameter, google::protobuf::compiler::GeneratorContext * generator_context, std::string * error) const;
+  friend class GeneratorThread;
+
+  /// <summary>
+  /// The generated content of a proto file.
+  /// </summary>
+  struct GeneratedFile
+  {
+    GeneratedFile() : success(false) {}
+    bool success;
+    std::string error;
+    std::string header_filename;
+    std::string header;
+    std::string source_filename;
+    std::string source;
+    std::vector<std::pair<std::string, std::string> > service_sources; // filename and content of the source files of the services with the split_services option
+    std::string manifest_filename; // empty if no manifest is generated
+    std::string manifest;
+  };
+
+  bool ParseOptions(const std::string & parameter, Options & options, std::string * error) const;
+  void GenerateFile(const google::protobuf::FileDescriptor * file, const Options & options, GeneratedFile & output) const;
+  void GenerateServiceHeader(const Options & options, const VariableMap & service_vars, const std::vector<VariableMap> & methods_vars, StreamPrinter & printer) const;
+  void GenerateServiceSource(const Options & options, const VariableMap & service_vars, const std::vector<VariableMap> & methods_vars, StreamPrinter & printer) const;
+  void GenerateServiceSourcePart(const Options & options, const VariableMap & service_vars, const std::vector<VariableMap> & methods_vars, size_t method_begin, size_t method_end, StreamPrinter & printer) const;
+  void GenerateServiceTemplate(const Options & options, const VariableMap & service_vars, const std::vector<VariableMap> & methods_vars, StreamPrinter & printer) const;
 };
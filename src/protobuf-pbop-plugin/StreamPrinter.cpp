@@ -24,12 +24,14 @@
 
 #include "StreamPrinter.h"
 
-#include "pbop.h"
-
 #include <stdarg.h>
+#include <stdio.h>   //for vsnprintf
+#include <string.h>  //for memcpy
 
 StreamPrinter::StreamPrinter(google::protobuf::io::ZeroCopyOutputStream * iStream) :
-  mStream(iStream)
+  mStream(iStream),
+  mBuffer(NULL),
+  mBufferSize(0)
 {
 }
 
@@ -37,89 +39,164 @@ StreamPrinter::~StreamPrinter()
 {
   if (mStream)
   {
+    //return the unused bytes to the stream
+    if (mBufferSize > 0)
+      mStream->BackUp(mBufferSize);
     delete mStream;
     mStream = NULL;
   }
 }
 
-void StreamPrinter::Print(const unsigned char * iValue, size_t iLength)
+void StreamPrinter::Write(const char * iValue, size_t iLength)
 {
-  size_t dumpIndex = 0;
-
-  while(dumpIndex < iLength)
+  while(iLength > 0)
   {
-    //get a buffer from the stream
-    void * buffer = NULL;
-    int bufferSize = 0;
-    mStream->Next(&buffer, &bufferSize);
-
-    if (buffer && bufferSize > 0)
+    //get a new buffer from the stream
+    if (mBufferSize <= 0)
     {
-      //compute dumpsize
-      size_t dumpSize = iLength - dumpIndex;
-      if ((int)dumpSize > bufferSize)
-        dumpSize = bufferSize;
-
-      //dump
-      const unsigned char * dumpData = &iValue[dumpIndex];
-      memcpy(buffer, dumpData, dumpSize);
-
-      if ((int)dumpSize < bufferSize)
+      void * buffer = NULL;
+      if (!mStream->Next(&buffer, &mBufferSize))
       {
-        int backupSize = bufferSize - dumpSize;
-        mStream->BackUp(backupSize);
+        mBufferSize = 0;
+        return;
       }
-
-      dumpIndex += dumpSize;
+      mBuffer = (char *)buffer;
+      continue;
     }
+
+    //compute dumpsize
+    size_t dumpSize = iLength;
+    if (dumpSize > (size_t)mBufferSize)
+      dumpSize = mBufferSize;
+
+    //dump
+    memcpy(mBuffer, iValue, dumpSize);
+    mBuffer += dumpSize;
+    mBufferSize -= (int)dumpSize;
+    iValue += dumpSize;
+    iLength -= dumpSize;
   }
 }
 
-void StreamPrinter::Print(const std::string & iValue)
+void StreamPrinter::WriteText(const char * iValue, size_t iLength)
 {
 #ifdef _WIN32
   //replace \n by \r\n
-  static const std::string & windows_newline = "\r\n";
-  static const std::string & unix_newline = "\n";
+  const char * end = iValue + iLength;
+  while(iValue < end)
+  {
+    const char * newline = (const char *)memchr(iValue, '\n', end - iValue);
+    if (newline == NULL)
+    {
+      Write(iValue, end - iValue);
+      return;
+    }
+    Write(iValue, newline - iValue);
+    Write("\r\n", 2);
+    iValue = newline + 1;
+  }
+#else
+  //use directly
+  Write(iValue, iLength);
+#endif
+}
+
+void StreamPrinter::Print(const unsigned char * iValue, size_t iLength)
+{
+  Write((const char *)iValue, iLength);
+}
 
+void StreamPrinter::Print(const std::string & iValue)
+{
+#ifdef _WIN32
   //is the given buffer already properly formatted ?
-  if (iValue.find(windows_newline) != std::string::npos)
+  if (iValue.find("\r\n") != std::string::npos)
   {
     //the given buffer already have \r\n format
-    Print( (unsigned char *)iValue.c_str(), iValue.size() );
+    Write(iValue.c_str(), iValue.size());
+    return;
   }
-  else if (iValue.find(unix_newline) != std::string::npos)
-  {
-    //must replace \n by \r\n
-    std::string tmp = iValue;
-    pbop::Replace(tmp, unix_newline, windows_newline);
-    Print( (unsigned char *)tmp.c_str(), tmp.size() );
-  }
-  else
-  {
-    //no newline in given buffer, use as-is
-    Print( (unsigned char *)iValue.c_str(), iValue.size() );
-  }
-#else
-  //use directly
-  print( (unsigned char *)iValue.c_str(), iValue.size() );
 #endif
+  WriteText(iValue.c_str(), iValue.size());
 }
 
 void StreamPrinter::Print(const char * iFormat, ...)
 {
-  std::string s;
+  //get a buffer from the stream
+  while(mBufferSize <= 0)
+  {
+    void * buffer = NULL;
+    if (!mStream->Next(&buffer, &mBufferSize))
+    {
+      mBufferSize = 0;
+      return;
+    }
+    mBuffer = (char *)buffer;
+  }
 
+  //format directly into the buffer of the stream
   va_list args;
   va_start(args, iFormat);
+  int length = vsnprintf(mBuffer, mBufferSize, iFormat, args);
+  va_end(args);
 
-  static const int BUFFER_SIZE = 102400;
-  char buffer[BUFFER_SIZE];
-  buffer[0] = '\0';
-  vsprintf_s(buffer, BUFFER_SIZE, iFormat, args);
-  s = buffer;
+  if (length < 0)
+  {
+    //formatting error
+    return;
+  }
+  if (length < mBufferSize)
+  {
+    //keep the unused bytes (including the terminating null character) for the next call
+    mBuffer += length;
+    mBufferSize -= length;
+    return;
+  }
 
-  va_end (args);
+  //the formatted string does not fit in the buffer of the stream
+  std::string s(length + 1, '\0');
+  va_start(args, iFormat);
+  vsnprintf(&s[0], s.size(), iFormat, args);
+  va_end(args);
+  Write(s.c_str(), length);
+}
 
-  Print(s);
+void StreamPrinter::Print(const VariableMap & iVariables, const char * iTemplate)
+{
+  const char * cursor = iTemplate;
+  while(*cursor != '\0')
+  {
+    //write the text up to the next variable
+    const char * begin = strchr(cursor, '$');
+    if (begin == NULL)
+    {
+      WriteText(cursor, strlen(cursor));
+      return;
+    }
+    WriteText(cursor, begin - cursor);
+
+    const char * end = strchr(begin + 1, '$');
+    if (end == NULL)
+    {
+      //unterminated variable, use as-is
+      WriteText(begin, strlen(begin));
+      return;
+    }
+
+    if (end == begin + 1)
+    {
+      //escaped delimiter
+      Write("$", 1);
+    }
+    else
+    {
+      const std::string name(begin + 1, end);
+      VariableMap::const_iterator variable = iVariables.find(name);
+      if (variable != iVariables.end())
+        Write(variable->second.c_str(), variable->second.size());
+      else
+        Write(begin, end + 1 - begin); //unknown variable, use as-is
+    }
+    cursor = end + 1;
+  }
 }
@@ -26,17 +26,40 @@
 
 #include <google/protobuf/io/zero_copy_stream.h>
 
+#include <map>
+#include <string>
+
 class StreamPrinter
 {
 public:
+  // Variables of a template. A variable `$name$` in a template is replaced by its value.
+  typedef std::map<std::string, std::string> VariableMap;
+
   StreamPrinter(google::protobuf::io::ZeroCopyOutputStream * iStream);
   virtual ~StreamPrinter();
 
+  // Write a buffer to the stream as is.
   void Print(const unsigned char * iValue, size_t iLength);
+
+  // Write a string to the stream. On Windows, new lines are converted to \r\n.
   void Print(const std::string & iValue);
+
+  // Write a formatted string directly into the buffer of the stream. New lines are not converted.
   void Print(const char * iFormat, ...);
 
+  // Write a template directly into the buffer of the stream replacing each `$name$` by the value of the variable.
+  // `$$` is written as a single `$`. On Windows, new lines of the template are converted to \r\n.
+  void Print(const VariableMap & iVariables, const char * iTemplate);
+
+private:
+  void Write(const char * iValue, size_t iLength);
+  void WriteText(const char * iValue, size_t iLength);
+
 private:
   google::protobuf::io::ZeroCopyOutputStream * mStream;
 
+  // The unused part of the last buffer returned by the stream.
+  // The buffer is kept between calls and returned to the stream when the printer is destroyed.
+  char * mBuffer;
+  int mBufferSize;
 };
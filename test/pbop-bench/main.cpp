@@ -0,0 +1,651 @@
+/**********************************************************************************
+ * MIT License
+ * 
+ * Copyright (c) 2018 Antoine Beauchamp
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+// pbop-bench: measures the latency and throughput of pbop calls.
+//
+// The benchmark sweeps the following dimensions:
+//   * transport:    the type of connection between the clients and the server.
+//   * method mix:   which service methods are called by the clients.
+//   * payload size: the size of the bytes field of each request.
+//   * client count: the number of concurrent clients, each with its own connection.
+//
+// With --workers, the calls of all methods are scheduled and executed by the server's workers.
+//
+// Each scenario runs for a fixed duration. The latency of every call is recorded in a
+// LatencyHistogram and the results are written as a JSON document that can be stored
+// and compared across releases.
+//
+// Usage:
+//   pbop-bench [--output=<file>] [--trace=<file>] [--duration=<ms>] [--warmup=<ms>] [--workers=<n>]
+//              [--transports=pipe,loopback,inprocess] [--mixes=empty,echo,sink,mixed]
+//              [--payloads=0,64,1024,16384,262144] [--clients=1,2,4,8] [--quick]
+
+#include "pbop/Server.h"
+#include "pbop/PipeConnection.h"
+#include "pbop/LoopbackConnection.h"
+#include "pbop/InProcessConnection.h"
+#include "pbop/Thread.h"
+#include "pbop/ThreadBuilder.h"
+#include "pbop/LatencyHistogram.h"
+#include "pbop/TraceRecorder.h"
+#include "pbop/version.h"
+
+#include "pbop/Timing.h"
+
+#ifdef _WIN32
+//google/protobuf/io/coded_stream.h(869): warning C4800: 'google::protobuf::internal::Atomic32' : forcing value to bool 'true' or 'false' (performance warning)
+//google/protobuf/wire_format_lite.h(863): warning C4146: unary minus operator applied to unsigned type, result still unsigned
+//google/protobuf/wire_format_lite.h(874): warning C4146: unary minus operator applied to unsigned type, result still unsigned
+//google/protobuf/generated_message_util.h(160): warning C4800: 'const google::protobuf::uint32' : forcing value to bool 'true' or 'false' (performance warning)
+__pragma( warning(push) )
+__pragma( warning(disable: 4800))
+__pragma( warning(disable: 4146))
+#endif //_WIN32
+
+#include "Benchmark.pb.h"
+#include "Benchmark.pbop.pb.h"
+
+#ifdef _WIN32
+__pragma( warning(pop) )
+#endif //_WIN32
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <thread>
+
+using namespace pbop;
+
+static const char * MIX_EMPTY = "empty";
+static const char * MIX_ECHO  = "echo";
+static const char * MIX_SINK  = "sink";
+static const char * MIX_MIXED = "mixed";
+
+static const char * TRANSPORT_PIPE      = "pipe";
+static const char * TRANSPORT_LOOPBACK  = "loopback";
+static const char * TRANSPORT_INPROCESS = "inprocess";
+
+struct BenchOptions
+{
+  std::string output;
+  std::string trace;
+  unsigned int duration_ms;
+  unsigned int warmup_ms;
+  unsigned int num_workers;
+  std::vector<std::string> transports;
+  std::vector<std::string> mixes;
+  std::vector<size_t> payloads;
+  std::vector<size_t> clients;
+};
+
+struct ScenarioResult
+{
+  std::string transport;
+  std::string mix;
+  size_t payload_size;
+  size_t num_clients;
+  unsigned long long errors;
+  unsigned long long bytes;
+  double elapsed_seconds;
+  LatencyHistogram latency;
+};
+
+class BenchServiceImpl : public benchmark::Bench::Service
+{
+public:
+  BenchServiceImpl() {}
+  virtual ~BenchServiceImpl() {}
+
+  pbop::Status Empty(const benchmark::EmptyRequest & request, benchmark::EmptyResponse & response)
+  {
+    return pbop::Status::OK;
+  }
+
+  pbop::Status Echo(const benchmark::PayloadRequest & request, benchmark::PayloadResponse & response)
+  {
+    response.set_payload(request.payload());
+    return pbop::Status::OK;
+  }
+
+  pbop::Status Sink(const benchmark::PayloadRequest & request, benchmark::EmptyResponse & response)
+  {
+    return pbop::Status::OK;
+  }
+};
+
+class BenchServer
+{
+public:
+  Server server;
+  std::string address;
+
+  BenchServer() {}
+  ~BenchServer() {}
+
+  unsigned long Run()
+  {
+    Status status = server.Run(address.c_str());
+    if (!status.Success())
+    {
+      fprintf(stderr, "Server error: %d, %s\n", status.GetCode(), status.GetDescription().c_str());
+      return status.GetCode();
+    }
+    return 0;
+  }
+};
+
+bool IsTransportSupported(const std::string & transport)
+{
+  if (transport == TRANSPORT_PIPE)
+  {
+#ifdef _WIN32
+    return true;
+#else
+    return false; // Named pipes are only implemented on Windows
+#endif
+  }
+
+  // Other transports are attached to a server started without a pipe
+  return (transport == TRANSPORT_LOOPBACK ||
+          transport == TRANSPORT_INPROCESS);
+}
+
+std::string GetServerAddress(const std::string & transport)
+{
+  // Only the pipe transport requires the server to listen
+  if (transport == TRANSPORT_PIPE)
+    return "\\\\.\\pipe\\pbop-bench";
+  return "";
+}
+
+Connection * CreateClientConnection(const std::string & transport, const std::string & address, Server * server, Status & status)
+{
+  if (transport == TRANSPORT_PIPE)
+  {
+    PipeConnection * connection = new PipeConnection();
+    status = connection->Connect(address.c_str());
+    if (!status.Success())
+    {
+      delete connection;
+      return NULL;
+    }
+    return connection;
+  }
+  if (transport == TRANSPORT_LOOPBACK)
+  {
+    LoopbackConnection * client_connection = NULL;
+    LoopbackConnection * server_connection = NULL;
+    LoopbackConnection::CreatePair(&client_connection, &server_connection);
+    status = server->AddConnection(server_connection);
+    if (!status.Success())
+    {
+      delete client_connection;
+      delete server_connection;
+      return NULL;
+    }
+    return client_connection;
+  }
+  if (transport == TRANSPORT_INPROCESS)
+  {
+    status = Status::OK;
+    return new InProcessConnection(server);
+  }
+
+  status = Status(STATUS_CODE_NOT_IMPLEMENTED, "Transport '" + transport + "' is not supported.");
+  return NULL;
+}
+
+class BenchClient
+{
+public:
+  std::string transport;
+  std::string address;
+  Server * server;
+  std::string mix;
+  size_t payload_size;
+  unsigned long long warmup_ns;
+  unsigned long long duration_ns;
+  std::atomic<bool> * start_flag;
+
+  LatencyHistogram latency;
+  unsigned long long errors;
+  unsigned long long bytes;
+
+  BenchClient() :
+    server(NULL),
+    payload_size(0),
+    warmup_ns(0),
+    duration_ns(0),
+    start_flag(NULL),
+    errors(0),
+    bytes(0)
+  {
+  }
+
+  unsigned long Run()
+  {
+    Status status;
+    Connection * connection = CreateClientConnection(transport, address, server, status);
+    if (connection == NULL)
+    {
+      fprintf(stderr, "Client error: %d, %s\n", status.GetCode(), status.GetDescription().c_str());
+      errors++;
+      return status.GetCode();
+    }
+
+    benchmark::Bench::Client client(connection);
+
+    benchmark::EmptyRequest empty_request;
+    benchmark::EmptyResponse empty_response;
+    benchmark::PayloadRequest payload_request;
+    benchmark::PayloadResponse payload_response;
+    payload_request.set_payload(std::string(payload_size, 'x'));
+
+    //Wait for the start signal
+    while(!start_flag->load())
+    {
+      std::this_thread::yield();
+    }
+
+    const unsigned long long start_time = GetMonotonicTime();
+    const unsigned long long measure_time = start_time + warmup_ns;
+    const unsigned long long end_time = measure_time + duration_ns;
+    unsigned long long now = start_time;
+    size_t call_index = 0;
+
+    while(now < end_time)
+    {
+      //Select the method to call according to the mix
+      size_t call_bytes = 0;
+      const unsigned long long call_start = GetMonotonicTime();
+      if (mix == MIX_EMPTY || (mix == MIX_MIXED && call_index % 4 == 0))
+      {
+        status = client.Empty(empty_request, empty_response);
+      }
+      else if (mix == MIX_ECHO || (mix == MIX_MIXED && call_index % 4 == 1))
+      {
+        status = client.Echo(payload_request, payload_response);
+        call_bytes = payload_size * 2;
+      }
+      else
+      {
+        status = client.Sink(payload_request, empty_response);
+        call_bytes = payload_size;
+      }
+      now = GetMonotonicTime();
+      call_index++;
+
+      if (now < measure_time)
+        continue; //warming up
+
+      if (!status.Success())
+      {
+        errors++;
+        continue;
+      }
+      latency.Record(now - call_start);
+      bytes += call_bytes;
+    }
+
+    // The connection is deleted by the client
+    return 0;
+  }
+};
+
+bool RunScenario(const BenchOptions & options, const std::string & address, Server * server, ScenarioResult & result)
+{
+  std::atomic<bool> start_flag(false);
+
+  std::vector<BenchClient *> clients;
+  std::vector<Thread *> threads;
+  for(size_t i=0; i<result.num_clients; i++)
+  {
+    BenchClient * client = new BenchClient();
+    client->transport = result.transport;
+    client->address = address;
+    client->server = server;
+    client->mix = result.mix;
+    client->payload_size = result.payload_size;
+    client->warmup_ns = (unsigned long long)options.warmup_ms * 1000000ULL;
+    client->duration_ns = (unsigned long long)options.duration_ms * 1000000ULL;
+    client->start_flag = &start_flag;
+    clients.push_back(client);
+    threads.push_back(new ThreadBuilder<BenchClient>(client, &BenchClient::Run));
+  }
+
+  bool success = true;
+  for(size_t i=0; i<threads.size(); i++)
+  {
+    Status status = threads[i]->Start();
+    if (!status.Success())
+    {
+      fprintf(stderr, "Failed to start client thread: %s\n", status.GetDescription().c_str());
+      success = false;
+    }
+  }
+
+  //Give time to all clients to connect
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  const unsigned long long start_time = GetMonotonicTime();
+  start_flag = true;
+  for(size_t i=0; i<threads.size(); i++)
+  {
+    threads[i]->Join();
+  }
+  const unsigned long long end_time = GetMonotonicTime();
+
+  //The measured time excludes the warmup period
+  const unsigned long long elapsed_ns = end_time - start_time;
+  const unsigned long long warmup_ns = (unsigned long long)options.warmup_ms * 1000000ULL;
+  result.elapsed_seconds = (elapsed_ns > warmup_ns ? elapsed_ns - warmup_ns : elapsed_ns) / 1000000000.0;
+  result.errors = 0;
+  result.bytes = 0;
+  result.latency.Reset();
+  for(size_t i=0; i<clients.size(); i++)
+  {
+    result.latency.Merge(clients[i]->latency);
+    result.errors += clients[i]->errors;
+    result.bytes += clients[i]->bytes;
+    delete threads[i];
+    delete clients[i];
+  }
+
+  return success;
+}
+
+std::string EscapeJson(const std::string & value)
+{
+  std::string escaped;
+  char buffer[16];
+  for(size_t i=0; i<value.size(); i++)
+  {
+    const unsigned char c = (unsigned char)value[i];
+    if (c == '"' || c == '\\')
+    {
+      escaped += '\\';
+      escaped += (char)c;
+    }
+    else if (c < 0x20)
+    {
+      sprintf(buffer, "\\u%04x", (unsigned int)c);
+      escaped += buffer;
+    }
+    else
+      escaped += (char)c;
+  }
+  return escaped;
+}
+
+std::string ToJson(const BenchOptions & options, const std::vector<ScenarioResult *> & results)
+{
+  std::string json;
+  char buffer[1024];
+
+  json += "{\n";
+  json += "  \"version\": \"" + EscapeJson(PBOP_VERSION) + "\",\n";
+  sprintf(buffer, "  \"duration_ms\": %u,\n  \"warmup_ms\": %u,\n  \"workers\": %u,\n", options.duration_ms, options.warmup_ms, options.num_workers);
+  json += buffer;
+  json += "  \"latency_unit\": \"ns\",\n";
+  json += "  \"scenarios\": [\n";
+  for(size_t i=0; i<results.size(); i++)
+  {
+    const ScenarioResult & r = *results[i];
+    double calls_per_second = (r.elapsed_seconds > 0.0 ? r.latency.GetCount() / r.elapsed_seconds : 0.0);
+    double bytes_per_second = (r.elapsed_seconds > 0.0 ? r.bytes / r.elapsed_seconds : 0.0);
+    json += "    {\"transport\": \"" + EscapeJson(r.transport) + "\", \"mix\": \"" + EscapeJson(r.mix) + "\", ";
+    sprintf(buffer, "\"payload_size\": %u, \"clients\": %u, \"calls\": %llu, \"errors\": %llu, \"elapsed_seconds\": %.3f, \"calls_per_second\": %.1f, \"bytes_per_second\": %.1f, \"latency\": ",
+      (unsigned int)r.payload_size,
+      (unsigned int)r.num_clients,
+      r.latency.GetCount(),
+      r.errors,
+      r.elapsed_seconds,
+      calls_per_second,
+      bytes_per_second);
+    json += buffer;
+    json += r.latency.ToJson();
+    json += "}";
+    if (i + 1 < results.size())
+      json += ",";
+    json += "\n";
+  }
+  json += "  ]\n";
+  json += "}\n";
+  return json;
+}
+
+std::vector<std::string> SplitString(const char * value)
+{
+  std::vector<std::string> values;
+  std::string current;
+  for(const char * c = value; *c != '\0'; c++)
+  {
+    if (*c == ',')
+    {
+      if (!current.empty())
+        values.push_back(current);
+      current.clear();
+    }
+    else
+      current += *c;
+  }
+  if (!current.empty())
+    values.push_back(current);
+  return values;
+}
+
+std::vector<size_t> SplitNumbers(const char * value)
+{
+  std::vector<size_t> numbers;
+  std::vector<std::string> values = SplitString(value);
+  for(size_t i=0; i<values.size(); i++)
+  {
+    numbers.push_back((size_t)strtoul(values[i].c_str(), NULL, 10));
+  }
+  return numbers;
+}
+
+bool ParseArgument(const char * arg, const char * name, const char ** value)
+{
+  size_t length = strlen(name);
+  if (strncmp(arg, name, length) == 0 && arg[length] == '=')
+  {
+    *value = arg + length + 1;
+    return true;
+  }
+  return false;
+}
+
+int main(int argc, char **argv)
+{
+  BenchOptions options;
+  options.duration_ms = 1000;
+  options.warmup_ms = 100;
+  options.num_workers = 0;
+  options.transports = SplitString(TRANSPORT_PIPE);
+  options.mixes = SplitString("empty,echo,sink,mixed");
+  options.payloads = SplitNumbers("0,64,1024,16384,262144");
+  options.clients = SplitNumbers("1,2,4,8");
+
+  for(int i=1; i<argc; i++)
+  {
+    const char * arg = argv[i];
+    const char * value = NULL;
+    if (strcmp(arg, "--quick") == 0)
+    {
+      options.duration_ms = 200;
+      options.warmup_ms = 20;
+      options.mixes = SplitString("empty,echo");
+      options.payloads = SplitNumbers("0,1024");
+      options.clients = SplitNumbers("1,4");
+    }
+    else if (ParseArgument(arg, "--output", &value))
+      options.output = value;
+    else if (ParseArgument(arg, "--trace", &value))
+      options.trace = value;
+    else if (ParseArgument(arg, "--duration", &value))
+      options.duration_ms = (unsigned int)strtoul(value, NULL, 10);
+    else if (ParseArgument(arg, "--warmup", &value))
+      options.warmup_ms = (unsigned int)strtoul(value, NULL, 10);
+    else if (ParseArgument(arg, "--workers", &value))
+      options.num_workers = (unsigned int)strtoul(value, NULL, 10);
+    else if (ParseArgument(arg, "--transports", &value))
+      options.transports = SplitString(value);
+    else if (ParseArgument(arg, "--mixes", &value))
+      options.mixes = SplitString(value);
+    else if (ParseArgument(arg, "--payloads", &value))
+      options.payloads = SplitNumbers(value);
+    else if (ParseArgument(arg, "--clients", &value))
+      options.clients = SplitNumbers(value);
+    else
+    {
+      fprintf(stderr, "Unknown argument: %s\n", arg);
+      fprintf(stderr, "Usage: pbop-bench [--output=<file>] [--trace=<file>] [--duration=<ms>] [--warmup=<ms>] [--workers=<n>] [--transports=pipe,loopback,inprocess] [--mixes=empty,echo,sink,mixed] [--payloads=0,64,...] [--clients=1,2,...] [--quick]\n");
+      return 1;
+    }
+  }
+
+  // Record a trace of all calls
+  if (!options.trace.empty())
+    TraceRecorder::Enable(TraceRecorder::DEFAULT_CAPACITY);
+
+  std::vector<ScenarioResult *> results;
+  bool success = true;
+  for(size_t t=0; t<options.transports.size(); t++)
+  {
+    const std::string & transport = options.transports[t];
+    if (!IsTransportSupported(transport))
+    {
+      fprintf(stderr, "Transport '%s' is not supported on this platform.\n", transport.c_str());
+      success = false;
+      continue;
+    }
+    const std::string address = GetServerAddress(transport);
+
+    //Start a server for this transport
+    BenchServer bench_server;
+    bench_server.address = address;
+    bench_server.server.SetWorkerCount(options.num_workers);
+    if (options.num_workers > 0)
+    {
+      //workers only execute the calls of scheduled methods. Schedule all methods without limiting their concurrency.
+      Server::MethodOptions method_options;
+      method_options.max_concurrency = 0;
+      method_options.priority = Server::PRIORITY_NORMAL;
+      bench_server.server.SetMethodOptions("benchmark", "Bench", NULL, method_options);
+    }
+    bench_server.server.RegisterService(new BenchServiceImpl());
+    ThreadBuilder<BenchServer> server_thread(&bench_server, &BenchServer::Run);
+    Status status;
+    if (address.empty())
+      status = bench_server.server.Start(); // no pipe, the server does not need a listening thread
+    else
+      status = server_thread.Start();
+    if (!status.Success())
+    {
+      fprintf(stderr, "Failed to start server: %s\n", status.GetDescription().c_str());
+      success = false;
+      continue;
+    }
+    while(!bench_server.server.IsRunning())
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    for(size_t m=0; m<options.mixes.size(); m++)
+    {
+      const std::string & mix = options.mixes[m];
+      for(size_t p=0; p<options.payloads.size(); p++)
+      {
+        //Payload size is meaningless for empty calls
+        const size_t payload_size = options.payloads[p];
+        if (mix == MIX_EMPTY && p > 0)
+          break;
+
+        for(size_t c=0; c<options.clients.size(); c++)
+        {
+          ScenarioResult * result = new ScenarioResult();
+          result->transport = transport;
+          result->mix = mix;
+          result->payload_size = (mix == MIX_EMPTY ? 0 : payload_size);
+          result->num_clients = options.clients[c];
+
+          if (!RunScenario(options, address, &bench_server.server, *result))
+            success = false;
+
+          fprintf(stderr, "%s %s payload=%u clients=%u: %llu calls, p50=%lluns p99=%lluns p999=%lluns\n",
+            transport.c_str(), mix.c_str(), (unsigned int)result->payload_size, (unsigned int)result->num_clients,
+            result->latency.GetCount(), result->latency.GetPercentile(50.0), result->latency.GetPercentile(99.0), result->latency.GetPercentile(99.9));
+          results.push_back(result);
+        }
+      }
+    }
+
+    bench_server.server.Shutdown();
+    server_thread.Join();
+  }
+
+  //Output the trace
+  if (!options.trace.empty())
+  {
+    TraceRecorder::Disable();
+    Status status = TraceRecorder::SaveChromeTrace(options.trace.c_str());
+    if (!status.Success())
+    {
+      fprintf(stderr, "%s\n", status.GetDescription().c_str());
+      success = false;
+    }
+  }
+
+  //Output the results
+  std::string json = ToJson(options, results);
+  if (options.output.empty())
+  {
+    printf("%s", json.c_str());
+  }
+  else
+  {
+    FILE * f = fopen(options.output.c_str(), "w");
+    if (f == NULL)
+    {
+      fprintf(stderr, "Failed to open output file '%s'.\n", options.output.c_str());
+      success = false;
+    }
+    else
+    {
+      fputs(json.c_str(), f);
+      fclose(f);
+    }
+  }
+
+  for(size_t i=0; i<results.size(); i++)
+  {
+    delete results[i];
+  }
+
+  return (success ? 0 : 1);
+}
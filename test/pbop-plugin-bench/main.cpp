@@ -0,0 +1,433 @@
+/**********************************************************************************
+ * MIT License
+ * 
+ * Copyright (c) 2018 Antoine Beauchamp
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+// pbop-plugin-bench: measures the speed of the protobuf-pbop-plugin code generator.
+//
+// The benchmark synthesizes a chain of proto files. Each file defines messages and services
+// and imports the previous files of the chain:
+//   * files:    the number of proto files in the chain.
+//   * imports:  the number of previous files imported by each file. With 2 imports or more,
+//               the dependency graph contains diamonds.
+//   * services: the number of services in each file.
+//   * methods:  the number of methods of each service. The methods use the messages of the imported files.
+//
+// For each file, the benchmark measures the time to add the file and its dependencies to an
+// empty DescriptorPool with pbop::AddFileDescriptorToPool(), the time to add the file to a
+// DescriptorPoolCache shared by all files and the time to run the plugin in-process on a
+// CodeGeneratorRequest of the file, like protoc does. The size of the generated
+// files and the increase of the peak memory usage of the process while processing the file are
+// also recorded. The peak memory usage of a process never decreases: a file that requires less memory
+// than a previous file records no increase. Each file has the same number
+// of methods: a time that grows along the chain is a sign of a super-linear behavior.
+//
+// The results are written as a JSON document that can be stored and compared across releases.
+//
+// Usage:
+//   pbop-plugin-bench [--output=<file>] [--parameter=<generator parameter>]
+//                     [--files=<n>] [--imports=<n>] [--services=<n>] [--methods=<n>]
+
+#include "PluginCodeGenerator.h"
+#include "pbop.h"
+#include "pbop/version.h"
+
+#include "pbop/Timing.h"
+
+#ifdef _WIN32
+//google/protobuf/io/coded_stream.h(869): warning C4800: 'google::protobuf::internal::Atomic32' : forcing value to bool 'true' or 'false' (performance warning)
+//google/protobuf/wire_format_lite.h(863): warning C4146: unary minus operator applied to unsigned type, result still unsigned
+//google/protobuf/wire_format_lite.h(874): warning C4146: unary minus operator applied to unsigned type, result still unsigned
+//google/protobuf/generated_message_util.h(160): warning C4800: 'const google::protobuf::uint32' : forcing value to bool 'true' or 'false' (performance warning)
+__pragma( warning(push) )
+__pragma( warning(disable: 4800))
+__pragma( warning(disable: 4146))
+#endif //_WIN32
+
+#include <google/protobuf/descriptor.pb.h>
+#include <google/protobuf/compiler/plugin.h>
+#include <google/protobuf/compiler/plugin.pb.h>
+
+#ifdef _WIN32
+__pragma( warning(pop) )
+#endif //_WIN32
+
+#ifdef _WIN32
+#include <Windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <set>
+
+static const char * PACKAGE_NAME = "pluginbench";
+
+struct BenchOptions
+{
+  std::string output;
+  std::string parameter;
+  size_t num_files;
+  size_t num_imports;
+  size_t num_services;
+  size_t num_methods;
+};
+
+struct FileResult
+{
+  std::string name;
+  size_t num_dependencies;
+  size_t num_methods;
+  double pool_seconds;
+  double cached_pool_seconds;
+  double generate_seconds;
+  unsigned long long output_bytes;
+  unsigned long long peak_memory_increase_bytes;
+};
+
+// Returns the peak memory usage of the process in bytes.
+unsigned long long GetPeakMemoryUsage()
+{
+#ifdef _WIN32
+  PROCESS_MEMORY_COUNTERS counters;
+  if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+    return counters.PeakWorkingSetSize;
+  return 0;
+#else
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) == 0)
+    return (unsigned long long)usage.ru_maxrss * 1024; //kilobytes
+  return 0;
+#endif
+}
+
+std::string GetFileName(size_t index)
+{
+  char buffer[64];
+  sprintf(buffer, "bench_%u.proto", (unsigned int)index);
+  return buffer;
+}
+
+std::string GetMessageName(const char * prefix, size_t index)
+{
+  char buffer[64];
+  sprintf(buffer, "%s%u", prefix, (unsigned int)index);
+  return buffer;
+}
+
+void AddMessage(google::protobuf::FileDescriptorProto & file, const std::string & name)
+{
+  google::protobuf::DescriptorProto * message = file.add_message_type();
+  message->set_name(name);
+
+  google::protobuf::FieldDescriptorProto * field = message->add_field();
+  field->set_name("value");
+  field->set_number(1);
+  field->set_label(google::protobuf::FieldDescriptorProto_Label_LABEL_OPTIONAL);
+  field->set_type(google::protobuf::FieldDescriptorProto_Type_TYPE_STRING);
+}
+
+// Synthesize the proto file at the given index of the chain.
+google::protobuf::FileDescriptorProto CreateFileProto(const BenchOptions & options, size_t index)
+{
+  google::protobuf::FileDescriptorProto file;
+  file.set_name(GetFileName(index));
+  file.set_package(PACKAGE_NAME);
+  file.set_syntax("proto3");
+
+  //import the previous files of the chain
+  const size_t first_import = (index > options.num_imports ? index - options.num_imports : 0);
+  for(size_t i=first_import; i<index; i++)
+  {
+    file.add_dependency(GetFileName(i));
+  }
+
+  AddMessage(file, GetMessageName("Request", index));
+  AddMessage(file, GetMessageName("Response", index));
+
+  //the methods take the requests of this file and of the imported files in turn
+  const size_t num_request_files = index - first_import + 1;
+  char name[64];
+  for(size_t s=0; s<options.num_services; s++)
+  {
+    google::protobuf::ServiceDescriptorProto * service = file.add_service();
+    sprintf(name, "File%uService%u", (unsigned int)index, (unsigned int)s);
+    service->set_name(name);
+
+    for(size_t m=0; m<options.num_methods; m++)
+    {
+      google::protobuf::MethodDescriptorProto * method = service->add_method();
+      sprintf(name, "Method%u", (unsigned int)m);
+      method->set_name(name);
+      method->set_input_type(std::string(".") + PACKAGE_NAME + "." + GetMessageName("Request", index - (m % num_request_files)));
+      method->set_output_type(std::string(".") + PACKAGE_NAME + "." + GetMessageName("Response", index));
+    }
+  }
+
+  return file;
+}
+
+// Add a file and its dependencies to a CodeGeneratorRequest. The dependencies are added first, like protoc does.
+void AddProtoFiles(const google::protobuf::FileDescriptor * file, std::set<std::string> & visited, google::protobuf::compiler::CodeGeneratorRequest & request)
+{
+  if (!visited.insert(file->name()).second)
+    return; //already added
+  for(int i=0; i<file->dependency_count(); i++)
+  {
+    AddProtoFiles(file->dependency(i), visited, request);
+  }
+  file->CopyTo(request.add_proto_file());
+}
+
+bool RunFile(const BenchOptions & options, const google::protobuf::FileDescriptor * file, pbop::DescriptorPoolCache & cache, FileResult & result)
+{
+  const unsigned long long start_peak_memory = GetPeakMemoryUsage();
+
+  result.name = file->name();
+  result.num_methods = 0;
+  for(int i=0; i<file->service_count(); i++)
+  {
+    result.num_methods += file->service(i)->method_count();
+  }
+
+  //add the file to an empty pool
+  {
+    google::protobuf::DescriptorPool pool;
+    const unsigned long long start_time = pbop::GetMonotonicTime();
+    const google::protobuf::FileDescriptor * added = pbop::AddFileDescriptorToPool(pool, *file, true);
+    const unsigned long long end_time = pbop::GetMonotonicTime();
+    result.pool_seconds = (end_time - start_time) / 1000000000.0;
+    if (added == NULL)
+    {
+      fprintf(stderr, "Failed to add file '%s' to a descriptor pool.\n", file->name().c_str());
+      return false;
+    }
+  }
+
+  //add the file to the pool shared by all files
+  {
+    const unsigned long long start_time = pbop::GetMonotonicTime();
+    const google::protobuf::FileDescriptor * added = cache.AddFile(*file);
+    const unsigned long long end_time = pbop::GetMonotonicTime();
+    result.cached_pool_seconds = (end_time - start_time) / 1000000000.0;
+    if (added == NULL)
+    {
+      fprintf(stderr, "Failed to add file '%s' to the descriptor pool cache.\n", file->name().c_str());
+      return false;
+    }
+  }
+
+  //run the plugin like protoc does
+  google::protobuf::compiler::CodeGeneratorRequest request;
+  std::set<std::string> visited;
+  AddProtoFiles(file, visited, request);
+  request.add_file_to_generate(file->name());
+  request.set_parameter(options.parameter);
+  result.num_dependencies = request.proto_file_size() - 1;
+
+  PluginCodeGenerator generator;
+  google::protobuf::compiler::CodeGeneratorResponse response;
+  std::string error;
+  const unsigned long long start_time = pbop::GetMonotonicTime();
+  bool success = google::protobuf::compiler::GenerateCode(request, generator, &response, &error);
+  const unsigned long long end_time = pbop::GetMonotonicTime();
+  result.generate_seconds = (end_time - start_time) / 1000000000.0;
+  if (!success || response.has_error())
+  {
+    fprintf(stderr, "Failed to generate file '%s': %s%s\n", file->name().c_str(), error.c_str(), response.error().c_str());
+    return false;
+  }
+
+  result.output_bytes = 0;
+  for(int i=0; i<response.file_size(); i++)
+  {
+    result.output_bytes += response.file(i).content().size();
+  }
+  const unsigned long long end_peak_memory = GetPeakMemoryUsage();
+  result.peak_memory_increase_bytes = (end_peak_memory > start_peak_memory ? end_peak_memory - start_peak_memory : 0);
+
+  return true;
+}
+
+// Returns the given value as a quoted JSON string.
+std::string ToJsonString(const std::string & value)
+{
+  std::string json;
+  json += '"';
+  for(size_t i=0; i<value.size(); i++)
+  {
+    const char c = value[i];
+    if (c == '"' || c == '\\')
+    {
+      json += '\\';
+      json += c;
+    }
+    else if ((unsigned char)c < 0x20)
+    {
+      char buffer[8];
+      snprintf(buffer, sizeof(buffer), "\\u%04x", (unsigned int)(unsigned char)c);
+      json += buffer;
+    }
+    else
+      json += c;
+  }
+  json += '"';
+  return json;
+}
+
+std::string ToJson(const BenchOptions & options, const std::vector<FileResult> & results)
+{
+  std::string json;
+  char buffer[1024];
+
+  json += "{\n";
+  json += "  \"version\": " + ToJsonString(PBOP_VERSION) + ",\n";
+  json += "  \"parameter\": " + ToJsonString(options.parameter) + ",\n";
+  snprintf(buffer, sizeof(buffer), "  \"files\": %u,\n  \"imports\": %u,\n  \"services\": %u,\n  \"methods\": %u,\n", (unsigned int)options.num_files, (unsigned int)options.num_imports, (unsigned int)options.num_services, (unsigned int)options.num_methods);
+  json += buffer;
+  json += "  \"results\": [\n";
+  for(size_t i=0; i<results.size(); i++)
+  {
+    const FileResult & r = results[i];
+    json += "    {\"file\": " + ToJsonString(r.name);
+    snprintf(buffer, sizeof(buffer), ", \"dependencies\": %u, \"methods\": %u, \"pool_seconds\": %.6f, \"cached_pool_seconds\": %.6f, \"generate_seconds\": %.6f, \"output_bytes\": %llu, \"peak_memory_increase_bytes\": %llu}",
+      (unsigned int)r.num_dependencies,
+      (unsigned int)r.num_methods,
+      r.pool_seconds,
+      r.cached_pool_seconds,
+      r.generate_seconds,
+      r.output_bytes,
+      r.peak_memory_increase_bytes);
+    json += buffer;
+    if (i + 1 < results.size())
+      json += ",";
+    json += "\n";
+  }
+  json += "  ]\n";
+  json += "}\n";
+  return json;
+}
+
+bool ParseArgument(const char * arg, const char * name, const char ** value)
+{
+  size_t length = strlen(name);
+  if (strncmp(arg, name, length) == 0 && arg[length] == '=')
+  {
+    *value = arg + length + 1;
+    return true;
+  }
+  return false;
+}
+
+int main(int argc, char **argv)
+{
+  BenchOptions options;
+  options.num_files = 20;
+  options.num_imports = 2;
+  options.num_services = 10;
+  options.num_methods = 10;
+
+  for(int i=1; i<argc; i++)
+  {
+    const char * arg = argv[i];
+    const char * value = NULL;
+    if (ParseArgument(arg, "--output", &value))
+      options.output = value;
+    else if (ParseArgument(arg, "--parameter", &value))
+      options.parameter = value;
+    else if (ParseArgument(arg, "--files", &value))
+      options.num_files = (size_t)strtoul(value, NULL, 10);
+    else if (ParseArgument(arg, "--imports", &value))
+      options.num_imports = (size_t)strtoul(value, NULL, 10);
+    else if (ParseArgument(arg, "--services", &value))
+      options.num_services = (size_t)strtoul(value, NULL, 10);
+    else if (ParseArgument(arg, "--methods", &value))
+      options.num_methods = (size_t)strtoul(value, NULL, 10);
+    else
+    {
+      fprintf(stderr, "Unknown argument: %s\n", arg);
+      fprintf(stderr, "Usage: pbop-plugin-bench [--output=<file>] [--parameter=<generator parameter>] [--files=<n>] [--imports=<n>] [--services=<n>] [--methods=<n>]\n");
+      return 1;
+    }
+  }
+
+  //synthesize the chain of files
+  google::protobuf::DescriptorPool source_pool;
+  std::vector<const google::protobuf::FileDescriptor *> files;
+  for(size_t i=0; i<options.num_files; i++)
+  {
+    google::protobuf::FileDescriptorProto proto = CreateFileProto(options, i);
+    const google::protobuf::FileDescriptor * file = source_pool.BuildFile(proto);
+    if (file == NULL)
+    {
+      fprintf(stderr, "Failed to build file '%s'.\n", proto.name().c_str());
+      return 1;
+    }
+    files.push_back(file);
+  }
+
+  std::vector<FileResult> results;
+  pbop::DescriptorPoolCache cache;
+  bool success = true;
+  for(size_t i=0; i<files.size(); i++)
+  {
+    FileResult result;
+    if (!RunFile(options, files[i], cache, result))
+    {
+      success = false;
+      break;
+    }
+
+    fprintf(stderr, "%s dependencies=%u methods=%u: pool=%.3fms cached pool=%.3fms generate=%.3fms output=%llu bytes peak memory increase=%llu bytes\n",
+      result.name.c_str(), (unsigned int)result.num_dependencies, (unsigned int)result.num_methods,
+      result.pool_seconds * 1000.0, result.cached_pool_seconds * 1000.0, result.generate_seconds * 1000.0, result.output_bytes, result.peak_memory_increase_bytes);
+    results.push_back(result);
+  }
+
+  //Output the results
+  std::string json = ToJson(options, results);
+  if (options.output.empty())
+  {
+    printf("%s", json.c_str());
+  }
+  else
+  {
+    FILE * f = fopen(options.output.c_str(), "w");
+    if (f == NULL)
+    {
+      fprintf(stderr, "Failed to open output file '%s'.\n", options.output.c_str());
+      success = false;
+    }
+    else
+    {
+      fputs(json.c_str(), f);
+      fclose(f);
+    }
+  }
+
+  return (success ? 0 : 1);
+}
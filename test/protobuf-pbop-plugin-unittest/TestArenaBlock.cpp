@@ -0,0 +1,102 @@
+/**********************************************************************************
+ * MIT License
+ * 
+ * Copyright (c) 2018 Antoine Beauchamp
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#include "TestArenaBlock.h"
+
+#include "pbop/ArenaBlock.h"
+#include "pbop/Thread.h"
+#include "pbop/ThreadBuilder.h"
+
+using namespace pbop;
+
+void TestArenaBlock::SetUp()
+{
+}
+
+void TestArenaBlock::TearDown()
+{
+}
+
+class ArenaBlockThread
+{
+public:
+  char * block;
+
+  ArenaBlockThread() : block(NULL) {}
+
+  unsigned long Run()
+  {
+    ArenaBlock arena_block;
+    block = arena_block.GetBlock();
+    return 0;
+  }
+};
+
+TEST_F(TestArenaBlock, testReuse)
+{
+  char * first = NULL;
+  {
+    ArenaBlock block;
+    first = block.GetBlock();
+    ASSERT_TRUE(first != NULL);
+    ASSERT_EQ(ArenaBlock::BLOCK_SIZE, block.GetSize());
+  }
+
+  //assert the next call on the same thread gets the same block
+  ArenaBlock block;
+  ASSERT_EQ(first, block.GetBlock());
+  ASSERT_EQ(0, (size_t)block.GetBlock() % sizeof(unsigned long long));
+}
+
+TEST_F(TestArenaBlock, testNested)
+{
+  ArenaBlock outer;
+  ASSERT_TRUE(outer.GetBlock() != NULL);
+
+  //assert a nested call does not get the block of the outer call
+  {
+    ArenaBlock inner;
+    ASSERT_TRUE(inner.GetBlock() == NULL);
+    ASSERT_EQ(0, inner.GetSize());
+  }
+
+  //assert the nested call did not release the block of the outer call
+  ArenaBlock other;
+  ASSERT_TRUE(other.GetBlock() == NULL);
+}
+
+TEST_F(TestArenaBlock, testThreads)
+{
+  ArenaBlock block;
+
+  //assert each thread has its own block
+  ArenaBlockThread other;
+  ThreadBuilder<ArenaBlockThread> thread(&other, &ArenaBlockThread::Run);
+  Status s = thread.Start();
+  ASSERT_TRUE( s.Success() ) << s.GetDescription();
+  thread.Join();
+
+  ASSERT_TRUE(other.block != NULL);
+  ASSERT_TRUE(other.block != block.GetBlock());
+}
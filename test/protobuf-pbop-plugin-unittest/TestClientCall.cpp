@@ -0,0 +1,124 @@
+/**********************************************************************************
+ * MIT License
+ * 
+ * Copyright (c) 2018 Antoine Beauchamp
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#include "TestClientCall.h"
+#include "pbop/ClientCall.h"
+#include "pbop/LoopbackConnection.h"
+
+#ifdef _WIN32
+//google/protobuf/io/coded_stream.h(869): warning C4800: 'google::protobuf::internal::Atomic32' : forcing value to bool 'true' or 'false' (performance warning)
+//google/protobuf/wire_format_lite.h(863): warning C4146: unary minus operator applied to unsigned type, result still unsigned
+//google/protobuf/wire_format_lite.h(874): warning C4146: unary minus operator applied to unsigned type, result still unsigned
+//google/protobuf/generated_message_util.h(160): warning C4800: 'const google::protobuf::uint32' : forcing value to bool 'true' or 'false' (performance warning)
+__pragma( warning(push) )
+__pragma( warning(disable: 4800))
+__pragma( warning(disable: 4146))
+#endif //_WIN32
+
+#include "pbop/pbop.pb.h"
+
+#ifdef _WIN32
+__pragma( warning(pop) )
+#endif //_WIN32
+
+using namespace pbop;
+
+// Serialized function_identifier field of package `foo`, service `Bar` and function `Baz`.
+static const unsigned char FOO_BAR_BAZ_IDENTIFIER[] = { 0x0a, 0x0f, 0x0a, 0x03, 0x66, 0x6f, 0x6f, 0x12, 0x03, 0x42, 0x61, 0x72, 0x1a, 0x03, 0x42, 0x61, 0x7a };
+static const CallDescriptor FOO_BAR_BAZ_CALL = { "Baz", FOO_BAR_BAZ_IDENTIFIER, sizeof(FOO_BAR_BAZ_IDENTIFIER) };
+
+void TestClientCall::SetUp()
+{
+}
+
+void TestClientCall::TearDown()
+{
+}
+
+TEST_F(TestClientCall, testCall)
+{
+  LoopbackConnection * client = NULL;
+  LoopbackConnection * server = NULL;
+  LoopbackConnection::CreatePair(&client, &server);
+
+  StatusMessage request;
+  request.set_code(STATUS_CODE_OUT_OF_RANGE);
+  request.set_description("request");
+
+  StatusMessage expected_response;
+  expected_response.set_code(STATUS_CODE_TIMED_OUT);
+  expected_response.set_description("response");
+
+  // Queue the response of the server before the call
+  ServerResponse server_response;
+  server_response.mutable_status()->set_code(STATUS_CODE_SUCCESS);
+  server_response.set_response_buffer(expected_response.SerializeAsString());
+  ASSERT_TRUE( server->Write(server_response.SerializeAsString()).Success() );
+
+  StatusMessage response;
+  Status status = ClientCall(client, FOO_BAR_BAZ_CALL, request, response);
+  ASSERT_TRUE( status.Success() ) << status.GetDescription();
+  ASSERT_EQ( expected_response.code(), response.code() );
+  ASSERT_EQ( expected_response.description(), response.description() );
+
+  // The server must receive a ClientRequest for the described method
+  std::string buffer;
+  ASSERT_TRUE( server->Read(buffer).Success() );
+  ClientRequest client_request;
+  ASSERT_TRUE( client_request.ParseFromString(buffer) );
+  ASSERT_EQ( std::string("foo"), client_request.function_identifier().package() );
+  ASSERT_EQ( std::string("Bar"), client_request.function_identifier().service() );
+  ASSERT_EQ( std::string("Baz"), client_request.function_identifier().function_name() );
+  ASSERT_EQ( request.SerializeAsString(), client_request.request_buffer() );
+
+  delete client;
+  delete server;
+}
+
+TEST_F(TestClientCall, testErrors)
+{
+  StatusMessage request;
+  StatusMessage response;
+
+  // No connection
+  Status status = ClientCall(NULL, FOO_BAR_BAZ_CALL, request, response);
+  ASSERT_EQ( STATUS_CODE_INVALID_ARGUMENT, status.GetCode() );
+
+  LoopbackConnection * client = NULL;
+  LoopbackConnection * server = NULL;
+  LoopbackConnection::CreatePair(&client, &server);
+
+  // The status of the server is returned to the client
+  ServerResponse server_response;
+  server_response.mutable_status()->set_code(STATUS_CODE_NOT_IMPLEMENTED);
+  server_response.mutable_status()->set_description("Function Baz is not implemented.");
+  ASSERT_TRUE( server->Write(server_response.SerializeAsString()).Success() );
+
+  status = ClientCall(client, FOO_BAR_BAZ_CALL, request, response);
+  ASSERT_EQ( STATUS_CODE_NOT_IMPLEMENTED, status.GetCode() );
+  ASSERT_EQ( std::string("Function Baz is not implemented."), status.GetDescription() );
+
+  delete client;
+  delete server;
+}
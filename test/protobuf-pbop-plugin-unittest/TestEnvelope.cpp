@@ -0,0 +1,120 @@
+/**********************************************************************************
+ * MIT License
+ * 
+ * Copyright (c) 2018 Antoine Beauchamp
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#include "TestEnvelope.h"
+#include "pbop/Envelope.h"
+
+#ifdef _WIN32
+//google/protobuf/io/coded_stream.h(869): warning C4800: 'google::protobuf::internal::Atomic32' : forcing value to bool 'true' or 'false' (performance warning)
+//google/protobuf/wire_format_lite.h(863): warning C4146: unary minus operator applied to unsigned type, result still unsigned
+//google/protobuf/wire_format_lite.h(874): warning C4146: unary minus operator applied to unsigned type, result still unsigned
+//google/protobuf/generated_message_util.h(160): warning C4800: 'const google::protobuf::uint32' : forcing value to bool 'true' or 'false' (performance warning)
+__pragma( warning(push) )
+__pragma( warning(disable: 4800))
+__pragma( warning(disable: 4146))
+#endif //_WIN32
+
+#include "pbop/pbop.pb.h"
+
+#ifdef _WIN32
+__pragma( warning(pop) )
+#endif //_WIN32
+
+using namespace pbop;
+
+void TestEnvelope::SetUp()
+{
+}
+
+void TestEnvelope::TearDown()
+{
+}
+
+TEST_F(TestEnvelope, testEncodeClientRequest)
+{
+  // Serialize the function_identifier field the way the generated code does
+  ClientRequest identifier_message;
+  identifier_message.mutable_function_identifier()->set_package("foo");
+  identifier_message.mutable_function_identifier()->set_service("Bar");
+  identifier_message.mutable_function_identifier()->set_function_name("Baz");
+  const std::string identifier = identifier_message.SerializeAsString();
+
+  StatusMessage request;
+  request.set_code(STATUS_CODE_OUT_OF_RANGE);
+  request.set_description("value is out of range");
+
+  std::string buffer;
+  Status status = EncodeClientRequest(reinterpret_cast<const unsigned char *>(identifier.data()), identifier.size(), request, buffer);
+  ASSERT_TRUE( status.Success() ) << status.GetDescription();
+
+  // The buffer must be a valid ClientRequest message
+  ClientRequest client_request;
+  ASSERT_TRUE( client_request.ParseFromString(buffer) );
+  ASSERT_EQ( std::string("foo"), client_request.function_identifier().package() );
+  ASSERT_EQ( std::string("Bar"), client_request.function_identifier().service() );
+  ASSERT_EQ( std::string("Baz"), client_request.function_identifier().function_name() );
+  ASSERT_EQ( request.SerializeAsString(), client_request.request_buffer() );
+
+  // An empty request is serialized as an empty request_buffer
+  StatusMessage empty_request;
+  status = EncodeClientRequest(reinterpret_cast<const unsigned char *>(identifier.data()), identifier.size(), empty_request, buffer);
+  ASSERT_TRUE( status.Success() ) << status.GetDescription();
+  ASSERT_TRUE( client_request.ParseFromString(buffer) );
+  ASSERT_EQ( std::string("Baz"), client_request.function_identifier().function_name() );
+  ASSERT_TRUE( client_request.request_buffer().empty() );
+}
+
+TEST_F(TestEnvelope, testDecodeServerResponse)
+{
+  StatusMessage expected_response;
+  expected_response.set_code(STATUS_CODE_TIMED_OUT);
+  expected_response.set_description("hello");
+
+  // Successful call
+  ServerResponse server_response;
+  server_response.mutable_status()->set_code(STATUS_CODE_SUCCESS);
+  server_response.set_response_buffer(expected_response.SerializeAsString());
+
+  StatusMessage response;
+  Status status = DecodeServerResponse(server_response.SerializeAsString(), response);
+  ASSERT_TRUE( status.Success() ) << status.GetDescription();
+  ASSERT_EQ( expected_response.code(), response.code() );
+  ASSERT_EQ( expected_response.description(), response.description() );
+
+  // The status of a failed call is returned
+  server_response.mutable_status()->set_code(STATUS_CODE_NOT_IMPLEMENTED);
+  server_response.mutable_status()->set_description("Function Baz is not implemented.");
+  status = DecodeServerResponse(server_response.SerializeAsString(), response);
+  ASSERT_EQ( STATUS_CODE_NOT_IMPLEMENTED, status.GetCode() );
+  ASSERT_EQ( std::string("Function Baz is not implemented."), status.GetDescription() );
+
+  // A response without a status is invalid
+  server_response.clear_status();
+  status = DecodeServerResponse(server_response.SerializeAsString(), response);
+  ASSERT_EQ( STATUS_CODE_DESERIALIZE_ERROR, status.GetCode() );
+
+  // Invalid ServerResponse message
+  status = DecodeServerResponse(std::string("\xFF\xFF\xFF", 3), response);
+  ASSERT_EQ( STATUS_CODE_DESERIALIZE_ERROR, status.GetCode() );
+}
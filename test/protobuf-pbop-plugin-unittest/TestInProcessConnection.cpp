@@ -0,0 +1,177 @@
+/**********************************************************************************
+ * MIT License
+ * 
+ * Copyright (c) 2018 Antoine Beauchamp
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#include "TestInProcessConnection.h"
+
+#include "pbop/Server.h"
+#include "pbop/InProcessConnection.h"
+
+#ifdef _WIN32
+//google/protobuf/io/coded_stream.h(869): warning C4800: 'google::protobuf::internal::Atomic32' : forcing value to bool 'true' or 'false' (performance warning)
+//google/protobuf/wire_format_lite.h(863): warning C4146: unary minus operator applied to unsigned type, result still unsigned
+//google/protobuf/wire_format_lite.h(874): warning C4146: unary minus operator applied to unsigned type, result still unsigned
+//google/protobuf/generated_message_util.h(160): warning C4800: 'const google::protobuf::uint32' : forcing value to bool 'true' or 'false' (performance warning)
+__pragma( warning(push) )
+__pragma( warning(disable: 4800))
+__pragma( warning(disable: 4146))
+#endif //_WIN32
+
+#include "TestServiceTemplate.pb.h"
+#include "TestServiceTemplate.pbop.pb.h"
+
+#ifdef _WIN32
+__pragma( warning(pop) )
+#endif //_WIN32
+
+using namespace pbop;
+
+void TestInProcessConnection::SetUp()
+{
+}
+
+void TestInProcessConnection::TearDown()
+{
+}
+
+class InProcessCalculatorImpl : public servicetemplate::Calculator::Service
+{
+public:
+  const servicetemplate::AddRequest * last_request_;
+
+  InProcessCalculatorImpl() : last_request_(NULL) {}
+  virtual ~InProcessCalculatorImpl() {}
+
+  pbop::Status Add(const servicetemplate::AddRequest & request, servicetemplate::AddResponse & response)
+  {
+    last_request_ = &request;
+    response.set_sum(request.left() + request.right());
+    return Status::OK;
+  }
+};
+
+class InProcessCalculatorTemplateImpl : public servicetemplate::Calculator::ServiceT<InProcessCalculatorTemplateImpl>
+{
+public:
+  pbop::Status Add(const servicetemplate::AddRequest & request, servicetemplate::AddResponse & response)
+  {
+    response.set_sum(request.left() + request.right());
+    return Status::OK;
+  }
+};
+
+TEST_F(TestInProcessConnection, testDirectCall)
+{
+  Server server;
+  InProcessCalculatorImpl * impl = new InProcessCalculatorImpl();
+  server.RegisterService(impl);
+
+  InProcessConnection * connection = new InProcessConnection(&server);
+  servicetemplate::Calculator::Client client(connection);
+
+  servicetemplate::AddRequest request;
+  servicetemplate::AddResponse response;
+  request.set_left(3);
+  request.set_right(4);
+  Status s = client.Add(request, response);
+  ASSERT_TRUE( s.Success() ) << s.GetDescription();
+  ASSERT_EQ( 7, response.sum() );
+
+  // The service must have received the caller's message
+  ASSERT_EQ( &request, impl->last_request_ );
+
+  // Not implemented methods
+  servicetemplate::NegateRequest negate_request;
+  servicetemplate::NegateResponse negate_response;
+  s = client.Negate(negate_request, negate_response);
+  ASSERT_EQ( STATUS_CODE_NOT_IMPLEMENTED, s.GetCode() );
+}
+
+TEST_F(TestInProcessConnection, testCopyMessages)
+{
+  Server server;
+  InProcessCalculatorImpl * impl = new InProcessCalculatorImpl();
+  server.RegisterService(impl);
+
+  InProcessConnection * connection = new InProcessConnection(&server);
+  connection->SetCopyMessages(true);
+  servicetemplate::Calculator::Client client(connection);
+
+  servicetemplate::AddRequest request;
+  servicetemplate::AddResponse response;
+  request.set_left(3);
+  request.set_right(4);
+  Status s = client.Add(request, response);
+  ASSERT_TRUE( s.Success() ) << s.GetDescription();
+  ASSERT_EQ( 7, response.sum() );
+
+  // The service must have received a copy of the caller's message
+  ASSERT_TRUE( impl->last_request_ != NULL );
+  ASSERT_NE( &request, impl->last_request_ );
+}
+
+TEST_F(TestInProcessConnection, testSerializedCall)
+{
+  // A service without a StubInterface is called through the serialized protocol
+  Server server;
+  server.RegisterService(new InProcessCalculatorTemplateImpl());
+
+  InProcessConnection * connection = new InProcessConnection(&server);
+  servicetemplate::Calculator::Client client(connection);
+
+  servicetemplate::AddRequest request;
+  servicetemplate::AddResponse response;
+  request.set_left(3);
+  request.set_right(4);
+  Status s = client.Add(request, response);
+  ASSERT_TRUE( s.Success() ) << s.GetDescription();
+  ASSERT_EQ( 7, response.sum() );
+
+  servicetemplate::NegateRequest negate_request;
+  servicetemplate::NegateResponse negate_response;
+  s = client.Negate(negate_request, negate_response);
+  ASSERT_EQ( STATUS_CODE_NOT_IMPLEMENTED, s.GetCode() );
+}
+
+TEST_F(TestInProcessConnection, testServiceNotFound)
+{
+  Server server;
+
+  InProcessConnection * connection = new InProcessConnection(&server);
+  servicetemplate::Calculator::Client client(connection);
+
+  servicetemplate::AddRequest request;
+  servicetemplate::AddResponse response;
+  Status s = client.Add(request, response);
+  ASSERT_EQ( STATUS_CODE_NOT_IMPLEMENTED, s.GetCode() );
+}
+
+TEST_F(TestInProcessConnection, testReadWithoutWrite)
+{
+  Server server;
+  InProcessConnection connection(&server);
+
+  std::string buffer;
+  Status s = connection.Read(buffer);
+  ASSERT_EQ( STATUS_CODE_TIMED_OUT, s.GetCode() );
+}
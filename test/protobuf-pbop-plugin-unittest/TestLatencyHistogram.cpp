@@ -0,0 +1,138 @@
+/**********************************************************************************
+ * MIT License
+ * 
+ * Copyright (c) 2018 Antoine Beauchamp
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#include "TestLatencyHistogram.h"
+
+#include "pbop/LatencyHistogram.h"
+
+using namespace pbop;
+
+void TestLatencyHistogram::SetUp()
+{
+}
+
+void TestLatencyHistogram::TearDown()
+{
+}
+
+TEST_F(TestLatencyHistogram, testEmpty)
+{
+  LatencyHistogram h;
+  ASSERT_EQ(0, h.GetCount());
+  ASSERT_EQ(0, h.GetMin());
+  ASSERT_EQ(0, h.GetMax());
+  ASSERT_EQ(0, h.GetPercentile(50.0));
+  ASSERT_EQ(0.0, h.GetMean());
+}
+
+TEST_F(TestLatencyHistogram, testBuckets)
+{
+  //small values are recorded exactly
+  for(unsigned long long value = 0; value < LatencyHistogram::SUB_BUCKET_COUNT * 2; value++)
+  {
+    unsigned int index = LatencyHistogram::GetBucketIndex(value);
+    ASSERT_EQ(value, LatencyHistogram::GetBucketLowestValue(index));
+    ASSERT_EQ(value, LatencyHistogram::GetBucketHighestValue(index));
+  }
+
+  //buckets are contiguous and each value is within its bucket
+  unsigned long long values[] = {64, 100, 1000, 12345, 1000000, 987654321ULL, 0xFFFFFFFFFFFFFFFFULL};
+  for(size_t i=0; i<sizeof(values)/sizeof(values[0]); i++)
+  {
+    unsigned long long value = values[i];
+    unsigned int index = LatencyHistogram::GetBucketIndex(value);
+    ASSERT_LT(index, LatencyHistogram::BUCKET_COUNT);
+    ASSERT_LE(LatencyHistogram::GetBucketLowestValue(index), value);
+    ASSERT_GE(LatencyHistogram::GetBucketHighestValue(index), value);
+    ASSERT_EQ(LatencyHistogram::GetBucketHighestValue(index-1) + 1, LatencyHistogram::GetBucketLowestValue(index));
+
+    //relative precision
+    double width = (double)(LatencyHistogram::GetBucketHighestValue(index) - LatencyHistogram::GetBucketLowestValue(index));
+    ASSERT_LE(width / (double)value, 1.0 / LatencyHistogram::SUB_BUCKET_COUNT);
+  }
+}
+
+TEST_F(TestLatencyHistogram, testPercentiles)
+{
+  LatencyHistogram h;
+  for(unsigned long long value = 1; value <= 10000; value++)
+  {
+    h.Record(value * 1000);
+  }
+
+  ASSERT_EQ(10000, h.GetCount());
+  ASSERT_EQ(1000, h.GetMin());
+  ASSERT_EQ(10000000, h.GetMax());
+  ASSERT_NEAR(5000500.0, h.GetMean(), 1.0);
+
+  //percentiles are within the precision of the histogram
+  ASSERT_NEAR(5000000.0, (double)h.GetPercentile(50.0), 5000000.0 * 0.04);
+  ASSERT_NEAR(9900000.0, (double)h.GetPercentile(99.0), 9900000.0 * 0.04);
+  ASSERT_NEAR(9990000.0, (double)h.GetPercentile(99.9), 9990000.0 * 0.04);
+  ASSERT_EQ(h.GetMax(), h.GetPercentile(100.0));
+  ASSERT_LE(h.GetPercentile(99.0), h.GetPercentile(99.9));
+}
+
+TEST_F(TestLatencyHistogram, testMerge)
+{
+  LatencyHistogram a;
+  LatencyHistogram b;
+  a.Record(10);
+  a.Record(20);
+  b.Record(5);
+  b.Record(1000);
+
+  a.Merge(b);
+  ASSERT_EQ(4, a.GetCount());
+  ASSERT_EQ(5, a.GetMin());
+  ASSERT_EQ(1000, a.GetMax());
+
+  std::string json = a.ToJson();
+  ASSERT_NE(std::string::npos, json.find("\"count\": 4"));
+  ASSERT_NE(std::string::npos, json.find("\"p999\": "));
+
+  a.Reset();
+  ASSERT_EQ(0, a.GetCount());
+}
+
+TEST_F(TestLatencyHistogram, testSwap)
+{
+  LatencyHistogram a;
+  LatencyHistogram b;
+  a.Record(10);
+  a.Record(20);
+
+  a.Swap(b);
+  ASSERT_EQ(0, a.GetCount());
+  ASSERT_EQ(0, a.GetPercentile(50.0));
+  ASSERT_EQ(2, b.GetCount());
+  ASSERT_EQ(10, b.GetMin());
+  ASSERT_EQ(20, b.GetMax());
+  ASSERT_EQ(20, b.GetPercentile(100.0));
+
+  // The swapped histogram can still record values
+  a.Record(5);
+  ASSERT_EQ(1, a.GetCount());
+  ASSERT_EQ(5, a.GetMax());
+}
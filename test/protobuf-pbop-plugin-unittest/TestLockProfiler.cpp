@@ -0,0 +1,170 @@
+/**********************************************************************************
+ * MIT License
+ * 
+ * Copyright (c) 2018 Antoine Beauchamp
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#include "TestLockProfiler.h"
+
+#include <Windows.h>
+
+#include "pbop/Thread.h"
+#include "pbop/ThreadBuilder.h"
+#include "pbop/CriticalSection.h"
+#include "pbop/Mutex.h"
+#include "pbop/ReadWriteLock.h"
+#include "pbop/LockProfiler.h"
+
+using namespace pbop;
+
+void TestLockProfiler::SetUp()
+{
+  LockProfiler::Reset();
+}
+
+void TestLockProfiler::TearDown()
+{
+}
+
+bool FindLockStatistics(const char * name, LockStatistics & statistics)
+{
+  std::vector<LockStatistics> all_statistics;
+  LockProfiler::GetStatistics(all_statistics);
+  for(size_t i=0; i<all_statistics.size(); i++)
+  {
+    if (all_statistics[i].name == name)
+    {
+      statistics = all_statistics[i];
+      return true;
+    }
+  }
+  return false;
+}
+
+class ContendedLocker
+{
+public:
+  CriticalSection * lock;
+
+  DWORD Run()
+  {
+    lock->Lock();
+    lock->Unlock();
+    return 0;
+  }
+};
+
+TEST_F(TestLockProfiler, testName)
+{
+  Mutex m;
+  ASSERT_STREQ("", m.GetName());
+  m.SetName("testName.mutex");
+  ASSERT_STREQ("testName.mutex", m.GetName());
+
+  CriticalSection cs;
+  ASSERT_STREQ("", cs.GetName());
+  cs.SetName("testName.cs");
+  ASSERT_STREQ("testName.cs", cs.GetName());
+
+  ReadWriteLock rw;
+  ASSERT_STREQ("", rw.GetName());
+  rw.SetName("testName.rw");
+  ASSERT_STREQ("testName.rw", rw.GetName());
+}
+
+TEST_F(TestLockProfiler, testRegistration)
+{
+  LockStatistics statistics;
+  {
+    CriticalSection cs;
+    cs.SetName("testRegistration.cs");
+    ASSERT_EQ(LockProfiler::IsEnabled(), FindLockStatistics("testRegistration.cs", statistics));
+  }
+
+  // Destroyed locks are unregistered
+  ASSERT_FALSE(FindLockStatistics("testRegistration.cs", statistics));
+}
+
+TEST_F(TestLockProfiler, testAcquisitions)
+{
+  if (!LockProfiler::IsEnabled())
+    return; // Library is not built with PBOP_ENABLE_LOCK_PROFILING
+
+  Mutex m;
+  m.SetName("testAcquisitions.mutex");
+  ReadWriteLock rw;
+  rw.SetName("testAcquisitions.rw");
+
+  for(int i=0; i<10; i++)
+  {
+    m.Lock();
+    m.Unlock();
+    rw.LockRead();
+    rw.UnlockRead();
+    rw.LockWrite();
+    rw.UnlockWrite();
+  }
+
+  LockStatistics statistics;
+  m.GetStatistics(statistics);
+  ASSERT_EQ(std::string("testAcquisitions.mutex"), statistics.name);
+  ASSERT_EQ(10ull, statistics.acquisitions);
+  ASSERT_EQ(0ull, statistics.contentions);
+
+  rw.GetStatistics(statistics);
+  ASSERT_EQ(20ull, statistics.acquisitions);
+  ASSERT_EQ(0ull, statistics.contentions);
+
+  LockProfiler::Reset();
+  m.GetStatistics(statistics);
+  ASSERT_EQ(0ull, statistics.acquisitions);
+}
+
+TEST_F(TestLockProfiler, testContention)
+{
+  if (!LockProfiler::IsEnabled())
+    return; // Library is not built with PBOP_ENABLE_LOCK_PROFILING
+
+  CriticalSection cs;
+  cs.SetName("testContention.cs");
+
+  ContendedLocker locker;
+  locker.lock = &cs;
+  ThreadBuilder<ContendedLocker> thread(&locker, &ContendedLocker::Run);
+
+  // Hold the lock while the thread tries to acquire it
+  cs.Lock();
+  Status s = thread.Start();
+  ASSERT_TRUE( s.Success() ) << s.GetDescription();
+  Sleep(300);
+  cs.Unlock();
+  thread.Join();
+
+  LockStatistics statistics;
+  cs.GetStatistics(statistics);
+  ASSERT_EQ(2ull, statistics.acquisitions);
+  ASSERT_EQ(1ull, statistics.contentions);
+  ASSERT_GE(statistics.wait_time, 200ull * 1000 * 1000);
+  ASSERT_GE(statistics.hold_time, 200ull * 1000 * 1000);
+
+  std::string table = LockProfiler::ToString();
+  ASSERT_NE(std::string::npos, table.find("testContention.cs"));
+}
@@ -0,0 +1,378 @@
+/**********************************************************************************
+ * MIT License
+ * 
+ * Copyright (c) 2018 Antoine Beauchamp
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#include "TestLoopbackConnection.h"
+
+#include "pbop/LoopbackConnection.h"
+#include "pbop/Server.h"
+
+#include "rapidassist/timing.h"
+
+#ifdef _WIN32
+//google/protobuf/io/coded_stream.h(869): warning C4800: 'google::protobuf::internal::Atomic32' : forcing value to bool 'true' or 'false' (performance warning)
+//google/protobuf/wire_format_lite.h(863): warning C4146: unary minus operator applied to unsigned type, result still unsigned
+//google/protobuf/wire_format_lite.h(874): warning C4146: unary minus operator applied to unsigned type, result still unsigned
+//google/protobuf/generated_message_util.h(160): warning C4800: 'const google::protobuf::uint32' : forcing value to bool 'true' or 'false' (performance warning)
+__pragma( warning(push) )
+__pragma( warning(disable: 4800))
+__pragma( warning(disable: 4146))
+#endif //_WIN32
+
+#include "TestServiceTemplate.pb.h"
+#include "TestServiceTemplate.pbop.pb.h"
+
+#ifdef _WIN32
+__pragma( warning(pop) )
+#endif //_WIN32
+
+#include "pbop/Thread.h"
+#include "pbop/ThreadBuilder.h"
+
+#include <vector>
+#include <atomic>
+
+using namespace pbop;
+
+void TestLoopbackConnection::SetUp()
+{
+}
+
+void TestLoopbackConnection::TearDown()
+{
+}
+
+TEST_F(TestLoopbackConnection, testMessageBoundaries)
+{
+  LoopbackConnection * first = NULL;
+  LoopbackConnection * second = NULL;
+  LoopbackConnection::CreatePair(&first, &second);
+  ASSERT_TRUE(first != NULL);
+  ASSERT_TRUE(second != NULL);
+
+  ASSERT_TRUE( first->Write("foo").Success() );
+  ASSERT_TRUE( first->Write("").Success() );
+  ASSERT_TRUE( first->Write("bar").Success() );
+  ASSERT_TRUE( second->Write("baz").Success() );
+
+  std::string buffer;
+  ASSERT_TRUE( second->Read(buffer).Success() );
+  ASSERT_EQ("foo", buffer);
+  ASSERT_TRUE( second->Read(buffer).Success() );
+  ASSERT_EQ("", buffer);
+  ASSERT_TRUE( second->Read(buffer).Success() );
+  ASSERT_EQ("bar", buffer);
+  ASSERT_TRUE( first->Read(buffer).Success() );
+  ASSERT_EQ("baz", buffer);
+
+  delete first;
+  delete second;
+}
+
+TEST_F(TestLoopbackConnection, testTimeout)
+{
+  LoopbackConnection * first = NULL;
+  LoopbackConnection * second = NULL;
+  LoopbackConnection::CreatePair(&first, &second);
+
+  std::string buffer;
+  Status s = second->Read(buffer, 50);
+  ASSERT_EQ(STATUS_CODE_TIMED_OUT, s.GetCode());
+
+  delete first;
+  delete second;
+}
+
+TEST_F(TestLoopbackConnection, testClose)
+{
+  LoopbackConnection * first = NULL;
+  LoopbackConnection * second = NULL;
+  LoopbackConnection::CreatePair(&first, &second);
+
+  // Pending messages can be read after the peer is destroyed
+  ASSERT_TRUE( first->Write("foo").Success() );
+  delete first;
+
+  std::string buffer;
+  ASSERT_TRUE( second->Read(buffer).Success() );
+  ASSERT_EQ("foo", buffer);
+
+  Status s = second->Read(buffer);
+  ASSERT_EQ(STATUS_CODE_PIPE_ERROR, s.GetCode());
+  s = second->Read(buffer, 1000);
+  ASSERT_EQ(STATUS_CODE_PIPE_ERROR, s.GetCode());
+  s = second->Write("bar");
+  ASSERT_EQ(STATUS_CODE_PIPE_ERROR, s.GetCode());
+
+  delete second;
+}
+
+class LoopbackProducer
+{
+public:
+  LoopbackConnection * connection;
+  int id;
+  int count;
+
+  unsigned long Run()
+  {
+    for(int i=0; i<count; i++)
+    {
+      char buffer[64];
+      sprintf(buffer, "%d:%d", id, i);
+      Status s = connection->Write(buffer);
+      if (!s.Success())
+        return 1;
+    }
+    return 0;
+  }
+};
+
+TEST_F(TestLoopbackConnection, testMultipleProducers)
+{
+  static const int NUM_PRODUCERS = 4;
+  static const int NUM_MESSAGES = 10000;
+
+  // Use a small capacity to force the producers to block
+  LoopbackConnection * first = NULL;
+  LoopbackConnection * second = NULL;
+  LoopbackConnection::CreatePair(&first, &second, 16);
+
+  std::vector<LoopbackProducer> producers(NUM_PRODUCERS);
+  std::vector<Thread *> threads;
+  for(int i=0; i<NUM_PRODUCERS; i++)
+  {
+    producers[i].connection = first;
+    producers[i].id = i;
+    producers[i].count = NUM_MESSAGES;
+    threads.push_back(new ThreadBuilder<LoopbackProducer>(&producers[i], &LoopbackProducer::Run));
+  }
+  for(size_t i=0; i<threads.size(); i++)
+  {
+    Status s = threads[i]->Start();
+    ASSERT_TRUE( s.Success() ) << s.GetDescription();
+  }
+
+  // The messages of each producer must be received in order
+  std::vector<int> next_index(NUM_PRODUCERS, 0);
+  std::string buffer;
+  for(int i=0; i<NUM_PRODUCERS*NUM_MESSAGES; i++)
+  {
+    Status s = second->Read(buffer, 5000);
+    ASSERT_TRUE( s.Success() ) << s.GetDescription();
+
+    int id = -1;
+    int index = -1;
+    ASSERT_EQ(2, sscanf(buffer.c_str(), "%d:%d", &id, &index)) << buffer;
+    ASSERT_TRUE(id >= 0 && id < NUM_PRODUCERS);
+    ASSERT_EQ(next_index[id], index);
+    next_index[id]++;
+  }
+
+  for(size_t i=0; i<threads.size(); i++)
+  {
+    threads[i]->Join();
+    delete threads[i];
+  }
+
+  delete first;
+  delete second;
+}
+
+class LoopbackCalculatorImpl : public servicetemplate::Calculator::Service
+{
+public:
+  LoopbackCalculatorImpl() {}
+  virtual ~LoopbackCalculatorImpl() {}
+
+  pbop::Status Add(const servicetemplate::AddRequest & request, servicetemplate::AddResponse & response)
+  {
+    response.set_sum(request.left() + request.right());
+    return Status::OK;
+  }
+};
+
+class TestLoopbackServer : public Server
+{
+public:
+  LoopbackConnection * extra_client_connection;
+  std::atomic<int> num_disconnected;
+  std::atomic<int> num_errors;
+
+  TestLoopbackServer() : extra_client_connection(NULL), num_disconnected(0), num_errors(0) {}
+  virtual ~TestLoopbackServer() {}
+
+  virtual void OnEvent(EventClientDisconnected * e)
+  {
+    num_disconnected++;
+  }
+
+  virtual void OnEvent(EventClientError * e)
+  {
+    num_errors++;
+  }
+
+  // Attach a second client while the first connection is processed.
+  // The event is published without holding the server's locks.
+  virtual void OnEvent(EventConnection * e)
+  {
+    if (extra_client_connection != NULL)
+      return;
+
+    LoopbackConnection * server_connection = NULL;
+    LoopbackConnection::CreatePair(&extra_client_connection, &server_connection);
+    Status s = AddConnection(server_connection);
+    if (!s.Success())
+      delete server_connection;
+  }
+};
+
+void CallAdd(Connection * connection)
+{
+  // The client takes ownership of the connection
+  servicetemplate::Calculator::Client client(connection);
+  for(int i=0; i<100; i++)
+  {
+    servicetemplate::AddRequest request;
+    servicetemplate::AddResponse response;
+    request.set_left(i);
+    request.set_right(1);
+    Status s = client.Add(request, response);
+    ASSERT_TRUE( s.Success() ) << s.GetDescription();
+    ASSERT_EQ( i + 1, response.sum() );
+  }
+}
+
+TEST_F(TestLoopbackConnection, testServerSession)
+{
+  TestLoopbackServer server;
+  server.RegisterService(new LoopbackCalculatorImpl());
+
+  // A connection can not be added to a server that is not running
+  LoopbackConnection * client_connection = NULL;
+  LoopbackConnection * server_connection = NULL;
+  LoopbackConnection::CreatePair(&client_connection, &server_connection);
+  Status s = server.AddConnection(server_connection);
+  ASSERT_FALSE( s.Success() );
+
+  // Start the server without a pipe
+  s = server.Start();
+  ASSERT_TRUE( s.Success() ) << s.GetDescription();
+  ASSERT_TRUE( server.IsRunning() );
+
+  // The server takes ownership of its side of the pair
+  s = server.AddConnection(server_connection);
+  ASSERT_TRUE( s.Success() ) << s.GetDescription();
+  ASSERT_TRUE( server.extra_client_connection != NULL );
+
+  CallAdd(client_connection);
+  CallAdd(server.extra_client_connection);
+
+  // Destroying the clients closes their connections. Expect the sessions to see a disconnection, not an error.
+  for(int i=0; i<100 && server.num_disconnected < 2; i++)
+  {
+    ra::timing::Millisleep(50);
+  }
+  ASSERT_EQ(2, server.num_disconnected.load());
+  ASSERT_EQ(0, server.num_errors.load());
+
+  s = server.Shutdown();
+  ASSERT_TRUE( s.Success() ) << s.GetDescription();
+  ASSERT_FALSE( server.IsRunning() );
+
+  // Connections are refused once the server is shut down
+  LoopbackConnection::CreatePair(&client_connection, &server_connection);
+  s = server.AddConnection(server_connection);
+  ASSERT_FALSE( s.Success() );
+  delete client_connection;
+  delete server_connection;
+}
+
+class ShutdownCalculatorImpl : public servicetemplate::Calculator::Service
+{
+public:
+  Server * server;
+  Status shutdown_status;
+  Status add_connection_status;
+
+  ShutdownCalculatorImpl(Server * s) : server(s) {}
+  virtual ~ShutdownCalculatorImpl() {}
+
+  pbop::Status Add(const servicetemplate::AddRequest & request, servicetemplate::AddResponse & response)
+  {
+    if (request.left() < 0)
+    {
+      // Shut down the server from the session's thread
+      shutdown_status = server->Shutdown();
+
+      // Connections are refused once the server is shut down
+      LoopbackConnection * client_connection = NULL;
+      LoopbackConnection * server_connection = NULL;
+      LoopbackConnection::CreatePair(&client_connection, &server_connection);
+      add_connection_status = server->AddConnection(server_connection);
+      delete client_connection;
+      delete server_connection;
+    }
+    response.set_sum(request.left() + request.right());
+    return Status::OK;
+  }
+};
+
+TEST_F(TestLoopbackConnection, testShutdownFromSession)
+{
+  Server server;
+  ShutdownCalculatorImpl * impl = new ShutdownCalculatorImpl(&server);
+  server.RegisterService(impl);
+
+  Status s = server.Start();
+  ASSERT_TRUE( s.Success() ) << s.GetDescription();
+
+  // An idle session which is joined by the session that shuts down the server
+  LoopbackConnection * idle_client_connection = NULL;
+  LoopbackConnection * server_connection = NULL;
+  LoopbackConnection::CreatePair(&idle_client_connection, &server_connection);
+  s = server.AddConnection(server_connection);
+  ASSERT_TRUE( s.Success() ) << s.GetDescription();
+
+  LoopbackConnection * client_connection = NULL;
+  LoopbackConnection::CreatePair(&client_connection, &server_connection);
+  s = server.AddConnection(server_connection);
+  ASSERT_TRUE( s.Success() ) << s.GetDescription();
+
+  // The session thread does not join itself
+  {
+    servicetemplate::Calculator::Client client(client_connection);
+    servicetemplate::AddRequest request;
+    servicetemplate::AddResponse response;
+    request.set_left(-1);
+    request.set_right(1);
+    s = client.Add(request, response);
+    ASSERT_TRUE( s.Success() ) << s.GetDescription();
+  }
+
+  ASSERT_TRUE( impl->shutdown_status.Success() ) << impl->shutdown_status.GetDescription();
+  ASSERT_EQ( STATUS_CODE_CANCELLED, impl->add_connection_status.GetCode() );
+  ASSERT_FALSE( server.IsRunning() );
+
+  delete idle_client_connection;
+}
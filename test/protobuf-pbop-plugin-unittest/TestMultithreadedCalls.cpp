@@ -30,6 +30,8 @@
 #include "rapidassist/testing.h"
 #include "rapidassist/timing.h"
 
+#include <atomic>
+
 #ifdef _WIN32
 //google/protobuf/io/coded_stream.h(869): warning C4800: 'google::protobuf::internal::Atomic32' : forcing value to bool 'true' or 'false' (performance warning)
 //google/protobuf/wire_format_lite.h(863): warning C4146: unary minus operator applied to unsigned type, result still unsigned
@@ -91,6 +93,34 @@ public:
 
 };
 
+class ConcurrencyTrackingImpl : public multithreaded::FastSlow::Service
+{
+public:
+  std::atomic<long> num_slow_calls_;      // number of CallSlow() executing
+  std::atomic<long> max_num_slow_calls_;  // maximum number of CallSlow() executing at the same time
+
+  ConcurrencyTrackingImpl() : num_slow_calls_(0), max_num_slow_calls_(0) {}
+  virtual ~ConcurrencyTrackingImpl() {}
+
+  pbop::Status CallFast(const multithreaded::FastRequest & request, multithreaded::FastResponse & response)
+  {
+    return Status::OK;
+  }
+
+  pbop::Status CallSlow(const multithreaded::SlowRequest & request, multithreaded::SlowResponse & response)
+  {
+    long count = ++num_slow_calls_;
+    long max_count = max_num_slow_calls_;
+    while(count > max_count && !max_num_slow_calls_.compare_exchange_weak(max_count, count))
+    {
+    }
+    Sleep(500);
+    num_slow_calls_--;
+
+    return Status::OK;
+  }
+};
+
 class TestMultithreadServer
 {
 public:
@@ -180,9 +210,10 @@ public:
   }
 };
 
-TEST_F(TestMultithreadedCalls, testBase)
+void RunFastSlowCalls(unsigned int num_workers)
 {
   TestMultithreadServer server_object;
+  server_object.server.SetWorkerCount(num_workers);
 
   //assign the service implementation to the server
   FastSlowImpl * impl = new FastSlowImpl();
@@ -272,3 +303,92 @@ TEST_F(TestMultithreadedCalls, testBase)
 
   ASSERT_TRUE( multithread_proof );
 }
+
+TEST_F(TestMultithreadedCalls, testBase)
+{
+  RunFastSlowCalls(0);
+}
+
+TEST_F(TestMultithreadedCalls, testWorkers)
+{
+  // Methods without options are still executed on the sessions threads when workers are enabled
+  RunFastSlowCalls(2);
+}
+
+void RunConcurrencyLimitedCalls(unsigned int num_workers)
+{
+  TestMultithreadServer server_object;
+  server_object.server.SetWorkerCount(num_workers);
+
+  // Allow a single CallSlow() at a time
+  Server::MethodOptions options;
+  options.max_concurrency = 1;
+  options.priority = Server::PRIORITY_LOW;
+  ASSERT_TRUE(server_object.server.SetMethodOptions("multithreaded", "FastSlow", "CallSlow", options).Success());
+
+  Server::MethodOptions actual;
+  ASSERT_TRUE(server_object.server.GetMethodOptions("multithreaded", "FastSlow", "CallSlow", actual));
+  ASSERT_EQ(1, actual.max_concurrency);
+  ASSERT_EQ(Server::PRIORITY_LOW, actual.priority);
+  ASSERT_FALSE(server_object.server.GetMethodOptions("multithreaded", "FastSlow", NULL, actual));
+
+  ConcurrencyTrackingImpl * impl = new ConcurrencyTrackingImpl();
+  server_object.server.RegisterService(impl);
+
+  server_object.pipe_name = GetPipeNameFromTestName();
+
+  // Start the server thread
+  Status s = server_object.thread->Start();
+  ASSERT_TRUE( s.Success() ) << s.GetDescription();
+
+  // Allow time for the server to start listening for connections
+  while(!server_object.server.IsRunning())
+  {
+    ra::timing::Millisleep(100);
+  }
+  ra::timing::Millisleep(100);
+
+  // Options can not be changed once the server is running
+  ASSERT_FALSE(server_object.server.SetMethodOptions("multithreaded", "FastSlow", NULL, options).Success());
+
+  // Start multiple clients calling CallSlow() concurrently
+  TestMultithreadClient client1;
+  TestMultithreadClient client2;
+  TestMultithreadClient client3;
+  client1.pipe_name = server_object.pipe_name;
+  client2.pipe_name = server_object.pipe_name;
+  client3.pipe_name = server_object.pipe_name;
+  ASSERT_TRUE( client1.thread->Start().Success() );
+  ASSERT_TRUE( client2.thread->Start().Success() );
+  ASSERT_TRUE( client3.thread->Start().Success() );
+
+  // Let the clients make a few calls
+  ra::timing::Millisleep(2000);
+
+  client1.thread->SetInterrupt();
+  client2.thread->SetInterrupt();
+  client3.thread->SetInterrupt();
+  client1.thread->Join();
+  client2.thread->Join();
+  client3.thread->Join();
+  ASSERT_TRUE( client1.status.Success() ) << client1.status.GetDescription();
+  ASSERT_TRUE( client2.status.Success() ) << client2.status.GetDescription();
+  ASSERT_TRUE( client3.status.Success() ) << client3.status.GetDescription();
+
+  s = server_object.server.Shutdown();
+  ASSERT_TRUE( s.Success() ) << s.GetDescription();
+  server_object.thread->Join();
+
+  // CallSlow() must never be executed concurrently
+  ASSERT_EQ(1, impl->max_num_slow_calls_.load());
+}
+
+TEST_F(TestMultithreadedCalls, testConcurrencyLimit)
+{
+  RunConcurrencyLimitedCalls(0);
+}
+
+TEST_F(TestMultithreadedCalls, testConcurrencyLimitWorkers)
+{
+  RunConcurrencyLimitedCalls(4);
+}
@@ -42,6 +42,7 @@ __pragma( warning(disable: 4146))
 
 #include "TestPerformance.pb.h"
 #include "TestPerformance.pbop.pb.h"
+#include "pbop/pbop.pb.h"
 
 #ifdef _WIN32
 __pragma( warning(pop) )
@@ -51,6 +52,7 @@ __pragma( warning(pop) )
 
 #include "pbop/Thread.h"
 #include "pbop/ThreadBuilder.h"
+#include "pbop/StatisticsService.h"
 
 using namespace pbop;
 
@@ -277,3 +279,263 @@ TEST_F(TestPerformance, testCallPerformance)
   }
   clients.clear();
 }
+
+// A call is recorded by the server once its response is written to the client.
+// The client may receive the response before the call is recorded. Wait for the given number of calls.
+const MethodStatistics * WaitForMethodCalls(Server & server, const char * function, unsigned long long num_calls, std::vector<MethodStatistics> & statistics)
+{
+  const MethodStatistics * method = NULL;
+  for(int retry = 0; retry < 100; retry++)
+  {
+    server.GetStatistics(statistics);
+    method = NULL;
+    for(size_t i=0; i<statistics.size(); i++)
+    {
+      if (statistics[i].function == function)
+        method = &statistics[i];
+    }
+    if (method != NULL && method->latency[CALL_PHASE_TOTAL].GetCount() >= num_calls)
+      return method;
+    ra::timing::Millisleep(10);
+  }
+  return method;
+}
+
+TEST_F(TestPerformance, testServerStatistics)
+{
+  TestPerformanceServer object;
+  object.server.SetStatisticsEnabled(true);
+  ASSERT_TRUE(object.server.IsStatisticsEnabled());
+
+  //assign the foo service and the statistics service to the server
+  object.server.RegisterService(new FooServiceImpl());
+  object.server.RegisterService(new StatisticsService::Service(&object.server));
+
+  object.pipe_name = GetPipeNameFromTestName();
+
+  ThreadBuilder<TestPerformanceServer> thread(&object, &TestPerformanceServer::Run);
+
+  // Start the thread
+  Status s = thread.Start();
+  ASSERT_TRUE( s.Success() ) << s.GetDescription();
+
+  // Allow time for the server to start listening for connections
+  while(!object.server.IsRunning())
+  {
+    ra::timing::Millisleep(100);
+  }
+  ra::timing::Millisleep(100);
+
+  //Make calls to the Foo service
+  static const size_t num_calls = 100;
+  {
+    pbop::PipeConnection * connection = new pbop::PipeConnection();
+    s = connection->Connect(object.pipe_name.c_str());
+    ASSERT_TRUE( s.Success() ) << s.GetDescription();
+
+    performance::Foo::Client client(connection);
+    performance::BarRequest request;
+    performance::BarResponse response;
+    for(size_t i=0; i<num_calls; i++)
+    {
+      s = client.Bar(request, response);
+      ASSERT_TRUE( s.Success() ) << s.GetDescription();
+    }
+  }
+
+  //Read the statistics from the server
+  std::vector<MethodStatistics> statistics;
+  const MethodStatistics * bar = WaitForMethodCalls(object.server, "Bar", num_calls, statistics);
+  ASSERT_EQ(2, statistics.size()); // Foo.Bar and StatisticsService.GetStatistics
+  ASSERT_TRUE(bar != NULL);
+  ASSERT_EQ(std::string("performance"), bar->package);
+  ASSERT_EQ(std::string("Foo"), bar->service);
+  ASSERT_EQ(num_calls, bar->calls);
+  ASSERT_EQ(0, bar->errors);
+  ASSERT_GT(bar->bytes_in, 0);
+  ASSERT_GT(bar->bytes_out, 0);
+  for(int phase = 0; phase < CALL_PHASE_COUNT; phase++)
+  {
+    ASSERT_EQ(num_calls, bar->latency[phase].GetCount()) << GetCallPhaseName((CallPhase)phase);
+  }
+  ASSERT_GE(bar->latency[CALL_PHASE_TOTAL].GetMax(), bar->latency[CALL_PHASE_EXECUTE].GetMax());
+
+  //Read the statistics through the statistics service
+  {
+    pbop::PipeConnection * connection = new pbop::PipeConnection();
+    s = connection->Connect(object.pipe_name.c_str());
+    ASSERT_TRUE( s.Success() ) << s.GetDescription();
+
+    StatisticsService::Client client(connection);
+    GetStatisticsRequest request;
+    request.set_reset(true);
+    GetStatisticsResponse response;
+    s = client.GetStatistics(request, response);
+    ASSERT_TRUE( s.Success() ) << s.GetDescription();
+
+    bool found = false;
+    for(int i=0; i<response.methods_size(); i++)
+    {
+      const MethodStatisticsMessage & method = response.methods(i);
+      if (method.function_identifier().function_name() == "Bar")
+      {
+        found = true;
+        ASSERT_EQ(num_calls, method.calls());
+        ASSERT_EQ((int)CALL_PHASE_COUNT, method.latencies_size());
+        ASSERT_EQ(std::string("total"), method.latencies(CALL_PHASE_TOTAL).phase());
+        ASSERT_EQ(num_calls, method.latencies(CALL_PHASE_TOTAL).count());
+      }
+    }
+    ASSERT_TRUE(found);
+  }
+
+  //The statistics were reset by the request
+  object.server.GetStatistics(statistics);
+  for(size_t i=0; i<statistics.size(); i++)
+  {
+    if (statistics[i].function == "Bar")
+      ASSERT_EQ(0, statistics[i].calls);
+  }
+
+  //Read and reset the statistics in a single operation
+  {
+    pbop::PipeConnection * connection = new pbop::PipeConnection();
+    s = connection->Connect(object.pipe_name.c_str());
+    ASSERT_TRUE( s.Success() ) << s.GetDescription();
+
+    performance::Foo::Client client(connection);
+    performance::BarRequest request;
+    performance::BarResponse response;
+    s = client.Bar(request, response);
+    ASSERT_TRUE( s.Success() ) << s.GetDescription();
+  }
+  bar = WaitForMethodCalls(object.server, "Bar", 1, statistics);
+  ASSERT_TRUE(bar != NULL);
+  object.server.GetStatistics(statistics, true);
+  bar = NULL;
+  for(size_t i=0; i<statistics.size(); i++)
+  {
+    if (statistics[i].function == "Bar")
+      bar = &statistics[i];
+  }
+  ASSERT_TRUE(bar != NULL);
+  ASSERT_EQ(1, bar->calls);
+  ASSERT_EQ(1, bar->latency[CALL_PHASE_TOTAL].GetCount());
+  object.server.GetStatistics(statistics);
+  for(size_t i=0; i<statistics.size(); i++)
+  {
+    if (statistics[i].function == "Bar")
+    {
+      ASSERT_EQ(0, statistics[i].calls);
+      ASSERT_EQ(0, statistics[i].latency[CALL_PHASE_TOTAL].GetCount());
+    }
+  }
+
+  // Ready to shutdown the server
+  s = object.server.Shutdown();
+  ASSERT_TRUE( s.Success() ) << s.GetDescription();
+
+  // Wait for the shutdown thread to complete
+  thread.Join();
+}
+
+class CallEventServer : public Server
+{
+public:
+  CallEventServer() : num_begin(0), num_end(0), num_invalid(0), last_begin_time(0) {}
+  virtual ~CallEventServer() {}
+
+  virtual void OnEvent(EventCallBegin * e)
+  {
+    num_begin++;
+    if (std::string("Bar") != e->GetFunctionName() || e->GetFunctionIndex() != 0 || e->GetBeginTime() == 0)
+      num_invalid++;
+    last_begin_time = e->GetBeginTime();
+  }
+
+  virtual void OnEvent(EventCallEnd * e)
+  {
+    num_end++;
+    if (std::string("Foo") != e->GetServiceName() || e->GetStatus().GetCode() != STATUS_CODE_SUCCESS || e->GetEndTime() < e->GetBeginTime())
+      num_invalid++;
+
+    // Both events of a call report the same begin time
+    if (e->GetBeginTime() != last_begin_time)
+      num_invalid++;
+  }
+
+  volatile int num_begin;
+  volatile int num_end;
+  volatile int num_invalid;
+  volatile unsigned long long last_begin_time;
+};
+
+class TestCallEventsServer
+{
+public:
+  CallEventServer server;
+  std::string pipe_name;
+
+  TestCallEventsServer() {}
+  ~TestCallEventsServer() {}
+
+  DWORD Run()
+  {
+    Status status = server.Run(pipe_name.c_str());
+    return 0;
+  }
+};
+
+TEST_F(TestPerformance, testCallEvents)
+{
+  TestCallEventsServer object;
+  object.server.RegisterService(new FooServiceImpl());
+  object.pipe_name = GetPipeNameFromTestName();
+
+  ThreadBuilder<TestCallEventsServer> thread(&object, &TestCallEventsServer::Run);
+
+  // Start the thread
+  Status s = thread.Start();
+  ASSERT_TRUE( s.Success() ) << s.GetDescription();
+
+  // Allow time for the server to start listening for connections
+  while(!object.server.IsRunning())
+  {
+    ra::timing::Millisleep(100);
+  }
+  ra::timing::Millisleep(100);
+
+  pbop::PipeConnection * connection = new pbop::PipeConnection();
+  s = connection->Connect(object.pipe_name.c_str());
+  ASSERT_TRUE( s.Success() ) << s.GetDescription();
+
+  performance::Foo::Client client(connection);
+  performance::BarRequest request;
+  performance::BarResponse response;
+
+  // Call events are disabled by default
+  ASSERT_FALSE(object.server.IsCallEventsEnabled());
+  s = client.Bar(request, response);
+  ASSERT_TRUE( s.Success() ) << s.GetDescription();
+  ASSERT_EQ(0, object.server.num_begin);
+  ASSERT_EQ(0, object.server.num_end);
+
+  // Enable call events
+  object.server.SetCallEventsEnabled(true);
+  static const int num_calls = 10;
+  for(int i=0; i<num_calls; i++)
+  {
+    s = client.Bar(request, response);
+    ASSERT_TRUE( s.Success() ) << s.GetDescription();
+  }
+  ASSERT_EQ(num_calls, object.server.num_begin);
+  ASSERT_EQ(num_calls, object.server.num_end);
+  ASSERT_EQ(0, object.server.num_invalid);
+
+  // Ready to shutdown the server
+  s = object.server.Shutdown();
+  ASSERT_TRUE( s.Success() ) << s.GetDescription();
+
+  // Wait for the shutdown thread to complete
+  thread.Join();
+}
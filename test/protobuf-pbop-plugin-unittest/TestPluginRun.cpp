@@ -28,6 +28,8 @@
 #include "rapidassist/process.h"
 #include "rapidassist/environment.h"
 #include "rapidassist/testing.h"
+#include "rapidassist/strings.h"
+#include "rapidassist/timing.h"
 
 #include "TestUtils.h"
 #include "protobuf_locator.h"
@@ -145,3 +147,274 @@ TEST_F(TestPluginRun, testRunPluginAutoDetect)
 #endif
   ASSERT_EQ(0, returnCode) << "The command line '" << cmdline.c_str() << "' returned " << returnCode;
 }
+
+static std::string GetManifestDescriptorHash(const std::string & manifest_path)
+{
+  std::string manifest;
+  if (!ReadTextFile(manifest_path, manifest))
+    return "";
+
+  //find the `descriptor <hash>` line
+  static const std::string prefix = "descriptor ";
+  size_t pos = manifest.find("\n" + prefix);
+  if (pos == std::string::npos)
+    return "";
+  pos += 1 + prefix.size();
+  size_t end = manifest.find_first_of("\r\n", pos);
+  return manifest.substr(pos, end - pos);
+}
+
+TEST_F(TestPluginRun, testRunPluginManifest)
+{
+  static const std::string separator = ra::filesystem::GetPathSeparatorStr();
+  const std::string proto_filename_we = ra::testing::GetTestSuiteName();
+
+  //run the plugin twice with the `manifest` option
+  std::vector<std::string> outdirs;
+  outdirs.push_back(ra::process::GetCurrentProcessDir() + separator + ra::testing::GetTestQualifiedName() + ".1");
+  outdirs.push_back(ra::process::GetCurrentProcessDir() + separator + ra::testing::GetTestQualifiedName() + ".2");
+  for(size_t i=0; i<outdirs.size(); i++)
+  {
+    //create output dir
+    const std::string & outdir = outdirs[i];
+    ASSERT_TRUE( CreateTestDirectory(outdir) );
+
+    //run the plugin
+    std::string cmdline;
+    int returnCode = RunPlugin("manifest", outdir, GetTestProtoPath(), GetTestProtoFilePath(), cmdline);
+    ASSERT_EQ(0, returnCode) << "The command line '" << cmdline.c_str() << "' returned " << returnCode;
+  }
+
+  //both runs must output identical files
+  std::vector<std::string> filenames;
+  filenames.push_back(proto_filename_we + ".pbop.pb.h");
+  filenames.push_back(proto_filename_we + ".pbop.pb.cc");
+  filenames.push_back(proto_filename_we + ".pbop.manifest");
+  for(size_t i=0; i<filenames.size(); i++)
+  {
+    const std::string file1 = outdirs[0] + separator + filenames[i];
+    const std::string file2 = outdirs[1] + separator + filenames[i];
+    ASSERT_TRUE( ra::filesystem::FileExists(file1.c_str()) ) << "File '" << file1 << "' not found.";
+    ASSERT_TRUE( ra::testing::IsFileEquals(file1.c_str(), file2.c_str()) ) << "File '" << file1 << "' is different from file '" << file2 << "'.";
+  }
+}
+
+TEST_F(TestPluginRun, testRunPluginManifestDescriptorHash)
+{
+  static const std::string separator = ra::filesystem::GetPathSeparatorStr();
+
+  //variants of the same proto file
+  enum VARIANT
+  {
+    VARIANT_BASE,
+    VARIANT_UNCHANGED,
+    VARIANT_COMMENT,
+    VARIANT_NEW_METHOD,
+    VARIANT_NEW_SERVICE,
+    NUM_VARIANTS
+  };
+  static const size_t NUM_SERVICES = 2;
+  static const size_t NUM_METHODS = 2;
+
+  std::vector<std::string> hashes;
+  for(size_t i=0; i<NUM_VARIANTS; i++)
+  {
+    //create output dir
+    const std::string outdir = ra::process::GetCurrentProcessDir() + separator + ra::testing::GetTestQualifiedName() + "." + ra::strings::ToString(i);
+    ASSERT_TRUE( CreateTestDirectory(outdir) );
+
+    //synthesize the proto file. All variants must share the same file name.
+    const std::string proto_path = outdir + separator + "ManifestProto.proto";
+    size_t num_services = (i == VARIANT_NEW_SERVICE ? NUM_SERVICES + 1 : NUM_SERVICES);
+    size_t num_methods = (i == VARIANT_NEW_METHOD ? NUM_METHODS + 1 : NUM_METHODS);
+    ASSERT_TRUE( WriteTestServicesProto(proto_path, "manifestproto", num_services, num_methods) );
+    if (i == VARIANT_COMMENT)
+    {
+      FILE * f = fopen(proto_path.c_str(), "a");
+      ASSERT_TRUE( f != NULL );
+      fprintf(f, "// This comment does not change the generated code.\n");
+      fclose(f);
+    }
+
+    //run the plugin
+    std::string cmdline;
+    int returnCode = RunPlugin("manifest", outdir, outdir, proto_path, cmdline);
+    ASSERT_EQ(0, returnCode) << "The command line '" << cmdline.c_str() << "' returned " << returnCode;
+
+    const std::string manifest_path = outdir + separator + "ManifestProto.pbop.manifest";
+    std::string hash = GetManifestDescriptorHash(manifest_path);
+    ASSERT_FALSE( hash.empty() ) << "Descriptor hash not found in file '" << manifest_path << "'.";
+    hashes.push_back(hash);
+  }
+
+  //the hash only changes when a service or a method changes
+  ASSERT_EQ(hashes[VARIANT_BASE], hashes[VARIANT_UNCHANGED]);
+  ASSERT_EQ(hashes[VARIANT_BASE], hashes[VARIANT_COMMENT]);
+  ASSERT_NE(hashes[VARIANT_BASE], hashes[VARIANT_NEW_METHOD]);
+  ASSERT_NE(hashes[VARIANT_BASE], hashes[VARIANT_NEW_SERVICE]);
+  ASSERT_NE(hashes[VARIANT_NEW_METHOD], hashes[VARIANT_NEW_SERVICE]);
+}
+
+TEST_F(TestPluginRun, testRunPluginOptions)
+{
+  static const std::string separator = ra::filesystem::GetPathSeparatorStr();
+
+  std::vector<std::string> valid_options;
+  valid_options.push_back("client_only");
+  valid_options.push_back("server_only");
+  valid_options.push_back("client_only,no_virtual");
+  valid_options.push_back("server_only,arena");
+  valid_options.push_back("crtp,arena,debug");
+  valid_options.push_back("split_services");
+  valid_options.push_back("methods_per_file=2,server_only");
+
+  std::vector<std::string> invalid_options;
+  invalid_options.push_back("client_only,server_only");
+  invalid_options.push_back("client_only,crtp");
+  invalid_options.push_back("foobar");
+  invalid_options.push_back("methods_per_file=0");
+  invalid_options.push_back("methods_per_file=abc");
+
+  std::vector<std::string> all_options;
+  all_options.insert(all_options.end(), valid_options.begin(), valid_options.end());
+  all_options.insert(all_options.end(), invalid_options.begin(), invalid_options.end());
+  for(size_t i=0; i<all_options.size(); i++)
+  {
+    const std::string & options = all_options[i];
+    const bool valid = (i < valid_options.size());
+
+    //create output dir
+    std::string outdir = ra::process::GetCurrentProcessDir() + separator + ra::testing::GetTestQualifiedName() + "." + ra::strings::ToString(i);
+    if (ra::filesystem::DirectoryExists(outdir.c_str()))
+      ASSERT_TRUE( ra::filesystem::DeleteDirectory(outdir.c_str()) );
+#if _WIN32
+    while(ra::filesystem::DirectoryExists(outdir.c_str())) {}
+#endif
+    ASSERT_TRUE( ra::filesystem::CreateDirectory(outdir.c_str()) );
+
+    //build
+    std::string cmdline;
+    cmdline.append("protoc.exe --plugin=protoc-gen-");
+    cmdline.append(GetPluginShortName());
+    cmdline.append("=");
+    cmdline.append(GetPluginFilePath());
+    cmdline.append(" --");
+    cmdline.append(GetPluginShortName());
+    cmdline.append("_out=");
+    cmdline.append(options);
+    cmdline.append(":");
+    cmdline.append(outdir);
+    cmdline.append(" --proto_path=");
+    cmdline.append(GetTestProtoPath());
+    cmdline.append(" ");
+    cmdline.append(GetTestProtoFilePath());
+
+    //run the command
+    printf("%s\n", cmdline.c_str());
+    int returnCode = system(cmdline.c_str());
+#ifdef __linux__
+    returnCode = WEXITSTATUS(returnCode);
+#endif
+    if (valid)
+      ASSERT_EQ(0, returnCode) << "The command line '" << cmdline.c_str() << "' returned " << returnCode;
+    else
+      ASSERT_NE(0, returnCode) << "The command line '" << cmdline.c_str() << "' should have failed with options '" << options << "'.";
+  }
+}
+
+TEST_F(TestPluginRun, testRunPluginSplitServices)
+{
+  static const std::string separator = ra::filesystem::GetPathSeparatorStr();
+  static const size_t NUM_SERVICES = 3;
+  static const size_t NUM_METHODS = 5;
+
+  //create output dir
+  std::string outdir = ra::process::GetCurrentProcessDir() + separator + ra::testing::GetTestQualifiedName();
+  ASSERT_TRUE( CreateTestDirectory(outdir) );
+
+  //synthesize a proto file with multiple services
+  const std::string proto_path = outdir + separator + "SplitProto.proto";
+  ASSERT_TRUE( WriteTestServicesProto(proto_path, "splitproto", NUM_SERVICES, NUM_METHODS) );
+
+  //run the plugin
+  std::string cmdline;
+  int returnCode = RunPlugin("methods_per_file=2", outdir, outdir, proto_path, cmdline);
+  ASSERT_EQ(0, returnCode) << "The command line '" << cmdline.c_str() << "' returned " << returnCode;
+
+  //each service outputs 3 source files of 2 methods or less
+  std::vector<std::string> filenames;
+  filenames.push_back("SplitProto.pbop.pb.h");
+  filenames.push_back("SplitProto.pbop.pb.cc");
+  for(size_t i=0; i<NUM_SERVICES; i++)
+  {
+    const std::string service_name = "Service" + ra::strings::ToString(i);
+    filenames.push_back("SplitProto.pbop." + service_name + ".pb.cc");
+    filenames.push_back("SplitProto.pbop." + service_name + ".1.pb.cc");
+    filenames.push_back("SplitProto.pbop." + service_name + ".2.pb.cc");
+  }
+  for(size_t i=0; i<filenames.size(); i++)
+  {
+    const std::string file_path = outdir + separator + filenames[i];
+    ASSERT_TRUE( ra::filesystem::FileExists(file_path.c_str()) ) << "File '" << file_path << "' not found.";
+  }
+  const std::string unexpected_file_path = outdir + separator + "SplitProto.pbop.Service0.3.pb.cc";
+  ASSERT_FALSE( ra::filesystem::FileExists(unexpected_file_path.c_str()) ) << "File '" << unexpected_file_path << "' should not be generated.";
+}
+
+TEST_F(TestPluginRun, testRunPluginLargeProto)
+{
+  static const std::string separator = ra::filesystem::GetPathSeparatorStr();
+  static const size_t NUM_SMALL_SERVICES = 50;
+  static const size_t NUM_LARGE_SERVICES = 500;
+  static const size_t NUM_METHODS = 10;
+
+  //create output dirs
+  const std::string small_outdir = ra::process::GetCurrentProcessDir() + separator + ra::testing::GetTestQualifiedName() + ".small";
+  const std::string large_outdir = ra::process::GetCurrentProcessDir() + separator + ra::testing::GetTestQualifiedName() + ".large";
+  ASSERT_TRUE( CreateTestDirectory(small_outdir) );
+  ASSERT_TRUE( CreateTestDirectory(large_outdir) );
+
+  //synthesize a small and a large proto file
+  const std::string small_proto_path = small_outdir + separator + "LargeProto.proto";
+  const std::string large_proto_path = large_outdir + separator + "LargeProto.proto";
+  ASSERT_TRUE( WriteTestServicesProto(small_proto_path, "largeproto", NUM_SMALL_SERVICES, NUM_METHODS) );
+  ASSERT_TRUE( WriteTestServicesProto(large_proto_path, "largeproto", NUM_LARGE_SERVICES, NUM_METHODS) );
+
+  //run the plugin on both files
+  std::string cmdline;
+  double small_start_time = ra::timing::GetMillisecondsTimer();
+  int returnCode = RunPlugin("crtp", small_outdir, small_outdir, small_proto_path, cmdline);
+  double small_elapsed_time = ra::timing::GetMillisecondsTimer() - small_start_time;
+  ASSERT_EQ(0, returnCode) << "The command line '" << cmdline.c_str() << "' returned " << returnCode;
+
+  double large_start_time = ra::timing::GetMillisecondsTimer();
+  returnCode = RunPlugin("crtp", large_outdir, large_outdir, large_proto_path, cmdline);
+  double large_elapsed_time = ra::timing::GetMillisecondsTimer() - large_start_time;
+  ASSERT_EQ(0, returnCode) << "The command line '" << cmdline.c_str() << "' returned " << returnCode;
+
+  printf("Generated %u services in %.3f seconds.\n", (unsigned int)NUM_SMALL_SERVICES, small_elapsed_time);
+  printf("Generated %u services in %.3f seconds.\n", (unsigned int)NUM_LARGE_SERVICES, large_elapsed_time);
+
+  //the generated code grows linearly with the number of services.
+  //With 10 times more services, a linear emission of the code takes about 10 times longer.
+  //A super-linear emission takes about 100 times longer. The budget is generous to tolerate a loaded machine.
+  const double scale = double(NUM_LARGE_SERVICES) / double(NUM_SMALL_SERVICES);
+  ASSERT_LT(large_elapsed_time, 3.0 * scale * small_elapsed_time + 1.0);
+
+  //assert the generated files are complete.
+  char last_service[64];
+  sprintf(last_service, "Service%u", (unsigned int)(NUM_LARGE_SERVICES - 1));
+  char last_method[64];
+  sprintf(last_method, "Method%u", (unsigned int)(NUM_METHODS - 1));
+
+  std::string header;
+  const std::string header_path = large_outdir + separator + "LargeProto.pbop.pb.h";
+  ASSERT_TRUE( ReadTextFile(header_path, header) ) << "File '" << header_path << "' not found.";
+  ASSERT_NE(std::string::npos, header.find(std::string("class ") + last_service + " {"));
+  ASSERT_NE(std::string::npos, header.find(std::string("}; // class ") + last_service));
+
+  std::string source;
+  const std::string source_path = large_outdir + separator + "LargeProto.pbop.pb.cc";
+  ASSERT_TRUE( ReadTextFile(source_path, source) ) << "File '" << source_path << "' not found.";
+  ASSERT_NE(std::string::npos, source.find(std::string(last_service) + "::Client::" + last_method + "("));
+}
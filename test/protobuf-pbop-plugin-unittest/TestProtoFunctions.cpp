@@ -125,3 +125,86 @@ TEST_F(TestProtoFunctions, testToProtoString)
   std::string protoString2 = pbop::ToProtoString(*desc);
   ASSERT_EQ(protoString, protoString2);
 }
+
+static const size_t NUM_CHAIN_FILES = 50;
+
+// Build a chain of files in a pool where each file imports the 2 previous files of the chain.
+std::vector<const FileDescriptor *> buildChainProtoFiles(DescriptorPool & pool, size_t count)
+{
+  std::vector<const FileDescriptor *> files;
+  for(size_t i=0; i<count; i++)
+  {
+    char name[64];
+    FileDescriptorProto tmp;
+    sprintf(name, "chain%u.proto", (unsigned int)i);
+    tmp.set_name(name);
+    tmp.set_package("chain");
+    for(size_t j=(i > 2 ? i - 2 : 0); j<i; j++)
+    {
+      tmp.add_dependency(files[j]->name());
+    }
+
+    DescriptorProto* message = tmp.add_message_type();
+    sprintf(name, "Message%u", (unsigned int)i);
+    message->set_name(name);
+
+    const FileDescriptor * file = pool.BuildFile(tmp);
+    if (file == NULL)
+      break;
+    files.push_back(file);
+  }
+  return files;
+}
+
+TEST_F(TestProtoFunctions, testAddFileDescriptorToPool)
+{
+  //Each file is built once. Rebuilding the dependencies of
+  //each import would build the first files of the chain billions of times.
+  DescriptorPool source_pool;
+  std::vector<const FileDescriptor *> files = buildChainProtoFiles(source_pool, NUM_CHAIN_FILES);
+  ASSERT_EQ(NUM_CHAIN_FILES, files.size());
+
+  DescriptorPool pool;
+  const FileDescriptor * last = pbop::AddFileDescriptorToPool(pool, *files.back(), true);
+  ASSERT_TRUE(last != NULL);
+  ASSERT_EQ(files.back()->name(), last->name());
+  for(size_t i=0; i<files.size(); i++)
+  {
+    ASSERT_TRUE(pool.FindFileByName(files[i]->name()) != NULL) << "File '" << files[i]->name() << "' not found.";
+  }
+
+  //the files already in the pool are reused
+  ASSERT_EQ(last, pbop::AddFileDescriptorToPool(pool, *files.back(), true));
+  ASSERT_EQ(last->dependency(1), pbop::AddFileDescriptorToPool(pool, *files[files.size() - 2], true));
+
+  //dependencies only
+  DescriptorPool dependencies_pool;
+  ASSERT_TRUE(pbop::AddFileDescriptorToPool(dependencies_pool, *files.back(), false) == NULL);
+  ASSERT_TRUE(dependencies_pool.FindFileByName(files[files.size() - 1]->name()) == NULL);
+  ASSERT_TRUE(dependencies_pool.FindFileByName(files[files.size() - 2]->name()) != NULL);
+}
+
+TEST_F(TestProtoFunctions, testDescriptorPoolCache)
+{
+  DescriptorPool source_pool;
+  std::vector<const FileDescriptor *> files = buildChainProtoFiles(source_pool, NUM_CHAIN_FILES);
+  ASSERT_EQ(NUM_CHAIN_FILES, files.size());
+
+  //add the files from the last to the first
+  pbop::DescriptorPoolCache cache;
+  for(size_t i=files.size(); i>0; i--)
+  {
+    const FileDescriptor * file = files[i - 1];
+    const FileDescriptor * cached = cache.AddFile(*file);
+    ASSERT_TRUE(cached != NULL);
+    ASSERT_EQ(file->name(), cached->name());
+    ASSERT_EQ(cached, cache.FindFileByName(file->name()));
+  }
+
+  //the dependencies are shared by the files of the cache
+  const FileDescriptor * last = cache.FindFileByName(files[files.size() - 1]->name());
+  ASSERT_EQ(cache.FindFileByName(files[files.size() - 2]->name()), last->dependency(1));
+  ASSERT_EQ(cache.FindFileByName(files[files.size() - 3]->name()), last->dependency(0));
+
+  ASSERT_TRUE(cache.FindFileByName("unknown.proto") == NULL);
+}
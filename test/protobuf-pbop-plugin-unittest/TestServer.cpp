@@ -36,6 +36,9 @@
 
 #include "pbop/Thread.h"
 #include "pbop/ThreadBuilder.h"
+#include "pbop/Processors.h"
+#include "pbop/CriticalSection.h"
+#include "pbop/ScopeLock.h"
 
 using namespace pbop;
 
@@ -383,3 +386,94 @@ TEST_F(TestServer, testEventsConnection)
 
   int a = 0;
 }
+
+class MyPlacementServer : public Server
+{
+public:
+  MyPlacementServer() {}
+  virtual ~MyPlacementServer() {}
+
+  // Called from the session's thread
+  virtual void OnEvent(EventClientCreate * e)
+  {
+    ScopeLock scope_lock(&lock_);
+    session_processors_.push_back(GetCurrentProcessor());
+  }
+
+  std::vector<unsigned int> GetSessionProcessors()
+  {
+    ScopeLock scope_lock(&lock_);
+    return session_processors_;
+  }
+
+private:
+  CriticalSection lock_;
+  std::vector<unsigned int> session_processors_;
+};
+
+class TestSessionPlacement
+{
+public:
+  MyPlacementServer server;
+  std::string pipe_name;
+
+  DWORD Run()
+  {
+    Status status = server.Run(pipe_name.c_str());
+    return 0;
+  }
+};
+
+TEST_F(TestServer, testSessionPlacement)
+{
+  TestSessionPlacement object;
+  object.pipe_name = GetPipeNameFromTestName();
+
+  ASSERT_EQ(Server::PLACEMENT_NONE, object.server.GetSessionPlacement());
+  object.server.SetSessionPlacement(Server::PLACEMENT_ROUND_ROBIN, Server::PLACEMENT_UNIT_PROCESSOR);
+  ASSERT_EQ(Server::PLACEMENT_ROUND_ROBIN, object.server.GetSessionPlacement());
+  ASSERT_EQ(Server::PLACEMENT_UNIT_PROCESSOR, object.server.GetPlacementUnit());
+
+  ThreadBuilder<TestSessionPlacement> thread(&object, &TestSessionPlacement::Run);
+  Status s = thread.Start();
+  ASSERT_TRUE( s.Success() ) << s.GetDescription();
+
+  // Allow time for the server to start listening for connections
+  while(!object.server.IsRunning())
+  {
+    ra::timing::Millisleep(100);
+  }
+  ra::timing::Millisleep(100);
+
+  // Connect multiple clients
+  static const size_t num_connections = 3;
+  std::vector<PipeConnection *> connections;
+  for(size_t i=0; i<num_connections; i++)
+  {
+    PipeConnection * pipe = new PipeConnection;
+    Status s = pipe->Connect(object.pipe_name.c_str());
+    ASSERT_TRUE( s.Success() ) << s.GetDescription();
+    connections.push_back(pipe);
+
+    //Wait for the server to process this connection
+    ra::timing::Millisleep(300);
+  }
+
+  // Expect each session to be pinned to the next processor of the process
+  std::vector<unsigned int> processors = object.server.GetSessionProcessors();
+  ASSERT_EQ(num_connections, processors.size());
+  std::vector<unsigned int> process_processors;
+  ASSERT_TRUE( GetProcessProcessors(process_processors) );
+  for(size_t i=0; i<processors.size(); i++)
+  {
+    ASSERT_EQ(process_processors[i % process_processors.size()], processors[i]);
+  }
+
+  for(size_t i=0; i<connections.size(); i++)
+  {
+    delete connections[i];
+  }
+
+  object.server.Shutdown();
+  thread.Join();
+}
@@ -0,0 +1,129 @@
+/**********************************************************************************
+ * MIT License
+ * 
+ * Copyright (c) 2018 Antoine Beauchamp
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#include "TestServiceTemplate.h"
+
+#ifdef _WIN32
+//google/protobuf/io/coded_stream.h(869): warning C4800: 'google::protobuf::internal::Atomic32' : forcing value to bool 'true' or 'false' (performance warning)
+//google/protobuf/wire_format_lite.h(863): warning C4146: unary minus operator applied to unsigned type, result still unsigned
+//google/protobuf/wire_format_lite.h(874): warning C4146: unary minus operator applied to unsigned type, result still unsigned
+//google/protobuf/generated_message_util.h(160): warning C4800: 'const google::protobuf::uint32' : forcing value to bool 'true' or 'false' (performance warning)
+__pragma( warning(push) )
+__pragma( warning(disable: 4800))
+__pragma( warning(disable: 4146))
+#endif //_WIN32
+
+#include "TestServiceTemplate.pb.h"
+#include "TestServiceTemplate.pbop.pb.h"
+
+#ifdef _WIN32
+__pragma( warning(pop) )
+#endif //_WIN32
+
+using namespace pbop;
+
+void TestServiceTemplate::SetUp()
+{
+}
+
+void TestServiceTemplate::TearDown()
+{
+}
+
+class CalculatorImpl : public servicetemplate::Calculator::ServiceT<CalculatorImpl>
+{
+public:
+  CalculatorImpl() {}
+  virtual ~CalculatorImpl() {}
+
+  // Negate() is intentionally not implemented
+  pbop::Status Add(const servicetemplate::AddRequest & request, servicetemplate::AddResponse & response)
+  {
+    response.set_sum(request.left() + request.right());
+    return Status::OK;
+  }
+};
+
+TEST_F(TestServiceTemplate, testFunctionIdentifiers)
+{
+  CalculatorImpl impl;
+
+  ASSERT_STREQ("servicetemplate", impl.GetPackageName());
+  ASSERT_STREQ("Calculator", impl.GetServiceName());
+
+  const char ** identifiers = impl.GetFunctionIdentifiers();
+  ASSERT_TRUE(identifiers != NULL);
+  ASSERT_STREQ("Add", identifiers[0]);
+  ASSERT_STREQ("Negate", identifiers[1]);
+  ASSERT_TRUE(identifiers[2] == NULL);
+}
+
+TEST_F(TestServiceTemplate, testInvokeMethod)
+{
+  CalculatorImpl impl;
+  pbop::Service * service = &impl;
+
+  servicetemplate::AddRequest request;
+  request.set_left(3);
+  request.set_right(4);
+  std::string input = request.SerializeAsString();
+
+  std::string output;
+  Status s = service->InvokeMethod(0, input, output);
+  ASSERT_EQ(STATUS_CODE_SUCCESS, s.GetCode()) << s.GetDescription();
+
+  servicetemplate::AddResponse response;
+  ASSERT_TRUE(response.ParseFromString(output));
+  ASSERT_EQ(7, response.sum());
+}
+
+TEST_F(TestServiceTemplate, testNotImplemented)
+{
+  CalculatorImpl impl;
+  pbop::Service * service = &impl;
+
+  // Method not implemented by CalculatorImpl
+  std::string output;
+  Status s = service->InvokeMethod(1, "", output);
+  ASSERT_EQ(STATUS_CODE_NOT_IMPLEMENTED, s.GetCode());
+
+  // Method index out of range
+  s = service->InvokeMethod(2, "", output);
+  ASSERT_EQ(STATUS_CODE_NOT_IMPLEMENTED, s.GetCode());
+}
+
+TEST_F(TestServiceTemplate, testDeserializationError)
+{
+  CalculatorImpl impl;
+  pbop::Service * service = &impl;
+
+  // Truncated varint
+  std::string input;
+  input += (char)0x08;
+  input += (char)0xFF;
+
+  std::string output;
+  Status s = service->InvokeMethod(0, input, output);
+  ASSERT_EQ(STATUS_CODE_DESERIALIZE_ERROR, s.GetCode());
+}
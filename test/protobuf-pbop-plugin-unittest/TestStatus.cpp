@@ -26,6 +26,22 @@
 #include "pbop/Status.h"
 #include "rapidassist/testing.h"
 
+#ifdef _WIN32
+//google/protobuf/io/coded_stream.h(869): warning C4800: 'google::protobuf::internal::Atomic32' : forcing value to bool 'true' or 'false' (performance warning)
+//google/protobuf/wire_format_lite.h(863): warning C4146: unary minus operator applied to unsigned type, result still unsigned
+//google/protobuf/wire_format_lite.h(874): warning C4146: unary minus operator applied to unsigned type, result still unsigned
+//google/protobuf/generated_message_util.h(160): warning C4800: 'const google::protobuf::uint32' : forcing value to bool 'true' or 'false' (performance warning)
+__pragma( warning(push) )
+__pragma( warning(disable: 4800))
+__pragma( warning(disable: 4146))
+#endif //_WIN32
+
+#include "pbop/pbop.pb.h"
+
+#ifdef _WIN32
+__pragma( warning(pop) )
+#endif //_WIN32
+
 using namespace pbop;
 
 void TestStatus::SetUp()
@@ -164,6 +180,107 @@ TEST_F(TestStatus, testOperatorEqualsEquals)
   }
 }
 
+TEST_F(TestStatus, testMove)
+{
+  StatusCode code = pbop::STATUS_CODE_INVALID_ARGUMENT;
+  std::string message = ra::testing::GetTestQualifiedName();
+
+  //test move ctor
+  {
+    Status s1(code, message);
+    Status s2(std::move(s1));
+    ASSERT_EQ(code, s2.GetCode());
+    ASSERT_EQ(message, s2.GetDescription());
+    ASSERT_EQ("", s1.GetDescription());
+  }
+
+  //test move assignment
+  {
+    Status s1(code, message);
+    Status s2(pbop::STATUS_CODE_OUT_OF_MEMORY, "foobar");
+    s2 = std::move(s1);
+    ASSERT_EQ(code, s2.GetCode());
+    ASSERT_EQ(message, s2.GetDescription());
+  }
+
+  //test self assignment
+  {
+    Status s1(code, message);
+    Status & s2 = s1;
+    s1 = s2;
+    ASSERT_EQ(code, s1.GetCode());
+    ASSERT_EQ(message, s1.GetDescription());
+  }
+}
+
+TEST_F(TestStatus, testEmptyDescription)
+{
+  //a description can be cleared
+  Status s1(pbop::STATUS_CODE_INVALID_ARGUMENT, "foobar");
+  s1.SetDescription("");
+  ASSERT_EQ("", s1.GetDescription());
+
+  //copying a status without description
+  Status s2(pbop::STATUS_CODE_SUCCESS, "");
+  Status s3(pbop::STATUS_CODE_OUT_OF_MEMORY, "foobar");
+  s3 = s2;
+  ASSERT_EQ(pbop::STATUS_CODE_SUCCESS, s3.GetCode());
+  ASSERT_EQ("", s3.GetDescription());
+  ASSERT_TRUE(s2 == s3);
+
+  //Status::OK does not have a description
+  Status s4 = Status::OK;
+  ASSERT_TRUE( s4.Success() );
+  ASSERT_EQ("", s4.GetDescription());
+}
+
+TEST_F(TestStatus, testFactory)
+{
+  pbop::StatusMessage message;
+
+  //the description is formatted from the given function and message type
+  Status s1 = Status::Factory::MissingField("MyFunction", "code", message);
+  ASSERT_EQ(pbop::STATUS_CODE_DESERIALIZE_ERROR, s1.GetCode());
+  const std::string & description = s1.GetDescription();
+  ASSERT_NE(std::string::npos, description.find("MyFunction"));
+  ASSERT_NE(std::string::npos, description.find("'code'"));
+  ASSERT_NE(std::string::npos, description.find("pbop.StatusMessage"));
+
+  //copies made before the description is formatted have the same description
+  Status s2 = Status::Factory::Serialization("MyFunction", message);
+  Status s3 = s2;
+  Status s4;
+  s4 = s2;
+  ASSERT_EQ(pbop::STATUS_CODE_SERIALIZE_ERROR, s3.GetCode());
+  ASSERT_NE(std::string::npos, s2.GetDescription().find("pbop.StatusMessage"));
+  ASSERT_EQ(s2.GetDescription(), s3.GetDescription());
+  ASSERT_EQ(s2.GetDescription(), s4.GetDescription());
+
+  //a new description replaces the formatted one
+  Status s5 = Status::Factory::NotImplemented("MyFunction");
+  s5.SetDescription("foobar");
+  ASSERT_EQ("foobar", s5.GetDescription());
+
+  Status s6 = Status::Factory::OutOfMemory("MyFunction");
+  ASSERT_EQ(pbop::STATUS_CODE_OUT_OF_MEMORY, s6.GetCode());
+  ASSERT_NE(std::string::npos, s6.GetDescription().find("MyFunction"));
+
+  //a full message given as a MessageLite is identified by its descriptor
+  const ::google::protobuf::MessageLite & lite_message = message;
+  Status s7 = Status::Factory::Deserialization("MyFunction", lite_message);
+  ASSERT_EQ(pbop::STATUS_CODE_DESERIALIZE_ERROR, s7.GetCode());
+  ASSERT_NE(std::string::npos, s7.GetDescription().find("pbop.StatusMessage"));
+
+  //copies of a formatted description or of a new description
+  Status s8 = s1;
+  ASSERT_EQ(s1.GetDescription(), s8.GetDescription());
+  Status s9 = s5;
+  ASSERT_EQ("foobar", s9.GetDescription());
+  s9 = s2;
+  ASSERT_EQ(pbop::STATUS_CODE_SERIALIZE_ERROR, s9.GetCode());
+  ASSERT_EQ(s2.GetDescription(), s9.GetDescription());
+}
+
 std::string ToStringLocal(const StatusCode & code)
 {
   const char * name = Status::ToString(code);
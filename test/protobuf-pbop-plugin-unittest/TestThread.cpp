@@ -29,6 +29,7 @@
 
 #include "pbop/Thread.h"
 #include "pbop/ThreadBuilder.h"
+#include "pbop/Processors.h"
 
 #include "rapidassist/testing.h"
 #include "rapidassist/timing.h"
@@ -277,3 +278,101 @@ TEST_F(TestThread, testJoin)
   // Call join again. Expect the call to be non-clocking since the thread is terminated
   thread.Join();
 }
+
+class ProcessorObject
+{
+public:
+  ProcessorObject() : processor_(0) {}
+
+  DWORD Run()
+  {
+    // Give the scheduler a chance to move the thread
+    Sleep(50);
+    processor_ = GetCurrentProcessor();
+    return 0;
+  }
+
+  unsigned int processor_;
+};
+
+TEST_F(TestThread, testProperties)
+{
+  SleepObject object(0);
+
+  ThreadBuilder<SleepObject> thread(&object, &SleepObject::Run);
+
+  ASSERT_STREQ("", thread.GetName());
+  ASSERT_EQ(0, thread.GetStackSize());
+  ASSERT_TRUE(thread.GetAffinity().empty());
+
+  thread.SetName("pbop-test");
+  thread.SetStackSize(256*1024);
+  thread.SetAffinity(std::vector<unsigned int>(1, 0));
+
+  ASSERT_STREQ("pbop-test", thread.GetName());
+  ASSERT_EQ(256*1024, thread.GetStackSize());
+  ASSERT_EQ(1, thread.GetAffinity().size());
+
+  // Start the thread with the new properties
+  Status s = thread.Start();
+  ASSERT_TRUE( s.Success() ) << s.GetDescription();
+
+  thread.Join();
+}
+
+TEST_F(TestThread, testAffinity)
+{
+  std::vector<unsigned int> process_processors;
+  ASSERT_TRUE( GetProcessProcessors(process_processors) );
+  ASSERT_FALSE( process_processors.empty() );
+  ASSERT_LE(process_processors.size(), GetProcessorCount());
+
+  // Pin the thread to the last processor of the process
+  unsigned int expected_processor = process_processors.back();
+
+  ProcessorObject object;
+  ThreadBuilder<ProcessorObject> thread(&object, &ProcessorObject::Run);
+  thread.SetAffinity(std::vector<unsigned int>(1, expected_processor));
+
+  Status s = thread.Start();
+  ASSERT_TRUE( s.Success() ) << s.GetDescription();
+
+  thread.Join();
+
+  ASSERT_EQ(expected_processor, object.processor_);
+}
+
+TEST_F(TestThread, testInvalidAffinity)
+{
+  ProcessorObject object;
+  ThreadBuilder<ProcessorObject> thread(&object, &ProcessorObject::Run);
+  thread.SetAffinity(std::vector<unsigned int>(1, 100000));
+
+  // Assert a thread that cannot be pinned is not started
+  Status s = thread.Start();
+  ASSERT_FALSE( s.Success() );
+  ASSERT_FALSE( thread.IsRunning() );
+
+  // Assert the thread starts once unpinned
+  thread.SetAffinity(std::vector<unsigned int>());
+  s = thread.Start();
+  ASSERT_TRUE( s.Success() ) << s.GetDescription();
+  thread.Join();
+}
+
+TEST_F(TestThread, testNumaNodes)
+{
+  unsigned int num_nodes = GetNumaNodeCount();
+  ASSERT_GE(num_nodes, 1);
+
+  // Each processor should belong to at most one node
+  std::vector<unsigned int> all_processors;
+  for(unsigned int i=0; i<num_nodes; i++)
+  {
+    std::vector<unsigned int> processors;
+    if (GetNumaNodeProcessors(i, processors))
+      all_processors.insert(all_processors.end(), processors.begin(), processors.end());
+  }
+  ASSERT_FALSE(all_processors.empty());
+  ASSERT_LE(all_processors.size(), GetProcessorCount());
+}
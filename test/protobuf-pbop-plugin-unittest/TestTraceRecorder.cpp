@@ -0,0 +1,141 @@
+/**********************************************************************************
+ * MIT License
+ * 
+ * Copyright (c) 2018 Antoine Beauchamp
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#include "TestTraceRecorder.h"
+
+#include "pbop/TraceRecorder.h"
+#include "pbop/Thread.h"
+#include "pbop/ThreadBuilder.h"
+
+using namespace pbop;
+
+void TestTraceRecorder::SetUp()
+{
+  TraceRecorder::Disable();
+  TraceRecorder::Clear();
+}
+
+void TestTraceRecorder::TearDown()
+{
+  TraceRecorder::Disable();
+  TraceRecorder::Clear();
+}
+
+class TraceRecordingThread
+{
+public:
+  size_t num_scopes;
+
+  TraceRecordingThread() : num_scopes(0) {}
+
+  unsigned long Run()
+  {
+    for(size_t i=0; i<num_scopes; i++)
+    {
+      TraceScope trace(TRACE_PHASE_EXECUTE, 7, "Bar");
+    }
+    return 0;
+  }
+};
+
+TEST_F(TestTraceRecorder, testDisabled)
+{
+  ASSERT_FALSE(TraceRecorder::IsEnabled());
+  {
+    TraceScope trace(TRACE_PHASE_CLIENT_CALL, 0, "Bar");
+  }
+  ASSERT_EQ(0, TraceRecorder::GetRecordCount());
+}
+
+TEST_F(TestTraceRecorder, testRecord)
+{
+  TraceRecorder::Enable(TraceRecorder::DEFAULT_CAPACITY);
+  ASSERT_TRUE(TraceRecorder::IsEnabled());
+  {
+    TraceScope trace(TRACE_PHASE_CLIENT_CALL, 0, "Bar");
+  }
+  TraceRecorder::Disable();
+  ASSERT_EQ(2, TraceRecorder::GetRecordCount());
+
+  std::string json = TraceRecorder::ToChromeTrace();
+  ASSERT_NE(std::string::npos, json.find("\"traceEvents\""));
+  ASSERT_NE(std::string::npos, json.find("\"name\": \"client_call Bar\""));
+  ASSERT_NE(std::string::npos, json.find("\"ph\": \"B\""));
+  ASSERT_NE(std::string::npos, json.find("\"ph\": \"E\""));
+
+  TraceRecorder::Clear();
+  ASSERT_EQ(0, TraceRecorder::GetRecordCount());
+}
+
+TEST_F(TestTraceRecorder, testRingBuffer)
+{
+  //each new thread gets a buffer of 16 records
+  static const size_t capacity = 16;
+  TraceRecorder::Enable(capacity);
+
+  TraceRecordingThread recording;
+  recording.num_scopes = 100;
+  ThreadBuilder<TraceRecordingThread> thread(&recording, &TraceRecordingThread::Run);
+  Status s = thread.Start();
+  ASSERT_TRUE( s.Success() ) << s.GetDescription();
+  thread.Join();
+  TraceRecorder::Disable();
+
+  //only the most recent records are kept
+  ASSERT_EQ(capacity, TraceRecorder::GetRecordCount());
+
+  std::string json = TraceRecorder::ToChromeTrace();
+  ASSERT_NE(std::string::npos, json.find("\"name\": \"execute Bar\""));
+  ASSERT_NE(std::string::npos, json.find("\"connection_id\": 7"));
+}
+
+TEST_F(TestTraceRecorder, testBufferReuse)
+{
+  static const size_t capacity = 16;
+  TraceRecorder::Enable(capacity);
+
+  //threads that run one after the other share the same buffer
+  std::string previous_json;
+  for(size_t i=0; i<3; i++)
+  {
+    TraceRecordingThread recording;
+    recording.num_scopes = 5;
+    ThreadBuilder<TraceRecordingThread> thread(&recording, &TraceRecordingThread::Run);
+    Status s = thread.Start();
+    ASSERT_TRUE( s.Success() ) << s.GetDescription();
+    thread.Join();
+
+    //the records of the previous thread are discarded when its buffer is reused
+    ASSERT_EQ(10, TraceRecorder::GetRecordCount());
+
+    //each thread gets its own thread id
+    std::string json = TraceRecorder::ToChromeTrace();
+    size_t tid_pos = json.find("\"tid\": ");
+    ASSERT_NE(std::string::npos, tid_pos);
+    std::string tid = json.substr(tid_pos, json.find(',', tid_pos) - tid_pos);
+    ASSERT_EQ(std::string::npos, previous_json.find(tid));
+    previous_json = json;
+  }
+  TraceRecorder::Disable();
+}
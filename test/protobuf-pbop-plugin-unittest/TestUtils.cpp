@@ -31,6 +31,8 @@
 #include "rapidassist/process.h"
 
 #include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
 
 static const char * PROTOBUF_PBOP_PLUGIN_NAME = "protobuf-pbop-plugin";
 
@@ -221,3 +223,88 @@ bool IsFolderEquals(const std::string & folderA, const std::string & folderB)
 
   return true;
 }
+
+bool CreateTestDirectory(const std::string & path)
+{
+  //start from an empty directory
+  if (ra::filesystem::DirectoryExists(path.c_str()))
+  {
+    if (!ra::filesystem::DeleteDirectory(path.c_str()))
+      return false;
+  }
+#if _WIN32
+  while(ra::filesystem::DirectoryExists(path.c_str())) {}
+#endif
+  if (!ra::filesystem::CreateDirectory(path.c_str()))
+    return false;
+  return ra::filesystem::DirectoryExists(path.c_str());
+}
+
+bool WriteTestServicesProto(const std::string & path, const std::string & package, size_t num_services, size_t num_methods)
+{
+  FILE * f = fopen(path.c_str(), "w");
+  if (f == NULL)
+    return false;
+  fprintf(f, "syntax = \"proto3\";\n");
+  fprintf(f, "package %s;\n", package.c_str());
+  fprintf(f, "message Request { string value = 1; }\n");
+  fprintf(f, "message Response { string value = 1; }\n");
+  for(size_t i=0; i<num_services; i++)
+  {
+    fprintf(f, "service Service%u {\n", (unsigned int)i);
+    for(size_t j=0; j<num_methods; j++)
+    {
+      fprintf(f, "  rpc Method%u (Request) returns (Response);\n", (unsigned int)j);
+    }
+    fprintf(f, "}\n");
+  }
+  fclose(f);
+  return true;
+}
+
+int RunPlugin(const std::string & options, const std::string & outdir, const std::string & proto_path, const std::string & proto_file, std::string & cmdline)
+{
+  //build
+  cmdline.clear();
+  cmdline.append("protoc.exe --plugin=protoc-gen-");
+  cmdline.append(GetPluginShortName());
+  cmdline.append("=");
+  cmdline.append(GetPluginFilePath());
+  cmdline.append(" --");
+  cmdline.append(GetPluginShortName());
+  cmdline.append("_out=");
+  if (!options.empty())
+  {
+    cmdline.append(options);
+    cmdline.append(":");
+  }
+  cmdline.append(outdir);
+  cmdline.append(" --proto_path=");
+  cmdline.append(proto_path);
+  cmdline.append(" ");
+  cmdline.append(proto_file);
+
+  //run the command
+  printf("%s\n", cmdline.c_str());
+  int returnCode = system(cmdline.c_str());
+#ifdef __linux__
+  returnCode = WEXITSTATUS(returnCode);
+#endif
+  return returnCode;
+}
+
+bool ReadTextFile(const std::string & path, std::string & content)
+{
+  content.clear();
+  FILE * f = fopen(path.c_str(), "rb");
+  if (f == NULL)
+    return false;
+  char buffer[4096];
+  size_t read = 0;
+  while((read = fread(buffer, 1, sizeof(buffer), f)) > 0)
+  {
+    content.append(buffer, read);
+  }
+  fclose(f);
+  return true;
+}
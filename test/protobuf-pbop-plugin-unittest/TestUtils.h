@@ -46,3 +46,11 @@ size_t FindFirst(const std::string & iValue, const std::vector<char> & iTokens);
 std::string FindWordName(const std::string & iBuffer);
 
 bool IsFolderEquals(const std::string & folderA, const std::string & folderB);
+
+bool CreateTestDirectory(const std::string & path);
+
+bool WriteTestServicesProto(const std::string & path, const std::string & package, size_t num_services, size_t num_methods);
+
+int RunPlugin(const std::string & options, const std::string & outdir, const std::string & proto_path, const std::string & proto_file, std::string & cmdline);
+
+bool ReadTextFile(const std::string & path, std::string & content);
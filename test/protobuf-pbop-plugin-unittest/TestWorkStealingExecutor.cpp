@@ -0,0 +1,150 @@
+/**********************************************************************************
+ * MIT License
+ * 
+ * Copyright (c) 2018 Antoine Beauchamp
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#include "TestWorkStealingExecutor.h"
+
+#include "rapidassist/timing.h"
+
+#include "pbop/WorkStealingExecutor.h"
+
+#include <atomic>
+
+using namespace pbop;
+
+void TestWorkStealingExecutor::SetUp()
+{
+}
+
+void TestWorkStealingExecutor::TearDown()
+{
+}
+
+class CountingTask : public Task
+{
+public:
+  std::atomic<int> * counter_;
+  WorkStealingExecutor * executor_;
+  int depth_;
+
+  CountingTask(std::atomic<int> * counter, WorkStealingExecutor * executor, int depth) :
+    counter_(counter),
+    executor_(executor),
+    depth_(depth)
+  {
+  }
+
+  virtual void Execute()
+  {
+    (*counter_)++;
+
+    // Spawn child tasks from the worker thread
+    if (depth_ > 0)
+    {
+      executor_->Submit(new CountingTask(counter_, executor_, depth_-1));
+      executor_->Submit(new CountingTask(counter_, executor_, depth_-1));
+    }
+  }
+};
+
+class SleepingTask : public Task
+{
+public:
+  std::atomic<int> * counter_;
+
+  SleepingTask(std::atomic<int> * counter) : counter_(counter) {}
+
+  virtual void Execute()
+  {
+    ra::timing::Millisleep(200);
+    (*counter_)++;
+  }
+};
+
+TEST_F(TestWorkStealingExecutor, testStartStop)
+{
+  WorkStealingExecutor executor;
+  ASSERT_FALSE(executor.IsRunning());
+
+  // Tasks are refused when the executor is not running
+  std::atomic<int> counter(0);
+  CountingTask task(&counter, &executor, 0);
+  ASSERT_FALSE(executor.Submit(&task));
+
+  Status s = executor.Start(3);
+  ASSERT_TRUE( s.Success() ) << s.GetDescription();
+  ASSERT_TRUE(executor.IsRunning());
+  ASSERT_EQ(3, executor.GetWorkerCount());
+
+  // Starting twice is an error
+  s = executor.Start(3);
+  ASSERT_FALSE( s.Success() );
+
+  executor.Stop();
+  ASSERT_FALSE(executor.IsRunning());
+  ASSERT_EQ(0, executor.GetWorkerCount());
+}
+
+TEST_F(TestWorkStealingExecutor, testAllTasksExecuted)
+{
+  WorkStealingExecutor executor;
+  Status s = executor.Start(4);
+  ASSERT_TRUE( s.Success() ) << s.GetDescription();
+
+  // Each root task spawns a binary tree of 2^(depth+1)-1 tasks
+  static const int num_roots = 50;
+  static const int depth = 6;
+  std::atomic<int> counter(0);
+  for(int i=0; i<num_roots; i++)
+  {
+    ASSERT_TRUE(executor.Submit(new CountingTask(&counter, &executor, depth)));
+  }
+
+  // Stop() waits for all tasks to complete
+  executor.Stop();
+
+  ASSERT_EQ(num_roots * ((1 << (depth+1)) - 1), counter);
+}
+
+TEST_F(TestWorkStealingExecutor, testConcurrency)
+{
+  WorkStealingExecutor executor;
+  Status s = executor.Start(4);
+  ASSERT_TRUE( s.Success() ) << s.GetDescription();
+
+  double time_start_sec = ra::timing::GetMillisecondsTimer();
+
+  // 4 tasks of 200ms on 4 workers should run in parallel
+  std::atomic<int> counter(0);
+  for(int i=0; i<4; i++)
+  {
+    ASSERT_TRUE(executor.Submit(new SleepingTask(&counter)));
+  }
+  executor.Stop();
+
+  double time_end_sec = ra::timing::GetMillisecondsTimer();
+  double elapsed_time_ms = (time_end_sec - time_start_sec) * 1000.0;
+
+  ASSERT_EQ(4, counter);
+  ASSERT_NEAR(200, elapsed_time_ms, 150);
+}